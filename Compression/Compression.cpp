@@ -0,0 +1,263 @@
+/////////////////////////////////////////////////////////////////////////
+// Compression.cpp - gzip and deflate content-codings for HTTP bodies   //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+
+#include "Compression.h"
+#include "../HttpParser/HttpParser.h"
+#include "../Utilities/Utilities.h"
+#include <algorithm>
+#include <climits>
+
+#if !defined(HTTP_NO_ZLIB) && defined(__has_include)
+#if __has_include(<zlib.h>)
+#define COMPRESSION_ZLIB
+#include <zlib.h>
+#endif
+#endif
+
+using namespace HttpCommunication;
+using SUtils = Utilities::StringHelper;
+
+namespace
+{
+  //----< weight of a q parameter, "q=0.8", in thousandths >-----------
+  /*
+  *  - a weight that can't be read is taken as 0, refusing the coding
+  */
+  size_t weight(std::string_view value)
+  {
+    value = SUtils::trimView(value);
+    if (value.empty() || (value[0] != '0' && value[0] != '1'))
+      return 0;
+    size_t q = (value[0] == '1') ? 1000 : 0;
+    if (value.size() == 1)
+      return q;
+    if (value[1] != '.' || value.size() > 5)
+      return 0;
+    size_t scale = 100;
+    for (size_t i = 2; i < value.size(); ++i, scale /= 10)
+    {
+      if (value[i] < '0' || '9' < value[i])
+        return 0;
+      q += (value[i] - '0') * scale;
+    }
+    return (std::min)(q, size_t(1000));
+  }
+
+#ifdef COMPRESSION_ZLIB
+  //----< inflate data into out, growing it up to maxSize bytes >------
+
+  bool inflateTo(
+    const unsigned char* data, size_t size, int windowBits, std::vector<unsigned char>& out, size_t maxSize
+  )
+  {
+    out.clear();
+    if (size > UINT_MAX)
+      return false;
+    z_stream zs = {};
+    if (inflateInit2(&zs, windowBits) != Z_OK)
+      return false;
+    zs.next_in = const_cast<Bytef*>(data);
+    zs.avail_in = static_cast<uInt>(size);
+    size_t used = 0;
+    int result = Z_OK;
+    while (result == Z_OK)
+    {
+      if (used == maxSize)
+        break;
+      size_t grow = (std::max)((std::max)(used, 2 * size), size_t(16 * 1024));
+      out.resize((std::min)(used + grow, maxSize));
+      size_t room = (std::min)(out.size() - used, size_t(UINT_MAX));
+      zs.next_out = out.data() + used;
+      zs.avail_out = static_cast<uInt>(room);
+      result = ::inflate(&zs, Z_NO_FLUSH);
+      used += room - zs.avail_out;
+      if (result == Z_BUF_ERROR && zs.avail_out == 0)
+        result = Z_OK;  // out was full, make more room
+    }
+    inflateEnd(&zs);
+    out.resize((result == Z_STREAM_END) ? used : 0);
+    return result == Z_STREAM_END;
+  }
+#endif
+}
+//----< can bodies be compressed and decompressed? >-------------------
+
+bool Compression::available()
+{
+#ifdef COMPRESSION_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+//----< coding's name, as used in Accept-Encoding and Content-Encoding >-
+
+const char* Compression::name(Coding coding)
+{
+  switch (coding)
+  {
+  case gzip:    return "gzip";
+  case deflate: return "deflate";
+  default:      return "identity";
+  }
+}
+//----< coding named by a Content-Encoding value, false if unknown >--
+
+bool Compression::coding(std::string_view name, Coding& coding)
+{
+  name = SUtils::trimView(name);
+  if (HttpParser::equalIgnoreCase(name, "gzip") || HttpParser::equalIgnoreCase(name, "x-gzip"))
+    coding = gzip;
+  else if (HttpParser::equalIgnoreCase(name, "deflate"))
+    coding = deflate;
+  else if (HttpParser::equalIgnoreCase(name, "identity"))
+    coding = identity;
+  else
+    return false;
+  return true;
+}
+//----< weight an Accept-Encoding header gives coding, 0 to 1000 >---
+/*
+*  - a coding that isn't listed gets the weight of "*", if that is
+*    listed, identity is acceptable unless refused, others are not
+*/
+size_t Compression::quality(std::string_view acceptEncoding, Coding coding)
+{
+  const size_t unlisted = static_cast<size_t>(-1);
+  size_t named = unlisted, wildcard = unlisted;
+  while (!acceptEncoding.empty())
+  {
+    size_t comma = acceptEncoding.find(',');
+    std::string_view item = acceptEncoding.substr(0, comma);
+    acceptEncoding = (comma == std::string_view::npos) ? std::string_view() : acceptEncoding.substr(comma + 1);
+
+    size_t semi = item.find(';');
+    std::string_view token = SUtils::trimView(item.substr(0, semi));
+    if (token.empty())
+      continue;
+    size_t q = 1000;
+    while (semi != std::string_view::npos)
+    {
+      item = item.substr(semi + 1);
+      semi = item.find(';');
+      std::string_view param = SUtils::trimView(item.substr(0, semi));
+      if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+        q = weight(param.substr(2));
+    }
+    Coding listed;
+    if (token == "*")
+      wildcard = q;
+    else if (Compression::coding(token, listed) && listed == coding)
+      named = q;
+  }
+  if (named != unlisted)
+    return named;
+  if (wildcard != unlisted)
+    return wildcard;
+  return (coding == identity) ? 1000 : 0;
+}
+//----< coding a client prefers, gzip on a tie, identity if neither >-
+
+Compression::Coding Compression::negotiate(std::string_view acceptEncoding)
+{
+  size_t gzipQ = quality(acceptEncoding, gzip);
+  size_t deflateQ = quality(acceptEncoding, deflate);
+  if (gzipQ == 0 && deflateQ == 0)
+    return identity;
+  return (gzipQ >= deflateQ) ? gzip : deflate;
+}
+//----< compress size bytes of data into out, false if that fails >---
+
+bool Compression::compress(const byte* data, size_t size, Coding coding, std::vector<byte>& out, int level)
+{
+  out.clear();
+#ifdef COMPRESSION_ZLIB
+  if (coding == identity || size > UINT_MAX)
+    return false;
+  z_stream zs = {};
+  int windowBits = (coding == gzip) ? 15 + 16 : 15;
+  if (deflateInit2(&zs, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+  out.resize(deflateBound(&zs, static_cast<uLong>(size)));
+  zs.next_in = const_cast<Bytef*>(data);
+  zs.avail_in = static_cast<uInt>(size);
+  zs.next_out = out.data();
+  zs.avail_out = static_cast<uInt>(out.size());
+  int result = ::deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  if (result == Z_STREAM_END)
+    return true;
+  out.clear();
+#endif
+  return false;
+}
+//----< decompress data into out, false if it's corrupt or too large >-
+/*
+*  - maxSize bounds the decompressed size, so a small body can't
+*    expand to fill memory
+*/
+bool Compression::decompress(const byte* data, size_t size, Coding coding, std::vector<byte>& out, size_t maxSize)
+{
+  out.clear();
+#ifdef COMPRESSION_ZLIB
+  if (coding == identity)
+    return false;
+  if (inflateTo(data, size, (coding == gzip) ? 15 + 16 : 15, out, maxSize))
+    return true;
+  return coding == deflate && inflateTo(data, size, -15, out, maxSize);  // raw deflate
+#else
+  return false;
+#endif
+}
+
+#ifdef TEST_COMPRESSION
+
+#include <iostream>
+#include <string>
+
+//----< compress text, decompress it, and show sizes >-----------------
+
+bool roundTrip(const std::string& text, Compression::Coding coding)
+{
+  std::vector<Compression::byte> packed, unpacked;
+  const Compression::byte* data = reinterpret_cast<const Compression::byte*>(text.data());
+  bool ok = Compression::compress(data, text.size(), coding, packed) &&
+    Compression::decompress(packed.data(), packed.size(), coding, unpacked) &&
+    std::string(unpacked.begin(), unpacked.end()) == text;
+  std::cout << "\n  " << Compression::name(coding) << ": " << text.size() << " bytes -> "
+    << packed.size() << " bytes, round trip " << (ok ? "ok" : "failed");
+  return ok;
+}
+
+int main()
+{
+  std::cout << "\n  Demonstrating Compression";
+  std::cout << "\n ===========================";
+  std::cout << "\n  zlib is " << (Compression::available() ? "available" : "not available");
+
+  std::string html;
+  for (size_t i = 0; i < 2000; ++i)
+    html += "<tr><td>row " + std::to_string(i) + "</td><td>some repeated cell text</td></tr>\n";
+  roundTrip(html, Compression::gzip);
+  roundTrip(html, Compression::deflate);
+
+  std::vector<Compression::byte> packed, unpacked;
+  Compression::compress(reinterpret_cast<const Compression::byte*>(html.data()), html.size(), Compression::gzip, packed);
+  bool bounded = !Compression::decompress(packed.data(), packed.size(), Compression::gzip, unpacked, 1000);
+  std::cout << "\n  decompressing into 1000 bytes " << (bounded ? "refused" : "succeeded");
+
+  const char* headers[] = {
+    "gzip, deflate, br", "deflate;q=0.9, gzip;q=0.5", "gzip;q=0, deflate;q=0.001",
+    "*;q=0.3", "br", "", "identity, *;q=0"
+  };
+  for (const char* header : headers)
+    std::cout << "\n  Accept-Encoding: \"" << header << "\" negotiates "
+      << Compression::name(Compression::negotiate(header));
+  std::cout << "\n\n";
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// Compression.h - gzip and deflate content-codings for HTTP bodies     //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package provides a Compression class, static members only, that
+*  negotiates and applies the gzip and deflate content-codings.
+*  - quality(acceptEncoding, coding) reads an Accept-Encoding header's
+*    weight for a coding, in thousandths, and negotiate(acceptEncoding)
+*    picks the coding a client prefers, identity if it accepts neither.
+*  - compress and decompress use zlib.  "deflate" is the zlib format,
+*    as RFC 9110 defines it, though decompress also takes raw deflate
+*    data, which some servers send instead.
+*  - zlib is used if its header can be found, e.g., installed with
+*    "vcpkg install zlib", whose MSBuild integration also links it.
+*    Define HTTP_NO_ZLIB to build without it.
+*    Without zlib, available() is false and compress and decompress
+*    fail, but negotiation still works, e.g., for serving files that
+*    were compressed ahead of time.
+*
+*  Required Files:
+*  ---------------
+*  Compression.h, Compression.cpp, HttpParser.h, HttpParser.cpp
+*  Utilities.h, Utilities.cpp
+*  zlib, if available
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace HttpCommunication
+{
+  class Compression
+  {
+  public:
+    using byte = unsigned char;
+    enum Coding { identity, gzip, deflate };
+    static const int defaultLevel = 6;
+    static const size_t defaultMaxSize = 256 * 1024 * 1024;
+
+    static bool available();
+    static const char* name(Coding coding);
+    static bool coding(std::string_view name, Coding& coding);
+    static size_t quality(std::string_view acceptEncoding, Coding coding);
+    static Coding negotiate(std::string_view acceptEncoding);
+    static bool compress(
+      const byte* data, size_t size, Coding coding, std::vector<byte>& out, int level = defaultLevel
+    );
+    static bool decompress(
+      const byte* data, size_t size, Coding coding, std::vector<byte>& out, size_t maxSize = defaultMaxSize
+    );
+  };
+}
@@ -0,0 +1,435 @@
+/////////////////////////////////////////////////////////////////////////
+// FileCache.cpp - size bounded cache of file contents                 //
+// ver 1.3                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+
+#include "FileCache.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+//----< constructor >--------------------------------------------------
+
+FileCache::FileCache(size_t capacity, size_t maxFileSize)
+  : capacity_(capacity), maxFileSize_(maxFileSize) {}
+
+//----< last write time and size of a file, false if not a file >-----
+
+bool FileCache::attributes(const std::string& fileSpec, FILETIME& lastWrite, size_t& fileSize)
+{
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!::GetFileAttributesExA(fileSpec.c_str(), GetFileExInfoStandard, &data))
+    return false;
+  if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+    return false;
+  lastWrite = data.ftLastWriteTime;
+  fileSize = (static_cast<size_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+  return true;
+}
+//----< read fileSize bytes of file, nullptr if that fails >----------
+
+FileCache::Buffer FileCache::read(const std::string& fileSpec, size_t fileSize)
+{
+  std::ifstream in(fileSpec, std::ios::binary);
+  if (!in.good())
+    return nullptr;
+  std::shared_ptr<std::vector<byte>> pContents = std::make_shared<std::vector<byte>>(fileSize);
+  in.read(reinterpret_cast<char*>(pContents->data()), fileSize);
+  if (static_cast<size_t>(in.gcount()) != fileSize)
+    return nullptr;
+  return pContents;
+}
+//----< FNV-1a taken eight bytes at a time, continuing from seed >----
+/*
+*  - a word at a time is eight times fewer multiplies than FNV's byte
+*    at a time.  Hashing blocks whose sizes are multiples of eight, in
+*    turn, gives the same hash as hashing them all at once.
+*/
+uint64_t FileCache::hash(const byte* data, size_t size, uint64_t seed)
+{
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t h = seed;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    h = (h ^ word) * prime;
+  }
+  for (; i < size; ++i)
+    h = (h ^ data[i]) * prime;
+  return h;
+}
+//----< quoted entity tag of a hash, 13 base 32 digits >--------------
+/*
+*  - the hash is mixed first, so its last words reach every digit
+*  - 15 characters, short enough for std::string's inline buffer, so
+*    copying a tag into a reply doesn't allocate
+*/
+std::string FileCache::etag(uint64_t hash)
+{
+  const char digits[] = "0123456789abcdefghijklmnopqrstuv";
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  std::string tag(15, '"');
+  for (size_t i = 13; i > 0; --i, hash >>= 5)
+    tag[i] = digits[hash & 31];
+  return tag;
+}
+//----< find contents of file, reading and caching them if needed >---
+/*
+*  - returns false if the file can't be read
+*  - contents is nullptr, and fileSize is set, if the file is too large
+*    to cache
+*/
+bool FileCache::lookup(const std::string& fileSpec, Buffer& contents, size_t& fileSize)
+{
+  FILETIME lastWrite;
+  return find(fileSpec, contents, fileSize, lastWrite);
+}
+//----< find contents of file, as above, and its validators >---------
+/*
+*  - a FILETIME counts 100 ns intervals since 1601
+*/
+bool FileCache::lookup(const std::string& fileSpec, Buffer& contents, size_t& fileSize, Version& version)
+{
+  FILETIME lastWrite;
+  if (!find(fileSpec, contents, fileSize, lastWrite))
+    return false;
+  uint64_t ticks = (static_cast<uint64_t>(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime;
+  const uint64_t ticksTo1970 = 116444736000000000ULL;
+  version.lastModified = static_cast<std::time_t>((ticks > ticksTo1970) ? (ticks - ticksTo1970) / 10000000 : 0);
+  version.etag = etag(fileSpec, contents, fileSize, lastWrite);
+  return true;
+}
+//----< entity tag of a file version >--------------------------------
+/*
+*  - a cached file's tag is hashed from its contents, once, and kept in
+*    its entry, so tag and contents always agree
+*  - a file too large to cache would have to be read whole to hash, on
+*    the thread serving the request, so its tag is hashed from its size
+*    and last write time instead, which change when it's edited
+*/
+std::string FileCache::etag(const std::string& fileSpec, const Buffer& contents, size_t fileSize, FILETIME lastWrite)
+{
+  if (!contents)
+  {
+    uint64_t stamp[2] = {
+      static_cast<uint64_t>(fileSize),
+      (static_cast<uint64_t>(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime
+    };
+    return etag(hash(reinterpret_cast<const byte*>(stamp), sizeof(stamp), hashSeed));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = entries_.find(fileSpec);
+    if (iter != entries_.end() && iter->second.contents == contents && !iter->second.etag.empty())
+      return iter->second.etag;
+  }
+  std::string tag = etag(hash(contents->data(), contents->size(), hashSeed));
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = entries_.find(fileSpec);
+  if (iter != entries_.end() && iter->second.contents == contents)
+    iter->second.etag = tag;
+  return tag;
+}
+//----< find contents of file and its last write time >---------------
+
+bool FileCache::find(const std::string& fileSpec, Buffer& contents, size_t& fileSize, FILETIME& lastWrite)
+{
+  contents = nullptr;
+  if (!attributes(fileSpec, lastWrite, fileSize))
+    return false;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = entries_.find(fileSpec);
+    if (iter != entries_.end())
+    {
+      Entry& entry = iter->second;
+      if (entry.lastWrite.dwLowDateTime == lastWrite.dwLowDateTime &&
+        entry.lastWrite.dwHighDateTime == lastWrite.dwHighDateTime &&
+        entry.contents->size() == fileSize)
+      {
+        lru_.splice(lru_.begin(), lru_, entry.lruPos);
+        contents = entry.contents;
+        ++hits_;
+        return true;
+      }
+      remove(iter);  // file has changed
+    }
+    ++misses_;
+    if (fileSize > maxFileSize_ || fileSize > capacity_)
+      return true;
+  }
+  contents = read(fileSpec, fileSize);
+  if (!contents)
+    return false;
+  insert(fileSpec, contents, lastWrite);
+  return true;
+}
+//----< contents transformed by make, cached with the file's contents >-
+/*
+*  - contents is what lookup returned for fileSpec.  A variant is kept
+*    only while the file's cached contents are still contents, so it
+*    can't outlive the version of the file it was made from.
+*  - returns what make returned, made once while it stays cached, or
+*    on each call if the file isn't cached
+*/
+FileCache::Buffer FileCache::variant(
+  const std::string& fileSpec, const Buffer& contents, const std::string& name, const Transform& make
+)
+{
+  if (!contents)
+    return nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = entries_.find(fileSpec);
+    if (iter != entries_.end() && iter->second.contents == contents)
+    {
+      for (auto& item : iter->second.variants)
+      {
+        if (item.first == name)
+          return item.second;
+      }
+    }
+  }
+  Buffer made = make(*contents);
+  if (!made)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = entries_.find(fileSpec);
+  if (iter == entries_.end() || iter->second.contents != contents || made->size() > capacity_)
+    return made;
+  for (auto& item : iter->second.variants)
+  {
+    if (item.first == name)
+      return item.second;  // another thread made it first
+  }
+  lru_.splice(lru_.begin(), lru_, iter->second.lruPos);  // evict others first
+  evict(made->size());
+  iter = entries_.find(fileSpec);
+  if (iter == entries_.end())
+    return made;
+  iter->second.variants.emplace_back(name, made);
+  size_ += made->size();
+  return made;
+}
+//----< add contents, replacing any another thread added first >------
+
+void FileCache::insert(const std::string& fileSpec, Buffer contents, FILETIME lastWrite)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = entries_.find(fileSpec);
+  if (iter != entries_.end())
+    remove(iter);
+  evict(contents->size());
+  lru_.push_front(fileSpec);
+  Entry entry;
+  entry.contents = contents;
+  entry.lastWrite = lastWrite;
+  entry.lruPos = lru_.begin();
+  entries_[fileSpec] = entry;
+  size_ += contents->size();
+}
+//----< drop an entry, caller holds lock >-----------------------------
+
+void FileCache::remove(std::unordered_map<std::string, Entry>::iterator iter)
+{
+  size_ -= iter->second.contents->size();
+  for (auto& item : iter->second.variants)
+    size_ -= item.second->size();
+  lru_.erase(iter->second.lruPos);
+  entries_.erase(iter);
+}
+//----< drop least recently used entries until bytesNeeded fit >------
+
+void FileCache::evict(size_t bytesNeeded)
+{
+  while (!lru_.empty() && size_ + bytesNeeded > capacity_)
+    remove(entries_.find(lru_.back()));
+}
+//----< set bound on total size of cached contents >------------------
+/*
+*  - zero turns caching off
+*/
+void FileCache::capacity(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  capacity_ = bytes;
+  evict(0);
+}
+//----< bound on total size of cached contents >----------------------
+
+size_t FileCache::capacity()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return capacity_;
+}
+//----< set size of largest file that will be cached >----------------
+
+void FileCache::maxFileSize(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  maxFileSize_ = bytes;
+}
+//----< size of largest file that will be cached >--------------------
+
+size_t FileCache::maxFileSize()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return maxFileSize_;
+}
+//----< total size of cached contents >--------------------------------
+
+size_t FileCache::size()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return size_;
+}
+//----< number of cached files >---------------------------------------
+
+size_t FileCache::entries()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return entries_.size();
+}
+//----< number of lookups served from cache >--------------------------
+
+size_t FileCache::hits()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return hits_;
+}
+//----< number of lookups that had to check the file system >---------
+
+size_t FileCache::misses()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return misses_;
+}
+//----< drop all entries >---------------------------------------------
+
+void FileCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  entries_.clear();
+  lru_.clear();
+  size_ = 0;
+}
+
+#ifdef TEST_FILECACHE
+
+#include <thread>
+#include <chrono>
+#include <cstdio>
+
+//----< write text to file >-------------------------------------------
+
+void writeFile(const std::string& fileSpec, const std::string& text)
+{
+  std::ofstream out(fileSpec, std::ios::binary);
+  out << text;
+}
+//----< show result of lookup >----------------------------------------
+
+void show(FileCache& cache, const std::string& fileSpec)
+{
+  FileCache::Buffer contents;
+  size_t fileSize = 0;
+  std::cout << "\n  " << fileSpec << ": ";
+  if (!cache.lookup(fileSpec, contents, fileSize))
+    std::cout << "can't read";
+  else if (!contents)
+    std::cout << fileSize << " bytes, too large to cache";
+  else
+    std::cout << "\"" << std::string(contents->begin(), contents->end()) << "\"";
+  std::cout << "  (hits = " << cache.hits() << ", misses = " << cache.misses()
+    << ", entries = " << cache.entries() << ", bytes = " << cache.size() << ")";
+}
+
+int main()
+{
+  std::cout << "\n  Demonstrating FileCache";
+  std::cout << "\n =========================";
+
+  writeFile("cacheTest1.txt", "first file");
+  writeFile("cacheTest2.txt", "second file");
+  writeFile("cacheTest3.txt", "third file");
+  writeFile("cacheTest4.txt", std::string(64, 'x'));
+
+  FileCache cache(25, 32);   // room for two of the small files
+
+  std::cout << "\n\n  misses, then a hit:";
+  show(cache, "cacheTest1.txt");
+  show(cache, "cacheTest2.txt");
+  show(cache, "cacheTest1.txt");
+
+  std::cout << "\n\n  third file evicts least recently used, cacheTest2.txt:";
+  show(cache, "cacheTest3.txt");
+  show(cache, "cacheTest1.txt");
+  show(cache, "cacheTest2.txt");
+
+  std::cout << "\n\n  a held buffer survives eviction:";
+  FileCache::Buffer held;
+  size_t heldSize;
+  cache.lookup("cacheTest1.txt", held, heldSize);
+  cache.clear();
+  std::cout << "\n  after clear, held buffer: \"" << std::string(held->begin(), held->end()) << "\"";
+
+  std::cout << "\n\n  edited file is read again:";
+  show(cache, "cacheTest3.txt");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  writeFile("cacheTest3.txt", "3rd file, edited");
+  show(cache, "cacheTest3.txt");
+
+  std::cout << "\n\n  a variant is made once, and again after the file changes:";
+  size_t made = 0;
+  auto upper = [&made](const std::vector<FileCache::byte>& bytes) {
+    ++made;
+    auto result = std::make_shared<std::vector<FileCache::byte>>(bytes);
+    for (auto& ch : *result)
+      ch = static_cast<FileCache::byte>(toupper(ch));
+    return FileCache::Buffer(result);
+  };
+  FileCache roomy;
+  FileCache::Buffer contents, shouted;
+  size_t fileSize;
+  for (size_t i = 0; i < 2; ++i)
+  {
+    roomy.lookup("cacheTest3.txt", contents, fileSize);
+    shouted = roomy.variant("cacheTest3.txt", contents, "upper", upper);
+  }
+  std::cout << "\n  \"" << std::string(shouted->begin(), shouted->end()) << "\", made " << made << " time(s)";
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  writeFile("cacheTest3.txt", "3rd file, again");
+  roomy.lookup("cacheTest3.txt", contents, fileSize);
+  shouted = roomy.variant("cacheTest3.txt", contents, "upper", upper);
+  std::cout << "\n  \"" << std::string(shouted->begin(), shouted->end()) << "\", made " << made << " time(s)";
+
+  std::cout << "\n\n  entity tags, from contents if cached, else from size and time:";
+  FileCache::Version version;
+  for (auto name : { "cacheTest3.txt", "cacheTest3.txt", "cacheTest4.txt" })
+  {
+    cache.lookup(name, contents, fileSize, version);
+    std::cout << "\n  " << name << ": " << version.etag << (contents ? "" : ", not cached");
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  writeFile("cacheTest3.txt", "3rd file, edited again");
+  cache.lookup("cacheTest3.txt", contents, fileSize, version);
+  std::cout << "\n  after an edit: " << version.etag;
+
+  std::cout << "\n\n  large and missing files:";
+  show(cache, "cacheTest4.txt");
+  show(cache, "noSuchFile.txt");
+
+  for (auto name : { "cacheTest1.txt", "cacheTest2.txt", "cacheTest3.txt", "cacheTest4.txt" })
+    std::remove(name);
+  std::cout << "\n\n";
+}
+
+#endif
@@ -0,0 +1,126 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// FileCache.h - size bounded cache of file contents                   //
+// ver 1.3                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package provides a FileCache class that holds the contents of
+*  recently read files, so a server can answer repeated GETs for the same
+*  files without reading them from disk.
+*  - Contents are shared, immutable buffers.  Any number of replies may
+*    refer to one buffer, and a buffer stays valid after it has been
+*    evicted until the last reply referring to it is gone.
+*  - Every lookup checks the file's last write time and size, so an
+*    edited file is read again.
+*  - The total size of cached contents is bounded.  Least recently used
+*    files are evicted to make room.  Files larger than maxFileSize are
+*    not cached, lookup reports their size so callers can send them
+*    some other way, e.g., with Socket::sendFile.
+*  - variant(fileSpec, contents, name, make) caches a transformation
+*    of a file's contents, e.g., its gzip compression, with the file.
+*    make runs once per file version, and the variant is dropped with
+*    the contents it was made from.  Variants count toward capacity.
+*  - lookup(fileSpec, contents, fileSize, version) also gives the file's
+*    validators, a strong entity tag and its last write time.  A cached
+*    file's tag is hashed from its contents, once per file version, and
+*    kept with them.  A file too large to cache isn't read to make its
+*    tag, it's hashed from the file's size and last write time.
+*  - All methods may be called concurrently.  Files are read, and
+*    variants made, without holding the cache's lock.
+*
+*  Required Files:
+*  ---------------
+*  FileCache.h, FileCache.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.3 : 17 Oct 2026
+*  - tags of files too large to cache are made from size and last write
+*    time, instead of being hashed from disk and kept in a table
+*  ver 1.2 : 17 Oct 2026
+*  - lookup can return a file's Version, its entity tag and last write
+*    time, for conditional GETs
+*  ver 1.1 : 17 Oct 2026
+*  - added variant, transformed contents cached with a file
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <utility>
+#include <cstdint>
+#include <ctime>
+
+class FileCache
+{
+public:
+  using byte = unsigned char;
+  using Buffer = std::shared_ptr<const std::vector<byte>>;
+  using Transform = std::function<Buffer(const std::vector<byte>&)>;
+
+  struct Version
+  {
+    std::string etag;              // quoted
+    std::time_t lastModified = 0;  // seconds since 1970, UTC
+  };
+
+  FileCache(size_t capacity = 64 * 1024 * 1024, size_t maxFileSize = 1024 * 1024);
+  FileCache(const FileCache&) = delete;
+  FileCache& operator=(const FileCache&) = delete;
+
+  bool lookup(const std::string& fileSpec, Buffer& contents, size_t& fileSize);
+  bool lookup(const std::string& fileSpec, Buffer& contents, size_t& fileSize, Version& version);
+  Buffer variant(const std::string& fileSpec, const Buffer& contents, const std::string& name, const Transform& make);
+  void capacity(size_t bytes);
+  size_t capacity();
+  void maxFileSize(size_t bytes);
+  size_t maxFileSize();
+  size_t size();
+  size_t entries();
+  size_t hits();
+  size_t misses();
+  void clear();
+private:
+  struct Entry
+  {
+    Buffer contents;
+    FILETIME lastWrite;
+    std::list<std::string>::iterator lruPos;
+    std::vector<std::pair<std::string, Buffer>> variants;  // made from contents
+    std::string etag;     // empty until asked for
+  };
+  static const uint64_t hashSeed = 0xcbf29ce484222325ULL;  // FNV-1a offset basis
+
+  static bool attributes(const std::string& fileSpec, FILETIME& lastWrite, size_t& fileSize);
+  static Buffer read(const std::string& fileSpec, size_t fileSize);
+  static uint64_t hash(const byte* data, size_t size, uint64_t seed);
+  static std::string etag(uint64_t hash);
+  bool find(const std::string& fileSpec, Buffer& contents, size_t& fileSize, FILETIME& lastWrite);
+  std::string etag(const std::string& fileSpec, const Buffer& contents, size_t fileSize, FILETIME lastWrite);
+  void insert(const std::string& fileSpec, Buffer contents, FILETIME lastWrite);
+  void remove(std::unordered_map<std::string, Entry>::iterator iter);
+  void evict(size_t bytesNeeded);
+
+  std::mutex mtx_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<std::string> lru_;   // most recently used first
+  size_t capacity_;
+  size_t maxFileSize_;
+  size_t size_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+};
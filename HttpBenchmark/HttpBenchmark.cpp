@@ -0,0 +1,2139 @@
+/////////////////////////////////////////////////////////////////////////
+// HttpBenchmark.cpp - measures costs of HttpClientServer hot paths    //
+// ver 3.1                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package runs a set of benchmarks, each a small in-process client
+*  and server pair, that measure the costs of communication hot paths.
+*  - Run with no arguments to execute every benchmark, or name the
+*    benchmarks to run, e.g., HttpBenchmark recv
+*  - Build the Release configuration before quoting numbers.
+*
+*  Benchmarks:
+*  -----------
+*  recv : syscall count and latency of reading and parsing a ~600 byte
+*         request header, one byte per ::recv versus Socket's RecvBuffer
+*  parse : messages/sec parsing a ~600 byte request header already in
+*          memory, splitting fromString versus HttpParser, alone and
+*          building a message
+*  headers : messages/sec filling a request's 12 attributes and
+*            looking up four of them, std::unordered_map versus
+*            HttpHeaders, new and reused
+*  convert : ns and allocations per number converted, string streams
+*            versus Converter's to_chars and from_chars, and per reply
+*            for the conversions the message path makes
+*  split : MB/sec and allocations splitting 4 KB and 16 KB header
+*          blocks into trimmed lines, split and trim as they were,
+*          versus the SIMD kernels returning strings and views
+*  load : 100, 1000, and 10000 concurrent clients each send one GET,
+*         served by thread per connection versus four event loops
+*  keepalive : one HttpClient sends 2000 GETs, a new connection for each
+*              versus one persistent connection, in both server modes
+*  send : posting messages with 1 KB, 64 KB, and 1 MB bodies, the old
+*         copying postMessage with three sends versus one gathering send
+*  overload  : 256 clients send GETs that each cost 1 ms of server CPU,
+*              thread per connection versus an 8 thread pool that
+*              refuses work with 503 once 64 connections are waiting
+*  file : GETs of 1 MB and 100 MB files over a persistent connection,
+*         getProc reading each file into the reply versus a file backed
+*         reply sent with TransmitFile, getProc's FileCache is off
+*  cache : 20000 GETs spread over 300 8 KB files, reading each file,
+*          TransmitFile, and getProc's FileCache
+*  compress : 2000 GETs of a 256 KB HTML page, sent as is versus
+*             gzip compressed per request, compressed once and cached
+*             by getProc's FileCache, and from a precompressed .gz
+*             sibling, bytes on the wire and usec per request
+*  conditional : 2000 GETs of a 256 KB page the client already has,
+*                unconditional versus If-None-Match and
+*                If-Modified-Since, which getProc answers with 304
+*  logger : 64 threads each write 20000 messages, the old logger's
+*           BlockingQueue and write per message versus the Logger's
+*           lock-free queue and batched writes, given formatted text
+*           and given a record of format and arguments, also the
+*           cost of a burst from one thread that fits in the queue
+*  allocs : heap allocations, client and server together, per GET of a
+*           cached 4 KB file over a persistent connection, in both
+*           server modes
+*  connect : milliseconds and attempts to connect by name to a server
+*            listening only on IPv4, to a port nobody listens on, and
+*            to an unroutable address with a 500 ms timeout
+*  pool : 8 threads each send 250 GETs, a new HttpClient connection per
+*         GET versus an HttpConnectionPool of 2 and of 8 connections
+*  pipeline : one thread sends 2000 GETs over one connection, waiting
+*             for each reply versus HttpAsyncClient keeping 1, 16, and
+*             256 requests in flight, in both server modes
+*  slow : concurrent clients each send one GET whose handler waits
+*         50 ms, a blocking handler on threads and on event loops
+*         versus a coroutine handler awaiting sleepFor on event loops
+*  oneway : one thread sends 20000 small POSTs, HttpClient waiting for
+*           each reply and HttpAsyncClient pipelining them, versus a
+*           Sender streaming them to a Receiver that never replies
+*  chunked : GETs of a generated 100 MB report, a handler that builds
+*            the whole body versus one whose stream body is produced a
+*            chunk at a time, the largest allocation and MB/sec, in both
+*            server modes
+*  upload : PUTs of a 128 MB file backed body, a handler given the whole
+*           body after the server has read it versus putProc, which
+*           writes the body to disk as it arrives, the largest
+*           allocation and MB/sec, in both server modes
+*
+*  Required Files:
+*  ---------------
+*  HttpBenchmark.cpp
+*  HttpServer.h, HttpServer.cpp, EventLoop.h, EventLoop.cpp
+*  HttpClient.h, HttpClient.cpp
+*  HttpMessenger.h, HttpMessenger.cpp
+*  ThreadPool.h
+*  HttpCommCore.h, Message.h, Message.cpp, HttpParser.h, HttpParser.cpp
+*  FileCache.h, FileCache.cpp
+*  Compression.h, Compression.cpp, zlib if available
+*  Sockets.h, Sockets.cpp
+*  Logger.h, Logger.cpp, MpscQueue.h, Cpp11-BlockingQueue.h
+*  Utilities.h, Utilities.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 3.1 : 17 Oct 2026
+*  - added conditional benchmark
+*  ver 3.0 : 17 Oct 2026
+*  - added compress benchmark
+*  ver 2.9 : 17 Oct 2026
+*  - added upload benchmark
+*  ver 2.8 : 17 Oct 2026
+*  - added chunked benchmark
+*  - operator new records the largest allocation
+*  ver 2.7 : 17 Oct 2026
+*  - added oneway benchmark
+*  ver 2.6 : 17 Oct 2026
+*  - added slow benchmark
+*  - runLoad serves whatever handlers the caller added
+*  ver 2.5 : 17 Oct 2026
+*  - added pipeline benchmark
+*  ver 2.4 : 17 Oct 2026
+*  - added pool benchmark
+*  ver 2.3 : 17 Oct 2026
+*  - added connect benchmark
+*  ver 2.2 : 17 Oct 2026
+*  - added split benchmark
+*  ver 2.1 : 17 Oct 2026
+*  - added convert benchmark
+*  ver 2.0 : 17 Oct 2026
+*  - logger benchmark also logs records, and counts allocations
+*  ver 1.9 : 17 Oct 2026
+*  - added logger benchmark
+*  ver 1.8 : 17 Oct 2026
+*  - added allocs benchmark, operator new counts allocations
+*  ver 1.7 : 17 Oct 2026
+*  - added headers benchmark
+*  ver 1.6 : 17 Oct 2026
+*  - added parse benchmark
+*  ver 1.5 : 17 Oct 2026
+*  - added cache benchmark
+*  ver 1.4 : 17 Oct 2026
+*  - added file benchmark
+*  ver 1.3 : 17 Oct 2026
+*  - added send benchmark
+*  ver 1.2 : 17 Oct 2026
+*  - added overload benchmark
+*  ver 1.1 : 17 Oct 2026
+*  - added keepalive benchmark
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+
+#include "../Sockets/Sockets.h"
+#include "../HttpServer/HttpServer.h"
+#include "../HttpClient/HttpClient.h"
+#include "../HttpMessenger/HttpMessenger.h"
+#include "../HttpCommCore/HttpCommCore.h"
+#include "../Message/Message.h"
+#include "../Compression/Compression.h"
+#include "../Logger/Logger.h"
+#include "../Logger/Cpp11-BlockingQueue.h"
+#include "../Utilities/Utilities.h"
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <cstdio>
+#include <unordered_map>
+#include <cstdlib>
+#include <new>
+
+using namespace HttpCommunication;
+using namespace Sockets;
+using Util = Utilities::StringHelper;
+using Clock = std::chrono::high_resolution_clock;
+
+//----< count every heap allocation, for the allocs benchmark >--------
+/*
+*  - also records the largest, for the chunked benchmark
+*/
+std::atomic<size_t> allocationCount = 0;
+std::atomic<size_t> largestAllocation = 0;
+
+void* operator new(size_t size)
+{
+  ++allocationCount;
+  size_t largest = largestAllocation.load(std::memory_order_relaxed);
+  while (size > largest && !largestAllocation.compare_exchange_weak(largest, size))
+    ;
+  void* p = std::malloc(size > 0 ? size : 1);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+  //----< elapsed time in microseconds >-------------------------------
+
+  double microSecs(Clock::time_point start, Clock::time_point stop)
+  {
+    return std::chrono::duration<double, std::micro>(stop - start).count();
+  }
+  //----< waits for server side of a benchmark to finish >-------------
+
+  void waitFor(const std::atomic<bool>& done)
+  {
+    while (!done.load())
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  //----< builds a request whose header is about 600 bytes >-----------
+
+  HttpMessage<HttpRequest> makeBrowserLikeRequest()
+  {
+    HttpMessage<HttpRequest> msg = makeHttpRequestMessage(HttpRequest::GET, "/debug/Hello1.html");
+    msg.attribute("Host", "localhost:8080");
+    msg.attribute("Connection", "keep-alive");
+    msg.attribute("Cache-Control", "max-age=0");
+    msg.attribute("Upgrade-Insecure-Requests", "1");
+    msg.attribute("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/62.0.3202.94 Safari/537.36");
+    msg.attribute("Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,image/apng,*/*;q=0.8");
+    msg.attribute("Accept-Encoding", "gzip, deflate, br");
+    msg.attribute("Accept-Language", "en-US,en;q=0.9");
+    msg.attribute("Cookie", "session=0123456789abcdef0123456789abcdef; theme=dark; lang=en-US");
+    msg.attribute("Referer", "http://localhost:8080/debug/index.html");
+    msg.attribute("If-None-Match", "\"5d8c72a5edda8d6a\"");
+    msg.attribute("Sec-Fetch-Site", "same-origin");
+    return msg;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // recv benchmark
+  // - server reads and parses request headers, acknowledging each
+  //   with a single byte so messages arrive one at a time
+  // - byteAtATime reproduces the Socket::recvString loop used before
+  //   RecvBuffer was introduced: one ::recv per header byte
+
+  struct RecvResult
+  {
+    size_t messages = 0;
+    size_t headerBytes = 0;
+    size_t recvCalls = 0;
+    double parseMicroSecs = 0.0;
+    std::atomic<bool> done = false;
+  };
+
+  class HeaderParseHandler
+  {
+  public:
+    HeaderParseHandler(RecvResult* pResult, size_t count, bool byteAtATime)
+      : pResult_(pResult), count_(count), byteAtATime_(byteAtATime) {}
+    void operator()(Socket&& socket);
+  private:
+    std::string readByteAtATime(Socket& socket, size_t& calls);
+    RecvResult* pResult_;
+    size_t count_;
+    bool byteAtATime_;
+  };
+
+  //----< reads header lines with one ::recv per byte >----------------
+
+  std::string HeaderParseHandler::readByteAtATime(Socket& socket, size_t& calls)
+  {
+    std::string msgString, line;
+    Socket::byte ch;
+    while (true)
+    {
+      ++calls;
+      if (socket.recvStream(1, &ch) != 1)
+        break;
+      line += ch;
+      if (ch != '\n')
+        continue;
+      msgString += line;
+      bool lastLine = line.size() < 3;
+      line.clear();
+      if (lastLine)
+        break;
+    }
+    return msgString;
+  }
+  //----< server side of recv benchmark >------------------------------
+
+  void HeaderParseHandler::operator()(Socket&& socket)
+  {
+    HttpCommCore core(&socket);
+    size_t calls = 0;
+    size_t startCount = socket.recvCount();
+    Socket::byte ack = 'a';
+    for (size_t i = 0; i < count_; ++i)
+    {
+      Clock::time_point start = Clock::now();
+      HttpMessage<HttpRequest> msg;
+      if (byteAtATime_)
+        msg = HttpMessage<HttpRequest>::fromString(readByteAtATime(socket, calls));
+      else
+        msg = core.getMessage<HttpRequest>();
+      pResult_->parseMicroSecs += microSecs(start, Clock::now());
+      pResult_->headerBytes += msg.toHeaderString().size();
+      ++pResult_->messages;
+      socket.send(1, &ack);
+    }
+    pResult_->recvCalls = byteAtATime_ ? calls : socket.recvCount() - startCount;
+    pResult_->done = true;
+  }
+  //----< runs one configuration of the recv benchmark >---------------
+
+  bool runRecv(size_t port, size_t count, bool byteAtATime, RecvResult& result)
+  {
+    SocketListener listener(port, Socket::IP4);
+    HeaderParseHandler handler(&result, count, byteAtATime);
+    if (!listener.start(handler))
+      return false;
+
+    SocketConnecter connecter;
+    while (!connecter.connect("localhost", port))
+      ::Sleep(100);
+
+    std::string header = makeBrowserLikeRequest().toHeaderString();
+    Socket::byte ack;
+    for (size_t i = 0; i < count; ++i)
+    {
+      connecter.send(header.size(), &header[0]);
+      connecter.recv(1, &ack);
+    }
+    waitFor(result.done);
+    connecter.shutDown();
+    return true;
+  }
+  //----< recv benchmark: byte-at-a-time versus RecvBuffer >-----------
+
+  void benchRecv()
+  {
+    Util::title("recv: request header read and parse");
+    const size_t count = 2000;
+
+    RecvResult before, after;
+    if (!runRecv(9180, count, true, before) || !runRecv(9181, count, false, after))
+    {
+      std::cout << "\n  could not start listener";
+      return;
+    }
+
+    auto report = [](const std::string& name, const RecvResult& r)
+    {
+      std::cout << "\n  " << std::left << std::setw(16) << name << std::right
+        << std::setw(10) << r.messages
+        << std::setw(12) << r.headerBytes / (r.messages ? r.messages : 1)
+        << std::setw(14) << std::fixed << std::setprecision(1)
+        << double(r.recvCalls) / (r.messages ? r.messages : 1)
+        << std::setw(14) << std::setprecision(2)
+        << r.parseMicroSecs / (r.messages ? r.messages : 1);
+    };
+    std::cout << "\n  " << std::left << std::setw(16) << "mode" << std::right
+      << std::setw(10) << "messages" << std::setw(12) << "hdr bytes"
+      << std::setw(14) << "recv/msg" << std::setw(14) << "usec/msg";
+    report("byte-at-a-time", before);
+    report("RecvBuffer", after);
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // parse benchmark
+  // - no I/O, every mode parses the same header string
+  // - splitting reproduces fromString before HttpParser: the header is
+  //   split into trimmed lines, then each line into key and value
+
+  //----< fromString as it was before HttpParser >---------------------
+
+  HttpMessage<HttpRequest> fromStringSplitting(const std::string& src)
+  {
+    using Msg = HttpMessage<HttpRequest>;
+    std::vector<std::string> splits = Utilities::StringHelper::split(src, '\n');
+    if (splits.size() > 1)
+    {
+      std::vector<std::string> cmdSplits = Utilities::StringHelper::split(splits[0], ' ');
+      Msg msg;
+      if (cmdSplits.size() > 1)
+      {
+        msg.type() = HttpRequest::fromString(splits[0]);
+        msg.type().fileSpec(cmdSplits[1]);
+      }
+      for (size_t i = 1; i < splits.size(); ++i)
+      {
+        if (splits[i].size() == 0)
+          continue;
+        Msg::Key key = Msg::attribKey(splits[i]);
+        Msg::Value value = Msg::attribValue(splits[i]);
+        if (key.size() > 0)
+          msg.attributes()[key] = value;
+      }
+      return msg;
+    }
+    return Msg();
+  }
+  //----< parse benchmark: splitting versus HttpParser >---------------
+
+  void benchParse()
+  {
+    Util::title("parse: request header already in memory");
+    std::cout << "\n  " << std::left << std::setw(22) << "mode" << std::right
+      << std::setw(10) << "messages" << std::setw(12) << "usec/msg" << std::setw(12) << "msgs/sec";
+
+    const size_t count = 100000;
+    std::string header = makeBrowserLikeRequest().toHeaderString();
+    std::vector<std::string> modes { "split fromString", "HttpParser fromString", "HttpParser only" };
+    for (auto& mode : modes)
+    {
+      size_t fields = 0;
+      HttpParser parser;
+      Clock::time_point start = Clock::now();
+      for (size_t i = 0; i < count; ++i)
+      {
+        if (mode == modes[0])
+        {
+          fields += fromStringSplitting(header).attributes().size();
+        }
+        else if (mode == modes[1])
+        {
+          fields += HttpMessage<HttpRequest>::fromString(header).attributes().size();
+        }
+        else
+        {
+          parser.reset();
+          parser.parse(header.data(), header.size());
+          fields += parser.headerCount();
+        }
+      }
+      double usecs = microSecs(start, Clock::now()) / count;
+      std::cout << "\n  " << std::left << std::setw(22) << mode << std::right
+        << std::setw(10) << (fields > 0 ? count : 0) << std::fixed << std::setprecision(3)
+        << std::setw(12) << usecs << std::setprecision(0)
+        << std::setw(12) << (usecs > 0 ? 1.0e6 / usecs : 0.0);
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // headers benchmark
+  // - the map mode is how attributes were stored before HttpHeaders,
+  //   a node allocation and a hash for each attribute
+
+  void benchHeaders()
+  {
+    Util::title("headers: fill 12 attributes, look up 4");
+    std::cout << "\n  " << std::left << std::setw(22) << "mode" << std::right
+      << std::setw(10) << "messages" << std::setw(12) << "usec/msg" << std::setw(12) << "msgs/sec";
+
+    const size_t count = 200000;
+    std::vector<std::pair<std::string, std::string>> fields;
+    for (auto& header : makeBrowserLikeRequest().attributes())
+      fields.push_back({ header.name, header.value });
+    std::vector<std::string> lookups { "content-length", "connection", "name", "Cookie" };
+    std::vector<std::string> modes { "unordered_map", "HttpHeaders", "HttpHeaders reused" };
+    for (auto& mode : modes)
+    {
+      size_t found = 0;
+      HttpHeaders reused;
+      Clock::time_point start = Clock::now();
+      for (size_t i = 0; i < count; ++i)
+      {
+        if (mode == modes[0])
+        {
+          std::unordered_map<std::string, std::string> map;
+          for (auto& field : fields)
+            map[field.first] = field.second;
+          for (auto& key : lookups)
+            found += map.count(key);
+        }
+        else
+        {
+          HttpHeaders fresh;
+          HttpHeaders& headers = (mode == modes[1]) ? fresh : reused;
+          headers.clear();
+          for (auto& field : fields)
+            headers.set(field.first, field.second);
+          for (auto& key : lookups)
+            found += headers.contains(key) ? 1 : 0;
+        }
+      }
+      double usecs = microSecs(start, Clock::now()) / count;
+      std::cout << "\n  " << std::left << std::setw(22) << mode << std::right
+        << std::setw(10) << (found > 0 ? count : 0) << std::fixed << std::setprecision(3)
+        << std::setw(12) << usecs << std::setprecision(0)
+        << std::setw(12) << (usecs > 0 ? 1.0e6 / usecs : 0.0);
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // convert benchmark
+  // - StreamConverter is Utilities::Converter as it was before it used
+  //   to_chars and from_chars
+  // - the reply modes make a reply's three conversions: set its
+  //   content-length, write its status line, read its content-length
+
+  template <typename T>
+  struct StreamConverter
+  {
+    static std::string toString(const T& t)
+    {
+      std::ostringstream out;
+      out << t;
+      return out.str();
+    }
+    static T toValue(const std::string& src)
+    {
+      std::istringstream in(src);
+      T t;
+      in >> t;
+      return t;
+    }
+  };
+
+  //----< convert benchmark: string streams versus to_chars >----------
+
+  void benchConvert()
+  {
+    Util::title("convert: numbers to and from text");
+    std::cout << "\n  " << std::left << std::setw(26) << "mode" << std::right
+      << std::setw(10) << "count" << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op";
+
+    using Conv = Utilities::Converter<size_t>;
+    using Stream = StreamConverter<size_t>;
+    const size_t count = 200000;
+    const std::string text = "1048576";
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(200);
+    std::vector<std::string> modes {
+      "stream toString", "Converter toString", "Converter toChars",
+      "stream toValue", "Converter toValue",
+      "reply, streams", "reply, Converter"
+    };
+    for (auto& mode : modes)
+    {
+      size_t sum = 0;
+      char buffer[Conv::maxChars];
+      size_t startCount = allocationCount;
+      Clock::time_point start = Clock::now();
+      for (size_t i = 0; i < count; ++i)
+      {
+        if (mode == modes[0])
+          sum += Stream::toString(i).size();
+        else if (mode == modes[1])
+          sum += Conv::toString(i).size();
+        else if (mode == modes[2])
+          sum += Conv::toChars(i, buffer, sizeof(buffer));
+        else if (mode == modes[3])
+          sum += Stream::toValue(text);
+        else if (mode == modes[4])
+          sum += Conv::toValue(text);
+        else if (mode == modes[5])
+        {
+          reply.attributes().set("content-length", Stream::toString(i));
+          std::string statusLine = "HTTP/1.1 " + Stream::toString(reply.type().status()) + " " + reply.type().message();
+          sum += statusLine.size() + Stream::toValue(*reply.attributes().find("content-length"));
+        }
+        else
+        {
+          reply.contentLength(i);
+          std::string statusLine = reply.type().toString();
+          sum += statusLine.size() + reply.contentLength();
+        }
+      }
+      double nanoSecs = 1000.0 * microSecs(start, Clock::now()) / count;
+      double allocs = double(allocationCount - startCount) / count;
+      std::cout << "\n  " << std::left << std::setw(26) << mode << std::right
+        << std::setw(10) << (sum > 0 ? count : 0) << std::fixed << std::setprecision(1)
+        << std::setw(12) << nanoSecs << std::setw(12) << allocs;
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // split benchmark
+  // - trimCharwise and splitCharwise are StringHelper's trim and split
+  //   as they were before the SIMD kernels
+
+  std::string trimCharwise(const std::string& toTrim)
+  {
+    if (toTrim.size() == 0)
+      return toTrim;
+    std::string temp;
+    std::locale loc;
+    std::string::const_iterator iter = toTrim.begin();
+    while (isspace(*iter, loc))
+    {
+      if (++iter == toTrim.end())
+        break;
+    }
+    for (; iter != toTrim.end(); ++iter)
+      temp += *iter;
+    size_t pos = temp.size();
+    for (auto riter = temp.rbegin(); riter != temp.rend(); ++riter)
+    {
+      --pos;
+      if (!isspace(*riter, loc))
+        break;
+    }
+    if (pos < temp.size())
+      temp.erase(++pos);
+    return temp;
+  }
+
+  std::vector<std::string> splitCharwise(const std::string& toSplit, char splitOn)
+  {
+    std::vector<std::string> splits;
+    std::string temp;
+    for (char ch : toSplit)
+    {
+      if (ch != splitOn)
+      {
+        temp += ch;
+      }
+      else
+      {
+        splits.push_back(trimCharwise(temp));
+        temp.clear();
+      }
+    }
+    if (temp.length() > 0)
+      splits.push_back(trimCharwise(temp));
+    return splits;
+  }
+  //----< split benchmark: charwise versus SIMD kernels >--------------
+
+  void benchSplit()
+  {
+    Util::title("split: header blocks into trimmed lines");
+    std::cout << "\n  " << std::left << std::setw(22) << "mode" << std::right
+      << std::setw(10) << "block" << std::setw(10) << "lines" << std::setw(12) << "MB/sec"
+      << std::setw(14) << "allocs/block";
+
+    std::vector<std::string> modes { "split, charwise", "split, SIMD", "splitView, SIMD" };
+    for (size_t blockSize : { 4 * 1024, 16 * 1024 })
+    {
+      std::string block;
+      for (size_t i = 0; block.size() < blockSize; ++i)
+      {
+        block += "X-Header-" + Utilities::Converter<size_t>::toString(i) +
+          ":   value of a typical header field, with some padding  \r\n";
+      }
+      const size_t count = (64 * 1024 * 1024) / block.size() / 8;
+      for (auto& mode : modes)
+      {
+        size_t lines = 0;
+        std::vector<std::string_view> views;
+        size_t startCount = allocationCount;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+          if (mode == modes[0])
+            lines += splitCharwise(block, '\n').size();
+          else if (mode == modes[1])
+            lines += Util::split(block, '\n').size();
+          else
+          {
+            views.clear();
+            lines += Util::splitView(block, '\n', views);
+          }
+        }
+        double usecs = microSecs(start, Clock::now());
+        double allocs = double(allocationCount - startCount) / count;
+        std::cout << "\n  " << std::left << std::setw(22) << mode << std::right
+          << std::setw(10) << block.size() << std::setw(10) << lines / count
+          << std::fixed << std::setprecision(0)
+          << std::setw(12) << (usecs > 0 ? double(block.size()) * count / usecs : 0.0)
+          << std::setprecision(1) << std::setw(14) << allocs;
+        std::cout.flush();
+      }
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // send benchmark
+  // - client posts messages with large bodies, server only drains bytes
+  // - copying reproduces postMessage before gathering sends: message
+  //   passed by value, body copied again, then header, body, and a
+  //   trailing newline each sent separately
+
+  struct DrainResult
+  {
+    size_t expected = 0;
+    std::atomic<bool> done = false;
+  };
+
+  class DrainHandler
+  {
+  public:
+    DrainHandler(DrainResult* pResult) : pResult_(pResult) {}
+    void operator()(Socket&& socket);
+  private:
+    DrainResult* pResult_;
+  };
+
+  //----< server side of send benchmark >------------------------------
+
+  void DrainHandler::operator()(Socket&& socket)
+  {
+    std::vector<Socket::byte> buffer(64 * 1024);
+    size_t received = 0;
+    while (received < pResult_->expected)
+    {
+      size_t bytes = socket.recvStream(buffer.size(), buffer.data());
+      if (bytes == 0 || bytes > buffer.size())
+        break;
+      received += bytes;
+    }
+    pResult_->done = true;
+  }
+  //----< postMessage as it was before gathering sends >---------------
+
+  void postMessageCopying(Socket& socket, HttpMessage<HttpReply> msg)
+  {
+    std::string sendHeader = msg.toHeaderString();
+    socket.send(sendHeader.size(), (Socket::byte*)sendHeader.c_str());
+    size_t bodyLen = msg.contentLength();
+    if (bodyLen > 0)
+    {
+      HttpMessageBody body = msg.body();
+      socket.send(bodyLen, body.value().data());
+    }
+    socket.send(1, (Socket::byte*)"\n");
+  }
+  //----< runs one configuration of the send benchmark >---------------
+  /*
+  *  - returns microseconds per message, or a negative value if the
+  *    listener didn't start
+  */
+  double runSend(SocketListener& listener, size_t port, size_t bodySize, size_t count, bool copying)
+  {
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(200);
+    reply.body().size(bodySize);
+    reply.contentLength(bodySize);
+    size_t msgSize = reply.toHeaderString().size() + bodySize + (copying ? 1 : 0);
+
+    DrainResult result;
+    result.expected = msgSize * count;
+    DrainHandler handler(&result);
+    if (!listener.start(handler))
+      return -1.0;
+
+    SocketConnecter connecter;
+    while (!connecter.connect("127.0.0.1", port))
+      ::Sleep(100);
+    HttpCommCore comm(&connecter);
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (copying)
+        postMessageCopying(connecter, reply);
+      else
+        comm.postMessage(reply);
+    }
+    waitFor(result.done);
+    double elapsed = microSecs(start, Clock::now());
+    connecter.shutDown();
+    return elapsed / count;
+  }
+  //----< send benchmark: copying versus gathering postMessage >------
+
+  void benchSend()
+  {
+    Util::title("send: postMessage of large replies");
+    std::cout << "\n  " << std::left << std::setw(12) << "body" << std::setw(12) << "mode" << std::right
+      << std::setw(10) << "messages" << std::setw(12) << "sends/msg"
+      << std::setw(12) << "usec/msg" << std::setw(10) << "MB/sec";
+
+    struct Config { std::string name; size_t bodySize; size_t count; };
+    std::vector<Config> configs {
+      { "1 KB", 1024, 20000 }, { "64 KB", 64 * 1024, 2000 }, { "1 MB", 1024 * 1024, 200 }
+    };
+    std::vector<std::unique_ptr<SocketListener>> listeners;
+    size_t port = 9220;
+    for (auto& config : configs)
+    {
+      for (bool copying : { true, false })
+      {
+        listeners.emplace_back(new SocketListener(port, Socket::IP4));
+        double usecs = runSend(*listeners.back(), port++, config.bodySize, config.count, copying);
+        std::cout << "\n  " << std::left << std::setw(12) << config.name
+          << std::setw(12) << (copying ? "copying" : "gather") << std::right;
+        if (usecs < 0)
+        {
+          std::cout << "  could not start listener";
+          continue;
+        }
+        std::cout << std::setw(10) << config.count << std::setw(12) << (copying ? 3 : 1)
+          << std::fixed << std::setprecision(1) << std::setw(12) << usecs
+          << std::setw(10) << (usecs > 0 ? config.bodySize / usecs : 0.0);
+        std::cout.flush();
+      }
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // load benchmark
+  // - every client connects before any sends, so the server holds all
+  //   of them open at once
+  // - then each client sends one GET and all replies are collected
+
+  struct LoadResult
+  {
+    size_t connected = 0;
+    size_t completed = 0;
+    double connectMilliSecs = 0.0;
+    double requestMilliSecs = 0.0;
+  };
+
+  //----< small fixed reply so the benchmark measures the server >-----
+
+  HttpMessage<HttpReply> helloProc(HttpMessage<HttpRequest>& msg)
+  {
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(200);
+    std::string body = "<html><body>hello</body></html>";
+    reply.body() = body;
+    reply.contentLength(body.size());
+    return reply;
+  }
+  //----< server under test and the handler its listener copies >------
+  /*
+  *  - Servers outlive all runs.  A destroyed listener's detached
+  *    accept thread would otherwise touch whatever next occupies
+  *    the listener's memory.
+  */
+  struct LoadServer
+  {
+    LoadServer(size_t port) : server(port, Socket::IP4), handler(&server, false) {}
+    HttpServer server;
+    ClientHandler handler;
+  };
+  //----< runs one configuration of the load benchmark >---------------
+
+  bool runLoad(LoadServer& ls, size_t port, size_t clients, bool eventLoops, LoadResult& result)
+  {
+    HttpServer& server = ls.server;
+    bool started = eventLoops ? server.startEventLoops(4) : server.start(ls.handler);
+    if (!started)
+      return false;
+
+    std::vector<std::unique_ptr<SocketConnecter>> connecters;
+    connecters.reserve(clients);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < clients; ++i)
+    {
+      std::unique_ptr<SocketConnecter> pConnecter(new SocketConnecter);
+      if (!pConnecter->connect("127.0.0.1", port))
+        break;
+      connecters.push_back(std::move(pConnecter));
+    }
+    Clock::time_point connected = Clock::now();
+    result.connected = connecters.size();
+
+    HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/hello");
+    get.attribute("Host", "127.0.0.1");
+    std::string request = get.toHeaderString();
+    for (auto& pConnecter : connecters)
+      pConnecter->send(request.size(), &request[0]);
+    for (auto& pConnecter : connecters)
+    {
+      HttpCommCore comm(pConnecter.get());
+      HttpMessage<HttpReply> reply = comm.getMessage<HttpReply>();
+      if (reply.type().status() == 200)
+        ++result.completed;
+    }
+    Clock::time_point done = Clock::now();
+    result.connectMilliSecs = microSecs(start, connected) / 1000.0;
+    result.requestMilliSecs = microSecs(connected, done) / 1000.0;
+    return true;
+  }
+  //----< load benchmark: thread per connection versus event loops >---
+
+  void benchLoad()
+  {
+    Util::title("load: concurrent clients, one GET each");
+    std::cout << "\n  " << std::left << std::setw(10) << "clients" << std::setw(14) << "mode"
+      << std::right << std::setw(11) << "completed" << std::setw(13) << "connect ms"
+      << std::setw(13) << "request ms" << std::setw(12) << "req/sec";
+
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9190;
+    for (size_t clients : { 100, 1000, 10000 })
+    {
+      for (bool eventLoops : { false, true })
+      {
+        LoadResult result;
+        servers.emplace_back(new LoadServer(port));
+        servers.back()->server.addProc("GET", helloProc);
+        bool ran = runLoad(*servers.back(), port++, clients, eventLoops, result);
+
+        std::string mode = eventLoops ? "4 eventloops" : "threads";
+        std::cout << "\n  " << std::left << std::setw(10) << clients << std::setw(14) << mode << std::right;
+        if (!ran)
+        {
+          std::cout << "  could not start server";
+          continue;
+        }
+        double seconds = result.requestMilliSecs / 1000.0;
+        std::cout << std::setw(11) << result.completed
+          << std::setw(13) << std::fixed << std::setprecision(1) << result.connectMilliSecs
+          << std::setw(13) << result.requestMilliSecs
+          << std::setw(12) << std::setprecision(0) << (seconds > 0 ? result.completed / seconds : 0.0);
+        std::cout.flush();
+      }
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // keepalive benchmark
+  // - sequential requests from one client, so each close mode pays its
+  //   own connection setup, or doesn't
+
+  void benchKeepAlive()
+  {
+    Util::title("keepalive: 2000 sequential GETs from one client");
+    std::cout << "\n  " << std::left << std::setw(14) << "server" << std::setw(14) << "connection"
+      << std::right << std::setw(10) << "replies" << std::setw(13) << "connects"
+      << std::setw(12) << "usec/req";
+
+    const size_t numRequests = 2000;
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9200;
+    for (bool eventLoops : { false, true })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", helloProc);
+      server.keepAlive(numRequests, 5000);
+      bool started = eventLoops ? server.startEventLoops(4) : server.start(servers.back()->handler);
+
+      for (bool persist : { false, true })
+      {
+        HttpClient client;
+        size_t replies = 0;
+        Clock::time_point start = Clock::now();
+        if (started && client.connect("127.0.0.1", port))
+        {
+          for (size_t i = 0; i < numRequests; ++i)
+          {
+            HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/hello");
+            get.attribute("Host", "127.0.0.1");
+            get.keepAlive(persist);
+            if (client.postMessage(get).type().status() == 200)
+              ++replies;
+          }
+        }
+        Clock::time_point stop = Clock::now();
+
+        std::cout << "\n  " << std::left << std::setw(14) << (eventLoops ? "4 eventloops" : "threads")
+          << std::setw(14) << (persist ? "keep-alive" : "close") << std::right
+          << std::setw(10) << replies << std::setw(13) << client.connectCount()
+          << std::setw(12) << std::fixed << std::setprecision(1)
+          << (replies > 0 ? microSecs(start, stop) / replies : 0.0);
+        std::cout.flush();
+      }
+      ++port;
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // overload benchmark
+  // - more clients than cores, each request burning server CPU, so
+  //   the server can't keep up
+  // - reports latency percentiles of requests that were served
+
+  //----< reply after about a millisecond of computation >-------------
+
+  HttpMessage<HttpReply> busyProc(HttpMessage<HttpRequest>& msg)
+  {
+    Clock::time_point start = Clock::now();
+    volatile size_t spin = 0;
+    while (microSecs(start, Clock::now()) < 1000.0)
+      ++spin;
+    return helloProc(msg);
+  }
+  //----< value at fraction of sorted samples >------------------------
+
+  double percentile(const std::vector<double>& sorted, double fraction)
+  {
+    if (sorted.empty())
+      return 0.0;
+    size_t i = static_cast<size_t>(fraction * (sorted.size() - 1));
+    return sorted[i];
+  }
+  //----< overload benchmark: unbounded threads versus thread pool >---
+
+  void benchOverload()
+  {
+    Util::title("overload: 256 clients, 1 ms of server work per request");
+    std::cout << "\n  " << std::left << std::setw(18) << "server" << std::right
+      << std::setw(8) << "200s" << std::setw(8) << "503s"
+      << std::setw(11) << "p50 ms" << std::setw(11) << "p99 ms" << std::setw(11) << "max ms";
+
+    const size_t numClients = 256;
+    const size_t requestsPerClient = 20;
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9210;
+    for (bool pooled : { false, true })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", busyProc);
+      bool started = pooled ? server.startPool(servers.back()->handler, 8, 64) : server.start(servers.back()->handler);
+      if (!started)
+      {
+        std::cout << "\n  could not start server";
+        continue;
+      }
+
+      std::vector<double> latencies;
+      std::mutex latencyMtx;
+      std::atomic<size_t> busy = 0;
+      std::vector<std::thread> clients;
+      for (size_t c = 0; c < numClients; ++c)
+      {
+        clients.push_back(std::thread([&, port]()
+        {
+          HttpClient client;
+          client.connect("127.0.0.1", port);
+          for (size_t i = 0; i < requestsPerClient; ++i)
+          {
+            HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/busy");
+            get.attribute("Host", "127.0.0.1");
+            get.keepAlive(false);
+            Clock::time_point start = Clock::now();
+            size_t status = client.postMessage(get).type().status();
+            double milliSecs = microSecs(start, Clock::now()) / 1000.0;
+            if (status == 200)
+            {
+              std::lock_guard<std::mutex> lock(latencyMtx);
+              latencies.push_back(milliSecs);
+            }
+            else if (status == 503)
+            {
+              ++busy;
+            }
+          }
+        }));
+      }
+      for (auto& client : clients)
+        client.join();
+
+      std::sort(latencies.begin(), latencies.end());
+      std::cout << "\n  " << std::left << std::setw(18) << (pooled ? "pool 8, queue 64" : "thread/connection")
+        << std::right << std::setw(8) << latencies.size() << std::setw(8) << busy.load()
+        << std::fixed << std::setprecision(1)
+        << std::setw(11) << percentile(latencies, 0.50)
+        << std::setw(11) << percentile(latencies, 0.99)
+        << std::setw(11) << (latencies.empty() ? 0.0 : latencies.back());
+      std::cout.flush();
+      ++port;
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // file benchmark
+  // - the client reads every reply body into memory in both modes, so
+  //   differences are the server's cost of producing the body
+
+  //----< getProc as it was before file backed bodies >----------------
+
+  HttpMessage<HttpReply> getProcCopying(HttpMessage<HttpRequest>& msg)
+  {
+    HttpMessage<HttpReply> reply;
+    std::string fileSpec = "." + msg.type().fileSpec();
+    std::ifstream in(fileSpec, std::ios::binary);
+    if (!in.good())
+    {
+      reply.type().status(404);
+      return reply;
+    }
+    std::stringstream out;
+    out << in.rdbuf();
+    std::string text = out.str();
+    reply.contentLength(text.size());
+    reply.body().load(text.size(), (HttpMessageBody::byte*)&text[0]);
+    reply.type().status(200);
+    return reply;
+  }
+  //----< write a file of size bytes to serve >------------------------
+
+  bool makeFile(const std::string& fileSpec, size_t size)
+  {
+    std::ofstream out(fileSpec, std::ios::binary);
+    std::vector<char> block(1024 * 1024, 'x');
+    for (size_t written = 0; written < size && out.good(); written += block.size())
+      out.write(block.data(), (std::min)(block.size(), size - written));
+    return out.good();
+  }
+  //----< file benchmark: reading files versus TransmitFile >----------
+
+  void benchFile()
+  {
+    Util::title("file: GETs of static files over one connection");
+    std::cout << "\n  " << std::left << std::setw(10) << "file" << std::setw(12) << "mode"
+      << std::right << std::setw(10) << "replies" << std::setw(12) << "msec/req"
+      << std::setw(10) << "MB/sec";
+
+    struct Config { std::string name; std::string fileName; size_t size; size_t count; };
+    std::vector<Config> configs {
+      { "1 MB", "bench_1MB.dat", 1024 * 1024, 200 },
+      { "100 MB", "bench_100MB.dat", 100 * 1024 * 1024, 5 }
+    };
+    size_t cacheCapacity = fileCache().capacity();
+    fileCache().capacity(0);
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9230;
+    for (bool transmit : { false, true })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", transmit ? getProc : getProcCopying);
+      bool started = server.start(servers.back()->handler);
+
+      for (auto& config : configs)
+      {
+        std::cout << "\n  " << std::left << std::setw(10) << config.name
+          << std::setw(12) << (transmit ? "transmit" : "read") << std::right;
+        if (!started || !makeFile(config.fileName, config.size))
+        {
+          std::cout << "  could not start server or write file";
+          continue;
+        }
+        HttpClient client;
+        size_t replies = 0;
+        Clock::time_point start = Clock::now();
+        if (client.connect("127.0.0.1", port))
+        {
+          for (size_t i = 0; i < config.count; ++i)
+          {
+            HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/" + config.fileName);
+            get.attribute("Host", "127.0.0.1");
+            HttpMessage<HttpReply> reply = client.postMessage(get);
+            if (reply.type().status() == 200 && reply.body().size() == config.size)
+              ++replies;
+          }
+        }
+        double usecs = replies > 0 ? microSecs(start, Clock::now()) / replies : 0.0;
+        std::remove(config.fileName.c_str());
+
+        std::cout << std::setw(10) << replies << std::fixed << std::setprecision(2)
+          << std::setw(12) << usecs / 1000.0 << std::setprecision(0)
+          << std::setw(10) << (usecs > 0 ? config.size / usecs : 0.0);
+        std::cout.flush();
+      }
+      ++port;
+    }
+    fileCache().capacity(cacheCapacity);
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // cache benchmark
+  // - many small files requested round robin, like pages of a site,
+  //   all of which fit in the cache
+
+  void benchCache()
+  {
+    Util::title("cache: 20000 GETs of 300 8 KB files over one connection");
+    std::cout << "\n  " << std::left << std::setw(12) << "mode" << std::right
+      << std::setw(10) << "replies" << std::setw(12) << "usec/req"
+      << std::setw(10) << "hits";
+
+    const size_t numFiles = 300;
+    const size_t fileSize = 8 * 1024;
+    const size_t numRequests = 20000;
+    std::vector<std::string> fileNames;
+    for (size_t i = 0; i < numFiles; ++i)
+    {
+      fileNames.push_back("bench_page" + Utilities::Converter<size_t>::toString(i) + ".htm");
+      makeFile(fileNames.back(), fileSize);
+    }
+    size_t cacheCapacity = fileCache().capacity();
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9240;
+    for (std::string mode : { "read", "transmit", "cache" })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", (mode == "read") ? getProcCopying : getProc);
+      server.keepAlive(numRequests, 5000);
+      fileCache().clear();
+      fileCache().capacity(mode == "cache" ? cacheCapacity : 0);
+      size_t hitsBefore = fileCache().hits();
+
+      HttpClient client;
+      size_t replies = 0;
+      Clock::time_point start = Clock::now();
+      if (server.start(servers.back()->handler) && client.connect("127.0.0.1", port))
+      {
+        for (size_t i = 0; i < numRequests; ++i)
+        {
+          HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/" + fileNames[i % numFiles]);
+          get.attribute("Host", "127.0.0.1");
+          HttpMessage<HttpReply> reply = client.postMessage(get);
+          if (reply.type().status() == 200 && reply.body().size() == fileSize)
+            ++replies;
+        }
+      }
+      double usecs = replies > 0 ? microSecs(start, Clock::now()) / replies : 0.0;
+
+      std::cout << "\n  " << std::left << std::setw(12) << mode << std::right
+        << std::setw(10) << replies << std::fixed << std::setprecision(1)
+        << std::setw(12) << usecs << std::setw(10) << fileCache().hits() - hitsBefore;
+      std::cout.flush();
+      ++port;
+    }
+    fileCache().clear();
+    fileCache().capacity(cacheCapacity);
+    for (auto& fileName : fileNames)
+      std::remove(fileName.c_str());
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // compress benchmark
+  // - a 256 KB page of HTML table rows, sent as is, compressed for each
+  //   request, compressed once and cached, and from a .gz sibling
+  // - the client decodes every reply, so its cost is in usec/req, and a
+  //   probe reads one reply undecoded to show the bytes on the wire
+  // - over loopback bandwidth is free, so the interesting columns are
+  //   wire bytes and the cost per request of paying for them
+
+  const size_t pageSize = 256 * 1024;
+
+  //----< write a page of table rows, pageSize bytes >-----------------
+
+  bool makePage(const std::string& fileSpec)
+  {
+    std::string page = "<html><body><table>\n";
+    for (size_t row = 0; page.size() < pageSize; ++row)
+    {
+      page += "<tr><td>" + Utilities::Converter<size_t>::toString(row) + "</td><td>item "
+        + Utilities::Converter<size_t>::toString(row * 7919 % 10007) + "</td><td class=\"price\">"
+        + Utilities::Converter<size_t>::toString(row * 104729 % 100000) + "</td></tr>\n";
+    }
+    page.resize(pageSize);
+    std::ofstream out(fileSpec, std::ios::binary);
+    out.write(page.data(), page.size());
+    return out.good();
+  }
+  //----< size of one reply body as sent, read without decoding >------
+
+  size_t wireSize(size_t port, HttpMessage<HttpRequest>& get)
+  {
+    SocketConnecter socket;
+    if (!socket.connect("127.0.0.1", port))
+      return 0;
+    HttpCommCore comm(&socket);
+    comm.postMessage(get);
+    HttpMessage<HttpReply> reply = comm.getHeader<HttpReply>();
+    size_t size = (!comm.connectionClosed() && comm.getBody(reply)) ? reply.body().size() : 0;
+    socket.shutDown();
+    socket.close();
+    return size;
+  }
+  //----< compress benchmark: identity versus gzip, three ways >-------
+
+  void benchCompress()
+  {
+    Util::title("compress: 2000 GETs of a 256 KB HTML page over one connection");
+    std::cout << "\n  " << std::left << std::setw(22) << "mode" << std::right
+      << std::setw(10) << "replies" << std::setw(12) << "wire bytes"
+      << std::setw(12) << "usec/req" << std::setw(10) << "MB/sec";
+    if (!Compression::available())
+    {
+      std::cout << "\n  built without zlib, nothing to compare";
+      Utilities::putline();
+      return;
+    }
+
+    const std::string pageSpec = "bench_page.htm";
+    const size_t numRequests = 2000;
+    makePage(pageSpec);
+    size_t cacheCapacity = fileCache().capacity();
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9330;
+    for (std::string mode : { "identity", "gzip, per request", "gzip, cached", "gzip, precompressed" })
+    {
+      if (mode == "gzip, precompressed")
+      {
+        std::ifstream in(pageSpec, std::ios::binary);
+        std::vector<Compression::byte> page((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<Compression::byte> packed;
+        Compression::compress(page.data(), page.size(), Compression::gzip, packed, 9);
+        std::ofstream out(pageSpec + ".gz", std::ios::binary);
+        out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+      }
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", (mode == "gzip, per request") ? getProcCopying : getProc);
+      server.keepAlive(numRequests, 5000);
+      fileCache().clear();
+      fileCache().capacity(cacheCapacity);
+
+      HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/" + pageSpec);
+      get.attribute("Host", "127.0.0.1");
+      if (mode != "identity")
+        get.attribute("Accept-Encoding", "gzip, deflate");
+
+      HttpClient client;
+      size_t replies = 0, wire = 0;
+      Clock::time_point start = Clock::now();
+      if (server.start(servers.back()->handler) && client.connect("127.0.0.1", port))
+      {
+        for (size_t i = 0; i < numRequests; ++i)
+        {
+          HttpMessage<HttpReply> reply = client.postMessage(get);
+          if (reply.type().status() == 200 && reply.body().size() == pageSize)
+            ++replies;
+        }
+        wire = wireSize(port, get);
+      }
+      double usecs = replies > 0 ? microSecs(start, Clock::now()) / replies : 0.0;
+
+      std::cout << "\n  " << std::left << std::setw(22) << mode << std::right
+        << std::setw(10) << replies << std::setw(12) << wire << std::fixed << std::setprecision(1)
+        << std::setw(12) << usecs << std::setprecision(0)
+        << std::setw(10) << (usecs > 0 ? pageSize / usecs : 0.0);
+      std::cout.flush();
+      ++port;
+    }
+    fileCache().clear();
+    std::remove(pageSpec.c_str());
+    std::remove((pageSpec + ".gz").c_str());
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // conditional benchmark
+  // - a client that already holds the page asks for it again, as
+  //   browsers and caches revalidating do, getProc's FileCache is on
+
+  void benchConditional()
+  {
+    Util::title("conditional: 2000 GETs of a 256 KB page the client already has");
+    std::cout << "\n  " << std::left << std::setw(22) << "request" << std::right
+      << std::setw(10) << "replies" << std::setw(10) << "status" << std::setw(14) << "body bytes"
+      << std::setw(12) << "usec/req";
+
+    const std::string pageSpec = "bench_page.htm";
+    const size_t numRequests = 2000;
+    makePage(pageSpec);
+    fileCache().clear();
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9340;
+    for (std::string mode : { "unconditional", "If-None-Match", "If-Modified-Since" })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", getProc);
+      server.keepAlive(numRequests + 1, 5000);
+
+      HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/" + pageSpec);
+      get.attribute("Host", "127.0.0.1");
+      HttpClient client;
+      size_t replies = 0, bodyBytes = 0, status = 0;
+      double usecs = 0.0;
+      if (server.start(servers.back()->handler) && client.connect("127.0.0.1", port))
+      {
+        HttpMessage<HttpReply> first = client.postMessage(get);  // the copy the client holds
+        if (mode == "If-None-Match")
+          get.attribute("If-None-Match", first.attributes()["ETag"]);
+        else if (mode == "If-Modified-Since")
+          get.attribute("If-Modified-Since", first.attributes()["Last-Modified"]);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < numRequests; ++i)
+        {
+          HttpMessage<HttpReply> reply = client.postMessage(get);
+          status = reply.type().status();
+          if (status == 200 || status == 304)
+            ++replies;
+          bodyBytes += reply.body().size();
+        }
+        usecs = replies > 0 ? microSecs(start, Clock::now()) / replies : 0.0;
+      }
+
+      std::cout << "\n  " << std::left << std::setw(22) << mode << std::right
+        << std::setw(10) << replies << std::setw(10) << status << std::setw(14) << bodyBytes
+        << std::fixed << std::setprecision(1) << std::setw(12) << usecs;
+      std::cout.flush();
+      ++port;
+    }
+    fileCache().clear();
+    std::remove(pageSpec.c_str());
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // logger benchmark
+  // - messages go to a stream that discards them, counting writes,
+  //   each of which would be a system call for a console or file
+
+  class CountingBuf : public std::streambuf
+  {
+  public:
+    size_t writes = 0;
+  protected:
+    std::streamsize xsputn(const char*, std::streamsize count) override { ++writes; return count; }
+    int_type overflow(int_type ch) override { ++writes; return ch; }
+  };
+
+  //----< Logger as it was before its lock-free queue >----------------
+
+  class BlockingQueueLogger
+  {
+  public:
+    BlockingQueueLogger(std::ostream* pOut) : pOut_(pOut) {}
+    void start() { thread_ = std::thread([this]() { run(); }); }
+    void write(const std::string& msg) { queue_.enQ(msg); }
+    void stop() { queue_.enQ("quit"); thread_.join(); }
+  private:
+    void run()
+    {
+      while (true)
+      {
+        std::string msg = queue_.deQ();
+        if (msg == "quit")
+          break;
+        *pOut_ << msg;
+      }
+    }
+    std::ostream* pOut_;
+    BlockingQueue<std::string> queue_;
+    std::thread thread_;
+  };
+  //----< logger benchmark: BlockingQueue versus lock-free queue >-----
+
+  void benchLogger()
+  {
+    Util::title("logger: 64 threads writing connection events");
+    std::cout << "\n  " << std::left << std::setw(16) << "logger" << std::right
+      << std::setw(10) << "messages" << std::setw(12) << "ns/write"
+      << std::setw(12) << "allocs/msg" << std::setw(12) << "drain ms" << std::setw(10) << "writes"
+      << std::setw(12) << "burst ns";
+
+    const size_t numThreads = 64;
+    const size_t perThread = 20000;
+    const std::string address = "127.0.0.1";
+    const size_t port = 50000;
+    std::vector<std::string> modes { "BlockingQueue", "lock-free text", "lock-free log" };
+    for (auto& mode : modes)
+    {
+      CountingBuf buf;
+      std::ostream out(&buf);
+      Logger logger;
+      BlockingQueueLogger oldLogger(&out);
+      logger.attach(&out);
+      bool old = (mode == modes[0]);
+      bool records = (mode == modes[2]);
+      old ? oldLogger.start() : logger.start();
+      auto writeEvent = [&]()
+      {
+        if (records)
+          logger.log("\n  -- server accepted connection from {}:{}", address, port);
+        else if (old)
+          oldLogger.write("\n  -- server accepted connection from " + address + ":" + Utilities::Converter<size_t>::toString(port));
+        else
+          logger.write("\n  -- server accepted connection from " + address + ":" + Utilities::Converter<size_t>::toString(port));
+      };
+
+      const size_t burst = 4000;
+      Clock::time_point burstStart = Clock::now();
+      for (size_t i = 0; i < burst; ++i)
+        writeEvent();
+      double burstNanoSecs = 1000.0 * microSecs(burstStart, Clock::now()) / burst;
+      ::Sleep(200);  // let the burst drain
+
+      std::atomic<bool> go = false;
+      std::vector<std::thread> writers;
+      for (size_t t = 0; t < numThreads; ++t)
+      {
+        writers.push_back(std::thread([&]()
+        {
+          while (!go)
+            std::this_thread::yield();
+          for (size_t i = 0; i < perThread; ++i)
+            writeEvent();
+        }));
+      }
+      size_t allocationsBefore = allocationCount;
+      Clock::time_point start = Clock::now();
+      go = true;
+      for (auto& writer : writers)
+        writer.join();
+      Clock::time_point written = Clock::now();
+      size_t allocations = allocationCount - allocationsBefore;
+      old ? oldLogger.stop() : logger.stop();
+      Clock::time_point drained = Clock::now();
+
+      size_t messages = numThreads * perThread;
+      std::cout << "\n  " << std::left << std::setw(16) << mode
+        << std::right << std::setw(10) << messages << std::fixed << std::setprecision(1)
+        << std::setw(12) << 1000.0 * microSecs(start, written) / messages
+        << std::setw(12) << double(allocations) / messages
+        << std::setw(12) << microSecs(written, drained) / 1000.0
+        << std::setw(10) << buf.writes << std::setw(12) << burstNanoSecs;
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // allocs benchmark
+  // - counts start after a few warm up requests, so the file is cached
+  //   and reused buffers have grown
+
+  void benchAllocs()
+  {
+    Util::title("allocs: heap allocations per GET of a cached 4 KB file");
+    std::cout << "\n  " << std::left << std::setw(14) << "server" << std::right
+      << std::setw(10) << "replies" << std::setw(14) << "allocs/req";
+
+    const size_t warmUp = 10;
+    const size_t numRequests = 2000;
+    const std::string fileName = "bench_allocs.htm";
+    makeFile(fileName, 4096);
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9250;
+    for (bool eventLoops : { false, true })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", getProc);
+      server.keepAlive(warmUp + numRequests, 5000);
+      bool started = eventLoops ? server.startEventLoops(1) : server.start(servers.back()->handler);
+
+      HttpClient client;
+      HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/" + fileName);
+      get.attribute("Host", "127.0.0.1");
+      size_t replies = 0;
+      size_t allocations = 0;
+      if (started && client.connect("127.0.0.1", port))
+      {
+        for (size_t i = 0; i < warmUp; ++i)
+          client.postMessage(get);
+        size_t start = allocationCount;
+        for (size_t i = 0; i < numRequests; ++i)
+        {
+          if (client.postMessage(get).type().status() == 200)
+            ++replies;
+        }
+        allocations = allocationCount - start;
+      }
+      std::cout << "\n  " << std::left << std::setw(14) << (eventLoops ? "1 eventloop" : "threads")
+        << std::right << std::setw(10) << replies << std::fixed << std::setprecision(1)
+        << std::setw(14) << (replies > 0 ? double(allocations) / replies : 0.0);
+      std::cout.flush();
+      ++port;
+    }
+    std::remove(fileName.c_str());
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // connect benchmark
+  // - "localhost" usually resolves to ::1 first, which an IPv4 server
+  //   refuses, so the connect races on to 127.0.0.1
+  // - the unroutable address shows the timeout bounding a connect that
+  //   would otherwise wait for the OS connect timeout, unless the
+  //   network reports it unreachable at once
+
+  void benchConnect()
+  {
+    Util::title("connect: latency and attempts");
+    std::cout << "\n  " << std::left << std::setw(30) << "target" << std::right
+      << std::setw(10) << "result" << std::setw(10) << "ms" << std::setw(10) << "attempts";
+
+    const size_t port = 9260;
+    SocketListener listener(port, Socket::IP4);
+    DrainResult result;
+    DrainHandler handler(&result);
+    bool listening = listener.start(handler);
+
+    struct Target
+    {
+      std::string name;
+      std::string address;
+      size_t port;
+      size_t timeout;
+    };
+    std::vector<Target> targets {
+      { "localhost, IPv4 server", "localhost", port, SocketConnecter::defaultTimeout },
+      { "127.0.0.1, no server", "127.0.0.1", port + 1, SocketConnecter::defaultTimeout },
+      { "10.255.255.1, 500 ms timeout", "10.255.255.1", port, 500 }
+    };
+    bool served = false;
+    for (auto& target : targets)
+    {
+      SocketConnecter connecter;
+      bool connected = connecter.connect(target.address, target.port, target.timeout);
+      served = served || (connected && target.port == port);
+      std::cout << "\n  " << std::left << std::setw(30) << target.name << std::right
+        << std::setw(10) << (connected ? "connected" : "failed")
+        << std::setw(10) << connecter.connectMilliSecs()
+        << std::setw(10) << connecter.connectAttempts();
+      std::cout.flush();
+      if (connected)
+        connecter.shutDown();
+    }
+    if (listening && served)
+      waitFor(result.done);
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // pool benchmark
+  // - concurrent callers posting to one server, connecting for every
+  //   request versus sharing pooled connections
+  // - a pool smaller than the number of callers makes them wait
+
+  void benchPool()
+  {
+    Util::title("pool: 8 threads each send 250 GETs");
+    std::cout << "\n  " << std::left << std::setw(20) << "connections" << std::right
+      << std::setw(10) << "replies" << std::setw(13) << "connects"
+      << std::setw(12) << "req/sec";
+
+    const size_t numThreads = 8;
+    const size_t perThread = 250;
+    const size_t port = 9270;
+    LoadServer ls(port);
+    ls.server.addProc("GET", helloProc);
+    ls.server.keepAlive(numThreads * perThread, 5000);
+    if (!ls.server.startEventLoops(4))
+      return;
+    EndPoint ep("127.0.0.1", port);
+
+    for (size_t poolSize : { size_t(0), size_t(2), size_t(8) })
+    {
+      HttpConnectionPool pool(poolSize);
+      std::atomic<size_t> replies = 0, connects = 0;
+      auto post = [&]() {
+        for (size_t i = 0; i < perThread; ++i)
+        {
+          HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/hello");
+          get.attribute("Host", "127.0.0.1");
+          HttpMessage<HttpReply> reply;
+          if (poolSize > 0)
+          {
+            reply = pool.postMessage(ep, get);
+          }
+          else
+          {
+            HttpClient client;
+            if (client.connect(ep.address, ep.port))
+              reply = client.postMessage(get);
+            connects += client.connectCount();
+          }
+          if (reply.type().status() == 200)
+            ++replies;
+        }
+      };
+      Clock::time_point start = Clock::now();
+      std::vector<std::thread> threads;
+      for (size_t t = 0; t < numThreads; ++t)
+        threads.push_back(std::thread(post));
+      for (auto& thread : threads)
+        thread.join();
+      Clock::time_point stop = Clock::now();
+      if (poolSize > 0)
+        connects = pool.connectCount();
+
+      std::string name = poolSize > 0 ? "pool of " + std::to_string(poolSize) : "new per request";
+      std::cout << "\n  " << std::left << std::setw(20) << name << std::right
+        << std::setw(10) << replies << std::setw(13) << connects
+        << std::setw(12) << std::fixed << std::setprecision(0)
+        << replies / (microSecs(start, stop) / 1e6);
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // pipeline benchmark
+  // - one thread, one connection, so throughput is set by how many
+  //   round trips overlap
+  // - a window of 1 costs what a synchronous client does, plus the
+  //   hand off to the reader thread
+
+  void benchPipeline()
+  {
+    Util::title("pipeline: one thread sends 2000 GETs over one connection");
+    std::cout << "\n  " << std::left << std::setw(14) << "server" << std::setw(20) << "client"
+      << std::right << std::setw(10) << "replies" << std::setw(12) << "req/sec";
+
+    const size_t numRequests = 2000;
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9280;
+    for (bool eventLoops : { false, true })
+    {
+      servers.emplace_back(new LoadServer(port));
+      HttpServer& server = servers.back()->server;
+      server.addProc("GET", helloProc);
+      server.keepAlive(numRequests, 5000);
+      bool started = eventLoops ? server.startEventLoops(4) : server.start(servers.back()->handler);
+      HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/hello");
+      get.attribute("Host", "127.0.0.1");
+
+      for (size_t window : { size_t(0), size_t(1), size_t(16), size_t(256) })
+      {
+        size_t replies = 0;
+        Clock::time_point start = Clock::now();
+        if (started && window == 0)
+        {
+          HttpClient client;
+          if (client.connect("127.0.0.1", port))
+          {
+            for (size_t i = 0; i < numRequests; ++i)
+              if (client.postMessage(get).type().status() == 200)
+                ++replies;
+          }
+        }
+        else if (started)
+        {
+          HttpAsyncClient client(window);
+          if (client.connect("127.0.0.1", port))
+          {
+            std::atomic<size_t> ok = 0;
+            for (size_t i = 0; i < numRequests; ++i)
+              client.postMessage(get, [&ok](HttpMessage<HttpReply>& reply) {
+                if (reply.type().status() == 200)
+                  ++ok;
+              });
+            client.close();  // waits for outstanding replies
+            replies = ok;
+          }
+        }
+        Clock::time_point stop = Clock::now();
+
+        std::string name = window == 0 ? "HttpClient" : "async, " + std::to_string(window) + " in flight";
+        std::cout << "\n  " << std::left << std::setw(14) << (eventLoops ? "4 eventloops" : "threads")
+          << std::setw(20) << name << std::right << std::setw(10) << replies
+          << std::setw(12) << std::fixed << std::setprecision(0)
+          << (replies > 0 ? replies / (microSecs(start, stop) / 1e6) : 0.0);
+        std::cout.flush();
+      }
+      ++port;
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // slow benchmark
+  // - every handler waits, as one calling another server or reading a
+  //   slow disk would, so the server's capacity is how many requests
+  //   it can keep waiting at once
+  // - a blocking handler holds its thread while it waits, a coroutine
+  //   handler holds only its frame
+
+  const std::chrono::milliseconds slowWait(50);
+
+  //----< reply after blocking the thread for slowWait >---------------
+
+  HttpMessage<HttpReply> blockingSlowProc(HttpMessage<HttpRequest>& msg)
+  {
+    std::this_thread::sleep_for(slowWait);
+    return helloProc(msg);
+  }
+  //----< reply after suspending for slowWait >------------------------
+
+  Task<HttpMessage<HttpReply>> coSlowProc(HttpMessage<HttpRequest>& msg)
+  {
+    co_await sleepFor(slowWait);
+    co_return helloProc(msg);
+  }
+  //----< slow benchmark: blocking versus coroutine handlers >---------
+
+  void benchSlow()
+  {
+    Util::title("slow: concurrent clients, handler waits 50 ms");
+    std::cout << "\n  " << std::left << std::setw(10) << "clients" << std::setw(26) << "mode"
+      << std::right << std::setw(11) << "completed" << std::setw(13) << "request ms"
+      << std::setw(12) << "req/sec";
+
+    struct Config { size_t clients; bool eventLoops; bool coroutine; };
+    std::vector<Config> configs {
+      { 100, false, false }, { 100, true, false }, { 100, true, true },
+      { 1000, false, false }, { 1000, true, true }, { 5000, false, false }, { 5000, true, true }
+    };
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9290;
+    for (auto& config : configs)
+    {
+      servers.emplace_back(new LoadServer(port));
+      if (config.coroutine)
+        servers.back()->server.addProc("GET", coSlowProc);
+      else
+        servers.back()->server.addProc("GET", blockingSlowProc);
+      LoadResult result;
+      bool ran = runLoad(*servers.back(), port++, config.clients, config.eventLoops, result);
+
+      std::string mode = config.eventLoops ? "4 eventloops" : "threads";
+      mode += config.coroutine ? ", coroutine" : ", blocking";
+      std::cout << "\n  " << std::left << std::setw(10) << config.clients << std::setw(26) << mode << std::right;
+      if (!ran)
+      {
+        std::cout << "  could not start server";
+        continue;
+      }
+      double seconds = result.requestMilliSecs / 1000.0;
+      std::cout << std::setw(11) << result.completed
+        << std::setw(13) << std::fixed << std::setprecision(1) << result.requestMilliSecs
+        << std::setw(12) << std::setprecision(0) << (seconds > 0 ? result.completed / seconds : 0.0);
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // oneway benchmark
+  // - telemetry-like traffic: small messages whose sender doesn't need
+  //   an answer
+  // - time runs from the first post until the last message has been
+  //   handled, i.e., replied to or deQ'd by the Receiver
+
+  void benchOneWay()
+  {
+    Util::title("oneway: one thread sends 20000 small POSTs");
+    std::cout << "\n  " << std::left << std::setw(28) << "mode" << std::right
+      << std::setw(11) << "handled" << std::setw(10) << "dropped" << std::setw(12) << "msg/sec";
+
+    const size_t numMessages = 20000;
+    const size_t port = 9300;
+    LoadServer ls(port);
+    ls.server.addProc("POST", helloProc);
+    ls.server.keepAlive(numMessages, 5000);
+    bool started = ls.server.startEventLoops(4);
+    Receiver receiver(port + 1, Socket::IP4, numMessages);
+    started = receiver.start() && started;
+
+    auto makePost = [](size_t i, size_t toPort) {
+      HttpMessage<HttpRequest> post = makeHttpRequestMessage(HttpRequest::POST, "/telemetry");
+      post.attribute("Host", "127.0.0.1");
+      post.to(EndPoint("127.0.0.1", toPort));
+      post.body() = std::string("sample=") + std::to_string(i) + ";cpu=42;mem=1024";
+      return post;
+    };
+
+    std::vector<std::string> modes { "HttpClient, request/reply", "async, 256 in flight", "Sender to Receiver" };
+    for (auto& mode : modes)
+    {
+      size_t handled = 0, dropped = 0;
+      Clock::time_point start = Clock::now();
+      if (started && mode == modes[0])
+      {
+        HttpClient client;
+        if (client.connect("127.0.0.1", port))
+        {
+          for (size_t i = 0; i < numMessages; ++i)
+            if (client.postMessage(makePost(i, port)).type().status() == 200)
+              ++handled;
+        }
+      }
+      else if (started && mode == modes[1])
+      {
+        HttpAsyncClient client(256);
+        if (client.connect("127.0.0.1", port))
+        {
+          std::atomic<size_t> ok = 0;
+          for (size_t i = 0; i < numMessages; ++i)
+            client.postMessage(makePost(i, port), [&ok](HttpMessage<HttpReply>& reply) {
+              if (reply.type().status() == 200)
+                ++ok;
+            });
+          client.close();
+          handled = ok;
+        }
+      }
+      else if (started)
+      {
+        Sender sender(numMessages);
+        sender.start();
+        for (size_t i = 0; i < numMessages; ++i)
+          sender.postMessage(makePost(i, port + 1));
+        sender.stop();  // sends what was queued
+        dropped = sender.dropped();
+        for (; handled < sender.sent(); ++handled)
+          receiver.getMessage();
+      }
+      Clock::time_point stop = Clock::now();
+
+      std::cout << "\n  " << std::left << std::setw(28) << mode << std::right
+        << std::setw(11) << handled << std::setw(10) << dropped
+        << std::setw(12) << std::fixed << std::setprecision(0)
+        << (handled > 0 ? handled / (microSecs(start, stop) / 1e6) : 0.0);
+      std::cout.flush();
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // chunked benchmark
+  // - the client reads the reply into one 64 KB buffer and discards
+  //   it, so the largest allocation is the server's
+
+  const size_t reportSize = 100 * 1024 * 1024;
+
+  //----< write bytes [offset, offset + size) of the report >----------
+
+  void fillReport(HttpMessageBody::byte* buffer, size_t size, size_t offset)
+  {
+    for (size_t i = 0; i < size; ++i)
+      buffer[i] = static_cast<HttpMessageBody::byte>('a' + (offset + i) % 26);
+  }
+  //----< reply with the whole report in the body >--------------------
+
+  HttpMessage<HttpReply> wholeReportProc(HttpMessage<HttpRequest>&)
+  {
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(200);
+    reply.body().size(reportSize);
+    fillReport(reply.body().value().data(), reportSize, 0);
+    reply.contentLength(reportSize);
+    return reply;
+  }
+  //----< reply with the report produced a chunk at a time >-----------
+
+  HttpMessage<HttpReply> streamReportProc(HttpMessage<HttpRequest>&)
+  {
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(200);
+    auto offset = std::make_shared<size_t>(0);
+    reply.stream([offset](HttpMessageBody::byte* buffer, size_t size) {
+      size_t bytes = (std::min)(size, reportSize - *offset);
+      fillReport(buffer, bytes, *offset);
+      *offset += bytes;
+      return bytes;
+    });
+    return reply;
+  }
+  //----< chunked benchmark: whole versus stream bodies >--------------
+
+  void benchChunked()
+  {
+    Util::title("chunked: GETs of a generated 100 MB report");
+    std::cout << "\n  " << std::left << std::setw(14) << "server" << std::setw(16) << "body"
+      << std::right << std::setw(14) << "bytes read" << std::setw(16) << "largest alloc"
+      << std::setw(10) << "MB/sec";
+
+    const size_t requests = 3;
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9310;
+    for (bool eventLoops : { false, true })
+    {
+      for (bool stream : { false, true })
+      {
+        servers.emplace_back(new LoadServer(port));
+        HttpServer& server = servers.back()->server;
+        server.addProc("GET", stream ? streamReportProc : wholeReportProc);
+        bool started = eventLoops ? server.startEventLoops(4) : server.start(servers.back()->handler);
+
+        size_t bytesRead = 0;
+        largestAllocation = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; started && i < requests; ++i)
+        {
+          SocketConnecter si;
+          if (!si.connect("127.0.0.1", port))
+            break;
+          HttpMessage<HttpRequest> get = makeHttpRequestMessage(HttpRequest::GET, "/report");
+          get.attribute("Host", "127.0.0.1");
+          get.keepAlive(false);  // the server closes after the reply, ending the read
+          HttpCommCore comm(&si);
+          comm.postMessage(get);
+          std::vector<Socket::byte> buffer(64 * 1024);
+          size_t bytes;
+          while ((bytes = si.recvStream(buffer.size(), buffer.data())) > 0 && bytes != static_cast<size_t>(SOCKET_ERROR))
+            bytesRead += bytes;
+        }
+        Clock::time_point stop = Clock::now();
+
+        std::cout << "\n  " << std::left << std::setw(14) << (eventLoops ? "4 eventloops" : "threads")
+          << std::setw(16) << (stream ? "stream, chunked" : "whole") << std::right
+          << std::setw(14) << bytesRead << std::setw(16) << largestAllocation
+          << std::setw(10) << std::fixed << std::setprecision(0)
+          << (bytesRead / (1024.0 * 1024.0)) / (microSecs(start, stop) / 1e6);
+        std::cout.flush();
+        ++port;
+      }
+    }
+    Utilities::putline();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // upload benchmark
+  // - the client sends a file backed body, from disk, so the largest
+  //   allocation is the server's
+
+  const size_t uploadSize = 128 * 1024 * 1024;
+
+  //----< write the whole body, which the server has already read >----
+
+  HttpMessage<HttpReply> bufferedPutProc(HttpMessage<HttpRequest>& msg)
+  {
+    const HttpMessageBody& body = msg.body();
+    std::ofstream out("." + msg.type().fileSpec(), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(body.value().data()), body.size());
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(out ? 200 : 500);
+    reply.contentLength(0);
+    return reply;
+  }
+  //----< upload benchmark: buffered versus streamed request bodies >--
+
+  void benchUpload()
+  {
+    Util::title("upload: PUTs of a 128 MB file");
+    std::cout << "\n  " << std::left << std::setw(14) << "server" << std::setw(16) << "body"
+      << std::right << std::setw(14) << "bytes sent" << std::setw(16) << "largest alloc"
+      << std::setw(10) << "MB/sec";
+
+    const std::string sourceSpec = "upload_source.tmp";
+    {
+      std::ofstream out(sourceSpec, std::ios::binary);
+      std::vector<char> block(64 * 1024);
+      for (size_t written = 0; written < uploadSize; written += block.size())
+      {
+        fillReport(reinterpret_cast<HttpMessageBody::byte*>(block.data()), block.size(), written);
+        out.write(block.data(), block.size());
+      }
+    }
+
+    const size_t requests = 2;
+    std::vector<std::unique_ptr<LoadServer>> servers;
+    size_t port = 9320;
+    for (bool eventLoops : { false, true })
+    {
+      for (bool stream : { false, true })
+      {
+        servers.emplace_back(new LoadServer(port));
+        HttpServer& server = servers.back()->server;
+        if (stream)
+          server.addProc("PUT", putProc);
+        else
+          server.addProc("PUT", bufferedPutProc);
+        server.maxBodySize(uploadSize);  // the buffered server reads it whole
+        bool started = eventLoops ? server.startEventLoops(4) : server.start(servers.back()->handler);
+
+        size_t bytesSent = 0;
+        largestAllocation = 0;
+        Clock::time_point start = Clock::now();
+        HttpClient client;
+        for (size_t i = 0; started && i < requests; ++i)
+        {
+          if (!client.connect("127.0.0.1", port))
+            break;
+          HttpMessage<HttpRequest> put = makeHttpRequestMessage(HttpRequest::PUT, "/upload_target.tmp");
+          put.attribute("Host", "127.0.0.1");
+          put.body().file(sourceSpec, uploadSize);
+          put.contentLength(uploadSize);
+          size_t status = client.postMessage(put).type().status();
+          if (status == 200 || status == 201)
+            bytesSent += uploadSize;
+        }
+        Clock::time_point stop = Clock::now();
+        client.close();
+
+        std::cout << "\n  " << std::left << std::setw(14) << (eventLoops ? "4 eventloops" : "threads")
+          << std::setw(16) << (stream ? "stream, putProc" : "buffered") << std::right
+          << std::setw(14) << bytesSent << std::setw(16) << largestAllocation
+          << std::setw(10) << std::fixed << std::setprecision(0)
+          << (bytesSent / (1024.0 * 1024.0)) / (microSecs(start, stop) / 1e6);
+        std::cout.flush();
+        ++port;
+      }
+    }
+    DeleteFileA(sourceSpec.c_str());
+    DeleteFileA("upload_target.tmp");
+    Utilities::putline();
+  }
+}
+
+//----< benchmark entry point >----------------------------------------
+
+int main(int argc, char* argv[])
+{
+  using Benchmark = std::pair<std::string, std::function<void()>>;
+  std::vector<Benchmark> benchmarks {
+    { "recv", benchRecv },
+    { "parse", benchParse },
+    { "headers", benchHeaders },
+    { "convert", benchConvert },
+    { "split", benchSplit },
+    { "send", benchSend },
+    { "load", benchLoad },
+    { "keepalive", benchKeepAlive },
+    { "overload", benchOverload },
+    { "file", benchFile },
+    { "cache", benchCache },
+    { "compress", benchCompress },
+    { "conditional", benchConditional },
+    { "logger", benchLogger },
+    { "allocs", benchAllocs },
+    { "connect", benchConnect },
+    { "pool", benchPool },
+    { "pipeline", benchPipeline },
+    { "slow", benchSlow },
+    { "oneway", benchOneWay },
+    { "chunked", benchChunked },
+    { "upload", benchUpload }
+  };
+
+  Util::Title("HttpBenchmark - costs of communication hot paths");
+  Utilities::putline();
+
+  SocketSystem ss;
+  for (auto& bench : benchmarks)
+  {
+    bool selected = (argc < 2);
+    for (int i = 1; i < argc; ++i)
+      if (bench.first == argv[i])
+        selected = true;
+    if (selected)
+      bench.second();
+  }
+  std::cout << "\n\n";
+  return 0;
+}
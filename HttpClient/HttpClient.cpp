@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////
 // HttpClient.cpp - Demonstrates simple HTTP messaging                 //
-// ver 1.0                                                             //
+// ver 2.0                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2017           //
 // Application: OOD Projects                                           //
 // Platform:    Visual Studio 2017, Dell XPS 8920, Windows 10 pro      //
@@ -15,6 +15,12 @@
 #include <string>
 #include <iostream>
 #include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <cstring>
 
 using Show = StaticLogger<1>;
 using namespace Utilities;
@@ -22,23 +28,410 @@ using namespace Sockets;
 
 using namespace HttpCommunication;
 
+//----< may msg be sent again if its connection closed unanswered? >---
+/*
+*  - the server may have acted on it before closing, so only methods
+*    that are safe to repeat qualify, and a stream body's producer is
+*    used up by the first send, so it can't be sent twice
+*/
+static bool resendable(const HttpMessage<HttpRequest>& msg)
+{
+  switch (msg.type().command())
+  {
+  case HttpRequest::GET:
+  case HttpRequest::HEAD:
+  case HttpRequest::PUT:
+  case HttpRequest::DELETE:
+    return !msg.body().isStream();
+  default:
+    return false;
+  }
+}
+
 HttpClient::HttpClient() : HttpCommCore(&socket) {}
 
 //----< sends message and waits for reply >----------------------------
-
-HttpMessage<HttpReply> HttpClient::postMessage(HttpMessage<HttpRequest> msg)
+/*
+*  - HTTP/1.1 connections persist by default, so msg is sent as is,
+*    without being copied.  Give it a connection:close attribute to
+*    close the connection after the reply.
+*  - if a reused connection turns out to have been closed by the server
+*    before any reply arrives, an idempotent message whose body can be
+*    sent again is sent once more on a new connection, anything else
+*    returns the empty reply, status 400
+*/
+HttpMessage<HttpReply> HttpClient::postMessage(const HttpMessage<HttpRequest>& msg)
 {
+  if ((!connected_ || stale()) && !reconnect())
+    return HttpMessage<HttpReply>();
+
+  bool reused = lastUse_ != Clock::time_point();  // reconnect clears lastUse_
   HttpCommCore::postMessage<HttpRequest>(msg);
   HttpMessage<HttpReply> reply = HttpCommCore::getMessage<HttpReply>();
+
+  if (connectionClosed() && reused && resendable(msg))
+  {
+    if (!reconnect())
+      return HttpMessage<HttpReply>();
+    HttpCommCore::postMessage<HttpRequest>(msg);
+    reply = HttpCommCore::getMessage<HttpReply>();
+  }
+  lastUse_ = Clock::now();
+  if (connectionClosed() || !msg.keepAlive() || !reply.keepAlive())
+    close();
   return reply;
 }
-//----< reconnect to new target >--------------------------------------
+//----< connect to target, reusing open connection to same target >---
 
 bool HttpClient::connect(const std::string& address, size_t port)
 {
-  socket.shutDown();
-  return socket.connect(address, port);
+  if (connected_ && address == address_ && port == port_ && !stale())
+    return true;
+  address_ = address;
+  port_ = port;
+  return reconnect();
+}
+//----< close current connection >-------------------------------------
+
+void HttpClient::close()
+{
+  if (connected_)
+  {
+    socket.shutDown();
+    socket.close();
+  }
+  connected_ = false;
+}
+//----< open a new connection to current target >----------------------
+
+bool HttpClient::reconnect()
+{
+  close();
+  lastUse_ = Clock::time_point();
+  connected_ = socket.connect(address_, port_, connectTimeout_);
+  if (connected_)
+  {
+    socket.noDelay(true);
+    ++connectCount_;
+  }
+  return connected_;
+}
+//----< has connection been idle long enough server may drop it? >----
+
+bool HttpClient::stale() const
+{
+  if (lastUse_ == Clock::time_point())
+    return false;
+  return Clock::now() - lastUse_ > std::chrono::milliseconds(idleTimeout_);
+}
+/////////////////////////////////////////////////////////////////////////
+// HttpConnectionPool class members
+
+HttpConnectionPool::HttpConnectionPool(size_t maxPerHost, size_t idleTimeout)
+  : maxPerHost_(maxPerHost > 0 ? maxPerHost : 1), idleTimeout_(idleTimeout) {}
+
+//----< send message to ep on a pooled connection, wait for reply >----
+/*
+*  - if a reused connection turns out to have been closed by the server
+*    before any reply arrives, an idempotent message whose body can be
+*    sent again is sent once more on a new connection, as HttpClient
+*    does
+*  - the connection goes back to the pool only if both sides asked to
+*    keep it open
+*/
+HttpMessage<HttpReply> HttpConnectionPool::postMessage(const EndPoint& ep, const HttpMessage<HttpRequest>& msg)
+{
+  std::unique_ptr<Connection> pConn = checkout(ep);
+  if (!pConn)
+    return HttpMessage<HttpReply>();
+
+  bool reused = pConn->lastUse != Clock::time_point();
+  pConn->comm.postMessage<HttpRequest>(msg);
+  HttpMessage<HttpReply> reply = pConn->comm.getMessage<HttpReply>();
+
+  if (pConn->comm.connectionClosed() && reused && resendable(msg))
+  {
+    pConn->socket.close();
+    if (!connect(ep, *pConn))
+    {
+      checkin(ep, std::move(pConn), false);
+      return HttpMessage<HttpReply>();
+    }
+    pConn->comm.postMessage<HttpRequest>(msg);
+    reply = pConn->comm.getMessage<HttpReply>();
+  }
+  bool reusable = !pConn->comm.connectionClosed() && msg.keepAlive() && reply.keepAlive();
+  checkin(ep, std::move(pConn), reusable);
+  return reply;
+}
+//----< take idle connection to ep, or open one, waiting if at limit >
+/*
+*  - returns nullptr if a new connection can't be made
+*  - connects outside the lock, holding a reserved slot, so one slow
+*    host doesn't stall callers posting to other hosts
+*  - each host has its own condition, so a freed slot wakes a caller
+*    waiting for that host
+*/
+std::unique_ptr<HttpConnectionPool::Connection> HttpConnectionPool::checkout(const EndPoint& ep)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  Host& host = hosts_[ep];
+  while (true)
+  {
+    while (!host.idle.empty())
+    {
+      std::unique_ptr<Connection> pConn = std::move(host.idle.back());
+      host.idle.pop_back();
+      if (healthy(*pConn, Clock::now()))
+        return pConn;
+      --host.open;    // pConn's destructor closes its socket
+    }
+    if (host.open < maxPerHost_)
+      break;
+    host.cv.wait(lock);
+  }
+  ++host.open;
+  lock.unlock();
+
+  std::unique_ptr<Connection> pConn(new Connection);
+  if (connect(ep, *pConn))
+    return pConn;
+
+  lock.lock();
+  --host.open;
+  host.cv.notify_one();
+  return nullptr;
 }
+//----< return connection to pool, or close it and free its slot >-----
+
+void HttpConnectionPool::checkin(const EndPoint& ep, std::unique_ptr<Connection> pConn, bool reusable)
+{
+  if (reusable)
+    pConn->lastUse = Clock::now();
+  else
+    pConn->socket.shutDown();
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  Host& host = hosts_[ep];
+  if (reusable)
+    host.idle.push_back(std::move(pConn));
+  else
+    --host.open;
+  host.cv.notify_one();
+}
+//----< is idle connection fresh, and not closed by the server? >-----
+/*
+*  - an idle connection has nothing to read, unless the server closed
+*    it or sent something unasked for, either way it can't be used
+*/
+bool HttpConnectionPool::healthy(Connection& conn, Clock::time_point now) const
+{
+  if (now - conn.lastUse > std::chrono::milliseconds(idleTimeout_))
+    return false;
+  return !conn.socket.waitForData(0);
+}
+//----< open connection to ep >----------------------------------------
+
+bool HttpConnectionPool::connect(const EndPoint& ep, Connection& conn)
+{
+  conn.lastUse = Clock::time_point();
+  if (!conn.socket.connect(ep.address, ep.port, connectTimeout_))
+    return false;
+  conn.socket.noDelay(true);
+  ++connectCount_;
+  return true;
+}
+//----< number of connections to ep, idle and in use >-----------------
+
+size_t HttpConnectionPool::openCount(const EndPoint& ep)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = hosts_.find(ep);
+  return iter == hosts_.end() ? 0 : iter->second.open;
+}
+//----< number of idle connections to ep >-----------------------------
+
+size_t HttpConnectionPool::idleCount(const EndPoint& ep)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = hosts_.find(ep);
+  return iter == hosts_.end() ? 0 : iter->second.idle.size();
+}
+//----< close all idle connections >-----------------------------------
+/*
+*  - connections in use are closed when they're returned
+*/
+void HttpConnectionPool::clear()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto& item : hosts_)
+  {
+    Host& host = item.second;
+    host.open -= host.idle.size();
+    host.idle.clear();
+    host.cv.notify_all();
+  }
+}
+/////////////////////////////////////////////////////////////////////////
+// HttpAsyncClient class members
+
+HttpAsyncClient::HttpAsyncClient(size_t maxInFlight)
+  : maxInFlight_(maxInFlight > 0 ? maxInFlight : 1) {}
+
+HttpAsyncClient::~HttpAsyncClient()
+{
+  close();
+}
+//----< connect to target and start reading replies >------------------
+
+bool HttpAsyncClient::connect(const std::string& address, size_t port, size_t timeout)
+{
+  close();
+  if (!socket_.connect(address, port, timeout))
+    return false;
+  socket_.noDelay(true);
+  connected_ = true;
+  reader_ = std::thread([this]() { readReplies(); });
+  return true;
+}
+//----< send message, returning future for its reply >-----------------
+
+std::future<HttpAsyncClient::Reply> HttpAsyncClient::postMessage(const HttpMessage<HttpRequest>& msg)
+{
+  Pending pending;
+  std::future<Reply> future = pending.promise.get_future();
+  send(msg, std::move(pending));
+  return future;
+}
+//----< send message, reader thread calls callback with its reply >----
+
+void HttpAsyncClient::postMessage(const HttpMessage<HttpRequest>& msg, Callback callback)
+{
+  Pending pending;
+  pending.callback = callback;
+  send(msg, std::move(pending));
+}
+//----< queue pending reply, then send, waiting if window is full >----
+/*
+*  - sendMtx_ is held from queuing to sending, so requests go out in
+*    the order their replies are expected
+*  - checking connected_ and queuing under mtx_ means the reader can't
+*    fail outstanding requests between them and miss this one
+*  - called from a callback, on the reader thread, it completes with no
+*    reply instead, waiting for the window or sendMtx_ there would wait
+*    for the reader itself
+*/
+void HttpAsyncClient::send(const HttpMessage<HttpRequest>& msg, Pending&& pending)
+{
+  if (std::this_thread::get_id() == readerId_.load())
+  {
+    complete(pending, Reply());
+    return;
+  }
+  std::lock_guard<std::mutex> sendLock(sendMtx_);
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [&]() { return pending_.size() < maxInFlight_ || !connected_; });
+    if (!connected_)
+    {
+      lock.unlock();
+      complete(pending, Reply());
+      return;
+    }
+    pending_.push_back(std::move(pending));
+  }
+  cv_.notify_all();
+  comm_.postMessage<HttpRequest>(msg);
+}
+//----< reader thread: match each reply to oldest pending request >----
+/*
+*  - after close() it keeps reading until nothing is outstanding
+*/
+void HttpAsyncClient::readReplies()
+{
+  readerId_.store(std::this_thread::get_id());
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [&]() { return !pending_.empty() || !connected_; });
+      if (pending_.empty())
+        break;
+    }
+    Reply reply = comm_.getMessage<HttpReply>();
+    if (comm_.connectionClosed())
+      break;
+    Pending pending;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      pending = std::move(pending_.front());
+      pending_.pop_front();
+    }
+    cv_.notify_all();
+    bool keepAlive = reply.keepAlive();
+    complete(pending, std::move(reply));
+    if (!keepAlive)
+      break;  // server closes after this reply, later requests are lost
+  }
+  readerId_.store(std::thread::id());
+  failPending();
+}
+//----< stop sending and complete outstanding requests with no reply >
+
+void HttpAsyncClient::failPending()
+{
+  std::deque<Pending> failed;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    connected_ = false;
+    failed.swap(pending_);
+  }
+  cv_.notify_all();
+  for (auto& pending : failed)
+    complete(pending, Reply());
+}
+//----< deliver reply to future or callback >--------------------------
+
+void HttpAsyncClient::complete(Pending& pending, Reply&& reply)
+{
+  if (pending.callback)
+    pending.callback(reply);
+  else
+    pending.promise.set_value(std::move(reply));
+}
+//----< wait for outstanding replies, then close connection >----------
+/*
+*  - senders waiting for room in the window complete with no reply
+*  - waits no longer than closeTimeout, then shuts the socket down, so
+*    the reader's getMessage returns and it fails the requests still
+*    outstanding
+*/
+void HttpAsyncClient::close()
+{
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    connected_ = false;
+    cv_.notify_all();
+    cv_.wait_for(lock, std::chrono::milliseconds(closeTimeout_.load()),
+      [&]() { return pending_.empty(); });
+  }
+  if (reader_.joinable())
+  {
+    socket_.shutDown();
+    reader_.join();
+    std::lock_guard<std::mutex> sendLock(sendMtx_);
+    socket_.close();
+  }
+}
+//----< number of requests sent and not yet answered >-----------------
+
+size_t HttpAsyncClient::inFlight()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return pending_.size();
+}
+
+#ifdef TEST_HTTPCLIENT
 
 int main()
 {
@@ -57,6 +450,8 @@ int main()
 
   HttpClient client;
 
+  // connect reuses the open connection after the first iteration
+
   for (size_t i = 0; i < 3; ++i)
   {
     client.connect("localhost", 8080);
@@ -70,6 +465,7 @@ int main()
     reply.show();
     Utilities::putline();
   }
+  std::cout << "\n--3 messages sent over " << client.connectCount() << " connection(s)";
 
   HttpMessage<HttpRequest> postMsg;
   postMsg.type().command(HttpRequest::POST);
@@ -78,8 +474,11 @@ int main()
   postMsg.body().load(11, (HttpMessage<HttpRequest>::byte*)"hello world");
   postMsg.contentLength(postMsg.body().size());
 
+  // an unreachable or missing host fails within connectTimeout
+
   std::string machine = "Odin";
   std::cout << "\n--posting message to \"" << machine << ":8080\"";
+  client.connectTimeout(2000);
   if (client.connect(machine, 8080))
   {
     HttpMessage<HttpReply> reply = client.postMessage(postMsg);
@@ -88,11 +487,192 @@ int main()
   }
   else
   {
-    std::cout << "\n--could not connect to \"" << machine << "\"";
+    std::cout << "\n--could not connect to \"" << machine << "\", gave up after "
+      << client.connectMilliSecs() << " ms";
+  }
+
+  // many threads share a pool of at most 2 connections to the server
+
+  std::cout << "\n\n--posting 20 messages from 4 threads through a connection pool";
+  HttpConnectionPool pool(2);
+  EndPoint server("localhost", 8080);
+  std::atomic<size_t> replies = 0;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    threads.push_back(std::thread([&]() {
+      for (size_t i = 0; i < 5; ++i)
+      {
+        if (pool.postMessage(server, getMsg).type().status() == 200)
+          ++replies;
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+  std::cout << "\n--" << replies << " of 20 replies were OK, sent over "
+    << pool.connectCount() << " connection(s), " << pool.idleCount(server) << " now idle";
+
+  // the server sends a report a chunk at a time, the client reassembles it
+
+  std::cout << "\n\n--requesting a 100000 line report, sent chunked";
+  HttpMessage<HttpRequest> reportMsg = makeHttpRequestMessage(HttpRequest::GET, "/report");
+  reportMsg.attribute("command", "report");
+  reportMsg.attribute("lines", "100000");
+  if (client.connect("localhost", 8080))
+  {
+    HttpMessage<HttpReply> report = client.postMessage(reportMsg);
+    const HttpMessageBody& body = report.body();
+    std::cout << "\n--received " << report.contentLength() << " bytes, "
+      << std::count(body.value().begin(), body.value().end(), '\n') << " lines";
+  }
+  else
+  {
+    std::cout << "\n--could not connect";
+  }
+
+  // a file backed body is sent from disk, and the server's putProc
+  // writes it to disk as it arrives, so neither holds it in memory
+
+  const std::string uploadSpec = "upload.tmp";
+  const size_t uploadSize = 4 * 1024 * 1024;
+  {
+    std::ofstream out(uploadSpec, std::ios::binary);
+    std::string block(64 * 1024, 'u');
+    for (size_t written = 0; written < uploadSize; written += block.size())
+      out.write(block.data(), block.size());
+  }
+  std::cout << "\n\n--uploading a " << uploadSize << " byte file with PUT";
+  HttpMessage<HttpRequest> putMsg = makeHttpRequestMessage(HttpRequest::PUT, "/uploaded.tmp");
+  putMsg.body().file(uploadSpec, uploadSize);
+  putMsg.contentLength(uploadSize);
+  if (client.connect("localhost", 8080))
+  {
+    HttpMessage<HttpReply> putReply = client.postMessage(putMsg);
+    std::cout << "\n--upload replied with status " << putReply.type().status();
+  }
+  else
+  {
+    std::cout << "\n--could not connect";
+  }
+  DeleteFileA(uploadSpec.c_str());
+
+  // a Range request fetches parts of the uploaded file, several ranges
+  // come back as parts of a multipart/byteranges body
+
+  std::cout << "\n\n--requesting ranges of the uploaded file";
+  HttpMessage<HttpRequest> rangeMsg = makeHttpRequestMessage(HttpRequest::GET, "/uploaded.tmp");
+  for (std::string ranges : { "bytes=0-99", "bytes=0-9,-10" })
+  {
+    rangeMsg.attribute("Range", ranges);
+    if (!client.connect("localhost", 8080))
+    {
+      std::cout << "\n--could not connect";
+      break;
+    }
+    HttpMessage<HttpReply> part = client.postMessage(rangeMsg);
+    std::cout << "\n--" << ranges << ": status " << part.type().status() << ", "
+      << part.contentLength() << " bytes, " << part.attributes()["Content-Range"]
+      << part.attributes()["Content-Type"];
+  }
+
+  // a client that accepts gzip gets a compressed body, which
+  // postMessage decodes, so the caller sees the file as it was
+
+  std::cout << "\n\n--requesting a text file with Accept-Encoding: gzip";
+  std::string text;
+  for (size_t i = 0; i < 4000; ++i)
+    text += "line " + std::to_string(i) + " of a file that compresses well\n";
+  HttpMessage<HttpRequest> textPut = makeHttpRequestMessage(HttpRequest::PUT, "/uploaded.txt");
+  textPut.body() = text;
+  textPut.contentLength(text.size());
+  HttpMessage<HttpRequest> textGet = makeHttpRequestMessage(HttpRequest::GET, "/uploaded.txt");
+  textGet.attribute("Accept-Encoding", "gzip");
+  if (client.connect("localhost", 8080) && client.postMessage(textPut).type().status() / 100 == 2 &&
+    client.connect("localhost", 8080))
+  {
+    HttpMessage<HttpReply> textReply = client.postMessage(textGet);
+    const HttpMessageBody& body = textReply.body();
+    bool same = std::string(body.value().begin(), body.value().end()) == text;
+    std::cout << "\n--received " << body.size() << " bytes, " << (same ? "" : "not ")
+      << "the file that was uploaded, " << text.size() << " bytes";
+
+    // a client that has the file sends its ETag back, and while the
+    // file is unchanged the server replies 304, with no body
+
+    std::cout << "\n\n--requesting the text file again, If-None-Match: " << textReply.attributes()["ETag"];
+    textGet.attribute("If-None-Match", textReply.attributes()["ETag"]);
+    if (client.connect("localhost", 8080))
+    {
+      HttpMessage<HttpReply> cached = client.postMessage(textGet);
+      std::cout << "\n--status " << cached.type().status() << " " << cached.type().message()
+        << ", " << cached.body().size() << " bytes"
+        << (cached.type().status() == 304 ? ", the copy already received is current" : "");
+    }
+  }
+  else
+  {
+    std::cout << "\n--could not connect";
+  }
+
+  // a body sent chunked, from a stream, is reassembled by the server
+  // for a handler that takes the whole body, and the connection is
+  // ready for the next request once it has been read
+
+  std::cout << "\n\n--posting a 10000 byte body, sent chunked, to a handler that echoes it";
+  HttpMessage<HttpRequest> echoMsg = makeHttpRequestMessage(HttpRequest::POST, "/echo");
+  echoMsg.attribute("command", "echo");
+  const size_t echoSize = 10000;
+  auto echoSent = std::make_shared<size_t>(0);
+  echoMsg.stream([echoSent, echoSize](HttpMessageBody::byte* buffer, size_t size) {
+    size_t bytes = (std::min)(size, echoSize - *echoSent);
+    std::memset(buffer, 'e', bytes);
+    *echoSent += bytes;
+    return bytes;
+  }, 4096);
+  if (client.connect("localhost", 8080))
+  {
+    HttpMessage<HttpReply> echo = client.postMessage(echoMsg);
+    const std::vector<HttpMessageBody::byte>& echoed = echo.body().value();
+    size_t matching = std::count(echoed.begin(), echoed.end(), 'e');
+    std::cout << "\n--echoed " << matching << " of " << echoSize << " bytes";
+    if (client.connect("localhost", 8080))
+    {
+      HttpMessage<HttpReply> next = client.postMessage(getMsg);
+      std::cout << ", next request on the connection replied " << next.type().status();
+    }
+  }
+  else
+  {
+    std::cout << "\n--could not connect";
+  }
+
+  // one thread keeps 50 requests in flight on one connection
+
+  std::cout << "\n\n--pipelining 50 messages over one connection";
+  HttpAsyncClient asyncClient;
+  if (asyncClient.connect("localhost", 8080))
+  {
+    std::vector<std::future<HttpMessage<HttpReply>>> futures;
+    for (size_t i = 0; i < 50; ++i)
+      futures.push_back(asyncClient.postMessage(getMsg));
+    std::cout << "\n--" << asyncClient.inFlight() << " in flight after sending";
+    size_t ok = 0;
+    for (auto& future : futures)
+    {
+      if (future.get().type().status() == 200)
+        ++ok;
+    }
+    std::cout << "\n--" << ok << " of 50 pipelined replies were OK";
+  }
+  else
+  {
+    std::cout << "\n--could not connect";
   }
   std::cout << "\n\n";
 
   Show::write("\n --------------------\n  press key to exit: \n --------------------");
   std::cout.flush();
   std::cin.get();
-}
\ No newline at end of file
+}
+#endif
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // HttpClient.h - Demonstrates simple HTTP messaging                   //
-// ver 1.0                                                             //
+// ver 2.4                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2017           //
 // Application: OOD Projects                                           //
 // Platform:    Visual Studio 2017, Dell XPS 8920, Windows 10 pro      //
@@ -10,17 +10,105 @@
 *  Package Operations:
 * ---------------------
 *   This package implements a client that sends HTTP messages to a
-*   server that displays them.
+*   server that displays them, a pool of connections that many
+*   threads use to send messages to many servers, and an asynchronous
+*   client that pipelines messages over one connection.
+*   HttpClient:
+*   - The connection is kept open between messages.  connect(...) to the
+*     current target reuses it, and postMessage reconnects if the server
+*     closed it, so many messages can be sent over one socket.
+*   - A GET, HEAD, PUT, or DELETE sent on a reused connection that the
+*     server closed before replying is sent again on a new one, unless
+*     its body is a stream.  Other messages may have been acted on, so
+*     they return an empty reply, status 400, instead.
+*   - A connection idle for longer than idleTimeout milliseconds is
+*     replaced rather than reused, as the server may have dropped it.
+*   - Connecting gives up after connectTimeout milliseconds, and
+*     connectMilliSecs() reports how long the last connect took.
+*   - Replies sent with chunked transfer-encoding are reassembled, the
+*     reply's content-length is set to the length of the whole body.
+*   HttpConnectionPool:
+*   - postMessage(ep, msg) sends msg to the server at EndPoint ep on an
+*     idle connection to ep, if there is one, else on a new connection,
+*     and returns the connection to the pool when the reply arrives.
+*   - At most maxPerHost connections to each EndPoint are open at once.
+*     Callers that would exceed it wait for a connection to that
+*     EndPoint to be returned.
+*   - Messages are resent on a new connection only as HttpClient resends
+*     them.
+*   - An idle connection is checked before it's handed out, and closed
+*     instead if it has been idle longer than idleTimeout or the server
+*     has closed it.  The most recently used connection is handed out
+*     first, so the rest can age out.
+*   - Thread safe.  Connections are owned by one caller at a time, so
+*     only checkout and checkin take the pool's lock.
+*   HttpAsyncClient:
+*   - postMessage(msg) sends msg at once and returns a future for its
+*     reply, or, given a callback, calls it with the reply.  Many
+*     requests may be outstanding on one connection, HTTP/1.1
+*     pipelining, so one thread can keep hundreds in flight.
+*   - The server replies in request order, so a reader thread matches
+*     each reply to the oldest outstanding request.  Callbacks run on
+*     that thread and should return quickly.  They must not call
+*     postMessage, the reader would wait on itself, so a message posted
+*     from a callback completes at once with an empty reply.
+*   - At most maxInFlight requests are outstanding, postMessage blocks
+*     until a reply frees a place.
+*   - If the connection closes, requests still outstanding complete
+*     with an empty reply, status 400.  They aren't resent, the server
+*     may have acted on some of them.  connect() again to continue.
+*   - close(), and the destructor, wait at most closeTimeout
+*     milliseconds for outstanding replies, then close the connection,
+*     failing those still outstanding, so a server that stops answering
+*     can't hang them.
 *
 *  Required Files:
 * -----------------
 *   StringClient.cpp, StringServer.cpp
 *   Sockets.h, Sockets.cpp
-*   Logger.h, Logger.cpp, Cpp11-BlockingQueue.h
+*   Logger.h, Logger.cpp, MpscQueue.h
 *   Utilities.h, Utilities.cpp
 *
 *  Maintenance History:
 * ----------------------
+*   ver 2.4 : 17 Oct 2026
+*   - HttpAsyncClient::close waits at most closeTimeout for replies,
+*     and postMessage called from a callback completes with no reply
+*   ver 2.3 : 17 Oct 2026
+*   - HttpConnectionPool resends only as HttpClient does, and each host
+*     has its own condition, so a returned connection wakes a caller
+*     waiting for its host
+*   ver 2.2 : 17 Oct 2026
+*   - HttpClient resends a message on a new connection only if it's
+*     idempotent and its body isn't a stream
+*   ver 2.1 : 17 Oct 2026
+*   - test stub posts a chunked body to a handler that echoes it
+*   ver 2.0 : 17 Oct 2026
+*   - test stub sends a conditional GET, If-None-Match, for a file it has
+*   ver 1.9 : 17 Oct 2026
+*   - replies encoded with gzip or deflate are decoded, by HttpCommCore,
+*     test stub requests a file with Accept-Encoding: gzip
+*   ver 1.8 : 17 Oct 2026
+*   - test stub requests ranges of the file it uploaded
+*   ver 1.7 : 17 Oct 2026
+*   - test stub uploads a file with PUT
+*   ver 1.6 : 17 Oct 2026
+*   - replies may be chunked, test stub requests a chunked report
+*   ver 1.5 : 17 Oct 2026
+*   - added HttpAsyncClient
+*   ver 1.4 : 17 Oct 2026
+*   - added HttpConnectionPool
+*   ver 1.3 : 17 Oct 2026
+*   - added connectTimeout and connectMilliSecs, connects are bounded
+*     by SocketConnecter's timeout instead of the OS connect timeout
+*   ver 1.2 : 17 Oct 2026
+*   - postMessage takes its message by const reference, so it no longer
+*     adds connection:keep-alive, which is HTTP/1.1's default anyway
+*   ver 1.1 : 17 Oct 2026
+*   - added keep-alive: requests ask the server to keep the connection
+*     open, which the client reuses until the server closes it or it
+*     goes idle
+*   - main is now the test stub, defined by TEST_HTTPCLIENT
 *   ver 1.0 : 07 Jan 2017
 *   - first release
 */
@@ -28,6 +116,18 @@
 #include "../Message/Message.h"
 #include "../HttpCommCore/HttpCommCore.h"
 #include "../Sockets/Sockets.h"
+#include <string>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <functional>
+#include <thread>
 
 namespace HttpCommunication
 {
@@ -38,12 +138,123 @@ namespace HttpCommunication
   class HttpClient : HttpCommCore
   {
   public:
+    using Clock = std::chrono::steady_clock;
+
     HttpClient();
-    HttpMessage<HttpReply> postMessage(HttpMessage<HttpRequest> msg);
+    HttpMessage<HttpReply> postMessage(const HttpMessage<HttpRequest>& msg);
     bool connect(const std::string& address, size_t port);
+    void close();
+    bool connected() const { return connected_; }
+    void idleTimeout(size_t milliSecs) { idleTimeout_ = milliSecs; }
+    void connectTimeout(size_t milliSecs) { connectTimeout_ = milliSecs; }
+    size_t connectCount() const { return connectCount_; }
+    size_t connectMilliSecs() const { return socket.connectMilliSecs(); }
   private:
+    bool reconnect();
+    bool stale() const;
     Sockets::SocketConnecter socket;
     Sockets::SocketSystem ss;
+    std::string address_;
+    size_t port_ = 0;
+    bool connected_ = false;
+    size_t idleTimeout_ = 4000;   // below server's default, so client drops first
+    size_t connectCount_ = 0;
+    size_t connectTimeout_ = Sockets::SocketConnecter::defaultTimeout;
+    Clock::time_point lastUse_;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // HttpConnectionPool class
+  // - posts Http messages to many EndPoints, from many threads, over
+  //   reused connections
+
+  class HttpConnectionPool
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    HttpConnectionPool(size_t maxPerHost = 8, size_t idleTimeout = 4000);
+    HttpConnectionPool(const HttpConnectionPool&) = delete;
+    HttpConnectionPool& operator=(const HttpConnectionPool&) = delete;
+    HttpMessage<HttpReply> postMessage(const EndPoint& ep, const HttpMessage<HttpRequest>& msg);
+    void connectTimeout(size_t milliSecs) { connectTimeout_ = milliSecs; }
+    size_t openCount(const EndPoint& ep);
+    size_t idleCount(const EndPoint& ep);
+    size_t connectCount() const { return connectCount_; }
+    void clear();
+  private:
+    struct Connection
+    {
+      Sockets::SocketConnecter socket;
+      HttpCommCore comm{ &socket };
+      Clock::time_point lastUse;
+    };
+    struct Host
+    {
+      std::vector<std::unique_ptr<Connection>> idle;  // most recently used last
+      size_t open = 0;                                // idle and checked out
+      std::condition_variable cv;                     // signaled when a slot frees
+    };
+    std::unique_ptr<Connection> checkout(const EndPoint& ep);
+    void checkin(const EndPoint& ep, std::unique_ptr<Connection> pConn, bool reusable);
+    bool healthy(Connection& conn, Clock::time_point now) const;
+    bool connect(const EndPoint& ep, Connection& conn);
+
+    Sockets::SocketSystem ss_;
+    std::map<EndPoint, Host> hosts_;
+    std::mutex mtx_;
+    size_t maxPerHost_;
+    size_t idleTimeout_;
+    std::atomic<size_t> connectTimeout_ = Sockets::SocketConnecter::defaultTimeout;
+    std::atomic<size_t> connectCount_ = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // HttpAsyncClient class
+  // - posts Http messages without waiting for replies, pipelining
+  //   them over one connection
+
+  class HttpAsyncClient
+  {
+  public:
+    using Reply = HttpMessage<HttpReply>;
+    using Callback = std::function<void(Reply&)>;
+
+    HttpAsyncClient(size_t maxInFlight = 256);
+    HttpAsyncClient(const HttpAsyncClient&) = delete;
+    HttpAsyncClient& operator=(const HttpAsyncClient&) = delete;
+    ~HttpAsyncClient();
+    bool connect(const std::string& address, size_t port,
+      size_t timeout = Sockets::SocketConnecter::defaultTimeout);
+    std::future<Reply> postMessage(const HttpMessage<HttpRequest>& msg);
+    void postMessage(const HttpMessage<HttpRequest>& msg, Callback callback);
+    void close();
+    void closeTimeout(size_t milliSecs) { closeTimeout_ = milliSecs; }
+    bool connected() const { return connected_; }
+    size_t inFlight();
+  private:
+    struct Pending
+    {
+      std::promise<Reply> promise;
+      Callback callback;
+    };
+    void send(const HttpMessage<HttpRequest>& msg, Pending&& pending);
+    void readReplies();
+    void failPending();
+    static void complete(Pending& pending, Reply&& reply);
+
+    Sockets::SocketSystem ss_;
+    Sockets::SocketConnecter socket_;
+    HttpCommCore comm_{ &socket_ };
+    std::thread reader_;
+    std::atomic<std::thread::id> readerId_;  // callbacks run on this thread
+    std::deque<Pending> pending_;   // oldest first, in send order
+    std::mutex sendMtx_;            // keeps pending_ in send order
+    std::mutex mtx_;                // guards pending_
+    std::condition_variable cv_;
+    size_t maxInFlight_;
+    std::atomic<size_t> closeTimeout_ = 10000;
+    std::atomic<bool> connected_ = false;
   };
 }
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // HttpCommCore.h - Provides core HTTP Message services                //
-// ver 1.1                                                             //
+// ver 2.4                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2018           //
 // Application: OOD Projects                                           //
 // Platform:    Visual Studio 2017, Dell XPS 8920, Windows 10 pro      //
@@ -13,15 +13,69 @@
 *   code for its derived classes, HttpClient and HttpServer.
 * - It's purpose is to provide a prototype for communication message for
 *   OOD and DO projects.
+* - getMessage reads a whole message.  getHeader reads only the header,
+*   leaving the body to getBody, or to an HttpBodyReader, which hands
+*   it to its caller a piece at a time, so a body of any size can be
+*   consumed, e.g., written to a file, in a fixed amount of memory.
+* - getMessage<HttpReply> decodes a body with a gzip or deflate
+*   Content-Encoding, so clients see the body the server encoded.
 *
 * Required Files:
 * ---------------
 *   HttpCommCore.h, HttpCommCore.cpp
 *   Message.h, Message.cpp
+*   HttpParser.h, HttpParser.cpp
+*   Compression.h, Compression.cpp
 *   Sockets.h, Sockets.cpp
 *
 * Maintenance History:
 * --------------------
+*   ver 2.4 : 17 Oct 2026
+*   - getBody stops reading a chunked body once it's more than maxSize,
+*     see bodyTooLarge()
+*   ver 2.3 : 17 Oct 2026
+*   - getBody takes a maxSize, and reads no body larger than that, see
+*     bodyTooLarge()
+*   ver 2.2 : 17 Oct 2026
+*   - getBody reads no body for 1xx, 204, and 304 replies, whatever
+*     their content-length says
+*   ver 2.1 : 17 Oct 2026
+*   - getMessage decodes gzip and deflate encoded reply bodies
+*   ver 2.0 : 17 Oct 2026
+*   - a file backed body is sent from its offset in the file
+*   ver 1.9 : 17 Oct 2026
+*   - added HttpBodyReader, and getHeader and getBody, the two halves
+*     of getMessage
+*   - chunked bodies are decoded by an HttpBodyReader
+*   ver 1.8 : 17 Oct 2026
+*   - postMessage sends a stream body with chunked transfer-encoding, one
+*     chunk at a time, so only one chunk is held in memory
+*   - getMessage decodes a chunked body into the message, which it then
+*     marks with the body's content-length
+*   ver 1.7 : 17 Oct 2026
+*   - getMessage receives the body into the returned message instead of
+*     a local body that was then copied into it
+*   ver 1.6 : 17 Oct 2026
+*   - getMessage parses the header in the socket's RecvBuffer with an
+*     HttpParser instead of collecting lines into a string and splitting
+*     it.  connectionClosed() is also true after a header that can't be
+*     parsed, since the rest of the stream can't be trusted.
+*   ver 1.5 : 17 Oct 2026
+*   - postMessage sends a file backed body with Socket::sendFile, so
+*     the file's contents are never read into memory
+*   ver 1.4 : 17 Oct 2026
+*   - postMessage takes its message by const reference and sends header
+*     and body with one gathering send, without copying the body.  The
+*     header is built in a buffer reused by each postMessage call.
+*   ver 1.3 : 17 Oct 2026
+*   - postMessage no longer sends a newline after the message, which
+*     would be read as part of the next message on a kept-alive
+*     connection
+*   - getMessage skips blank lines before a message and records when
+*     the peer has closed the connection, see connectionClosed()
+*   ver 1.2 : 17 Oct 2026
+*   - getMessage reads header lines with Socket::recvLine, which appends
+*     from the socket's receive buffer instead of reading a byte at a time
 *   ver 1.1 : 15 Jan 2018
 *   - changed message body processing to accomodate binary data
 *   ver 1.0 : 06 Jan 2018
@@ -34,11 +88,58 @@
 *
 */
 #include <functional>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <type_traits>
 #include "../Message/Message.h"
 #include "../Sockets/Sockets.h"
+#include "../Compression/Compression.h"
 
 namespace HttpCommunication
 {
+  /////////////////////////////////////////////////////////////////////
+  // HttpBodyReader class
+  // - reads a message body from its socket as the caller asks for it,
+  //   framed by content-length or by chunked transfer-encoding
+  // - works on blocking and non-blocking sockets, waiting at most
+  //   timeout milliseconds for each arrival of data
+
+  class HttpBodyReader
+  {
+  public:
+    using byte = HttpMessageBody::byte;
+    static const size_t error = HttpMessageBody::streamError;
+    static const size_t noTimeout = INT_MAX;
+
+    template <typename T>
+    HttpBodyReader(Sockets::Socket& socket, const HttpMessage<T>& msg, size_t timeout = noTimeout);
+    size_t read(byte* buffer, size_t size);
+    bool skip();
+    bool done() const { return done_; }
+    bool failed() const { return failed_; }
+    size_t bytesRead() const { return bytesRead_; }
+  private:
+    size_t fail() { failed_ = true; return error; }
+    bool more();
+    bool readLine();
+    bool nextChunk();
+
+    Sockets::Socket& socket_;
+    bool chunked_;
+    size_t left_;          // bytes left in the body, or in the current chunk
+    size_t timeout_;
+    bool done_;
+    bool failed_ = false;
+    size_t bytesRead_ = 0;
+    std::string line_;     // chunk size line, or trailer field
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // HttpCommCore class
+
   class HttpCommCore
   {
   public:
@@ -49,58 +150,326 @@ namespace HttpCommunication
     template <typename T>
     HttpMessage<T> getMessage();
     template <typename T>
-    void postMessage(HttpMessage<T> msg);
+    HttpMessage<T> getHeader();
+    template <typename T>
+    bool getBody(HttpMessage<T>& msg, size_t maxSize = SIZE_MAX);
+    template <typename T>
+    void postMessage(const HttpMessage<T>& msg);
+    bool connectionClosed() const { return connectionClosed_; }
+    bool bodyTooLarge() const { return bodyTooLarge_; }
   protected:
+    void sendChunked(const HttpMessageBody& body);
+    template <typename T>
+    static void decode(HttpMessage<T>& msg);
+
     Sockets::Socket* pSocket_;
+    bool connectionClosed_ = false;
+    bool bodyTooLarge_ = false;
+    std::string header_;  // reused by postMessage
+    std::string chunk_;   // reused by postMessage for stream bodies
   };
 
+  //----< reader of msg's body, which follows msg on socket >---------
+
+  template <typename T>
+  HttpBodyReader::HttpBodyReader(Sockets::Socket& socket, const HttpMessage<T>& msg, size_t timeout)
+    : socket_(socket), chunked_(msg.chunked()), left_(chunked_ ? 0 : msg.contentLength()),
+      timeout_(timeout), done_(!chunked_ && left_ == 0) {}
+
+  //----< read up to size bytes of body into buffer >------------------
+  /*
+  *  - returns the number of bytes read, 0 at the end of the body, or
+  *    error if the body is truncated or malformed, or data stops
+  *    arriving for timeout milliseconds
+  *  - bytes already in the socket's RecvBuffer are copied from it, the
+  *    rest are received directly into buffer
+  */
+  inline size_t HttpBodyReader::read(byte* buffer, size_t size)
+  {
+    if (failed_)
+      return error;
+    if (left_ == 0 && !done_ && !nextChunk())
+      return fail();
+    if (done_ || size == 0)
+      return 0;
+
+    size_t want = (std::min)(size, left_);
+    size_t got = 0;
+    Sockets::Socket::byte* pDest = reinterpret_cast<Sockets::Socket::byte*>(buffer);
+    while (got == 0)
+    {
+      if (!socket_.waitForData(timeout_))
+        return fail();
+      got = socket_.recvStream(want, pDest);
+      if (got == 0)
+        return fail();  // peer closed before the body ended
+      if (got == static_cast<size_t>(SOCKET_ERROR))
+      {
+        if (::WSAGetLastError() != WSAEWOULDBLOCK)
+          return fail();
+        got = 0;
+      }
+    }
+    left_ -= got;
+    bytesRead_ += got;
+    if (left_ == 0)
+    {
+      if (!chunked_)
+        done_ = true;
+      else if (!readLine() || !Utilities::StringHelper::trimView(line_).empty())
+        return fail();  // chunk data must end with CRLF
+    }
+    return got;
+  }
+  //----< read and discard the rest of the body >----------------------
+  /*
+  *  - leaves the connection ready for its next message
+  */
+  inline bool HttpBodyReader::skip()
+  {
+    byte buffer[4096];
+    size_t bytes;
+    while ((bytes = read(buffer, sizeof(buffer))) != 0)
+    {
+      if (bytes == error)
+        return false;
+    }
+    return true;
+  }
+  //----< wait for, and buffer, more bytes >---------------------------
+  /*
+  *  - polls the socket, not the RecvBuffer, which holds bytes already
+  *    examined
+  */
+  inline bool HttpBodyReader::more()
+  {
+    while (true)
+    {
+      WSAPOLLFD fd;
+      fd.fd = socket_;
+      fd.events = POLLRDNORM;
+      fd.revents = 0;
+      if (::WSAPoll(&fd, 1, static_cast<INT>((std::min)(timeout_, size_t(INT_MAX)))) <= 0)
+        return false;
+      long bytes = socket_.recvAvailable();
+      if (bytes != 0)
+        return bytes > 0;
+    }
+  }
+  //----< read a line, through its newline, into line_ >---------------
+
+  inline bool HttpBodyReader::readLine()
+  {
+    line_.clear();
+    Sockets::RecvBuffer& rb = socket_.recvBuffer();
+    while (true)
+    {
+      size_t pos = rb.find('\n');
+      if (pos != Sockets::RecvBuffer::npos)
+      {
+        rb.append(pos + 1, line_);
+        return true;
+      }
+      if (rb.full() || !more())
+        return false;  // line too long, or peer closed
+    }
+  }
+  //----< start next chunk, or, after the last, read the trailer >-----
+  /*
+  *  - chunk extensions and trailer fields are read and ignored
+  */
+  inline bool HttpBodyReader::nextChunk()
+  {
+    if (!readLine() || !HttpMessageBody::parseChunkSize(line_, left_))
+      return false;
+    if (left_ > 0)
+      return true;
+    do
+    {
+      if (!readLine())
+        return false;
+    } while (!Utilities::StringHelper::trimView(line_).empty());
+    done_ = true;
+    return true;
+  }
+  //----< send header_, then each chunk of body as it's produced >----
+  /*
+  *  - the header goes out with the first chunk, in one gathering send
+  *  - if the producer fails, or a send does, the connection is shut
+  *    down without the last chunk, so the peer sees a truncated body
+  */
+  inline void HttpCommCore::sendChunked(const HttpMessageBody& body)
+  {
+    bool first = true;
+    while (body.nextChunk(chunk_))
+    {
+      WSABUF bufs[2];
+      size_t numBufs = 0;
+      if (first)
+      {
+        bufs[numBufs].buf = &header_[0];
+        bufs[numBufs++].len = static_cast<ULONG>(header_.size());
+      }
+      bufs[numBufs].buf = &chunk_[0];
+      bufs[numBufs++].len = static_cast<ULONG>(chunk_.size());
+      if (!pSocket_->sendGather(bufs, numBufs))
+      {
+        pSocket_->shutDown();
+        return;
+      }
+      first = false;
+    }
+    if (body.streamFailed())
+      pSocket_->shutDown();
+  }
+
   //----< pull HttpMessage from socket >-------------------------------
 
   template<typename T>
   HttpMessage<T> HttpCommCore::getMessage()
   {
-    // read HTTP message header lines
+    HttpMessage<T> msg = getHeader<T>();
+    if (!connectionClosed_ && !getBody(msg))
+      return HttpMessage<T>();
+    if constexpr (std::is_same<T, HttpReply>::value)
+      decode(msg);
+    return msg;
+  }
+  //----< replace an encoded body with the body it encodes >----------
+  /*
+  *  - a body that can't be decoded, e.g., built without zlib, is left
+  *    as it is, with its Content-Encoding, for the caller
+  */
+  template<typename T>
+  void HttpCommCore::decode(HttpMessage<T>& msg)
+  {
+    const std::string* encoding = msg.attributes().find("Content-Encoding");
+    Compression::Coding coding;
+    if (encoding == nullptr || !Compression::coding(*encoding, coding))
+      return;
+    if (coding != Compression::identity)
+    {
+      std::vector<HttpMessageBody::byte> plain;
+      const HttpMessageBody& body = msg.body();
+      if (!Compression::decompress(body.value().data(), body.size(), coding, plain))
+        return;
+      msg.body().value().swap(plain);
+    }
+    msg.attributes().remove("Content-Encoding");
+    msg.contentLength(msg.body().size());
+  }
+  //----< pull HttpMessage header from socket, leaving its body >------
+
+  template<typename T>
+  HttpMessage<T> HttpCommCore::getHeader()
+  {
+    // parse HTTP message header where it's buffered, reading until
+    // it's complete
 
     Sockets::Socket& socket = *pSocket_;
-    std::string msgString;
-    while (socket.validState())
+    Sockets::RecvBuffer& rb = socket.recvBuffer();
+    HttpParser parser;
+    connectionClosed_ = false;
+    HttpParser::Status status;
+    while ((status = parser.parse(rb.linearize(), rb.size())) == HttpParser::incomplete)
     {
-      std::string temp = socket.recvString('\n');
-      msgString += temp;
-      if (temp.length() < 3 || !socket.validState())  // temp = "\r\n" terminates headers
+      if (rb.full() || !socket.validState() || socket.recvAvailable() <= 0)
         break;
     }
-
-    HttpMessage<T> msg = HttpMessage<T>::fromString(msgString);
-
-    // read message body
-
+    if (status != HttpParser::complete)
+    {
+      connectionClosed_ = true;  // peer closed, or header too large or malformed
+      rb.clear();
+      return HttpMessage<T>();
+    }
+    HttpMessage<T> msg = HttpMessage<T>::fromParser(parser);
+    rb.discard(parser.headerLength());
+    return msg;
+  }
+  //----< read msg's body directly into msg >--------------------------
+  /*
+  *  - a chunked body is reassembled, and msg's content-length set to
+  *    its length
+  *  - false, and connectionClosed(), if the body can't be read
+  *  - false, and bodyTooLarge(), without reading it, if its
+  *    content-length is more than maxSize, or, for a chunked body,
+  *    once more than maxSize bytes have been read
+  *  - a reply whose status allows no body, e.g., 304, has none
+  */
+  template<typename T>
+  bool HttpCommCore::getBody(HttpMessage<T>& msg, size_t maxSize)
+  {
+    Sockets::Socket& socket = *pSocket_;
+    HttpMessageBody& body = msg.body();
+    if constexpr (std::is_same<T, HttpReply>::value)
+    {
+      if (!msg.type().bodyAllowed())
+        return !connectionClosed_;
+    }
+    bodyTooLarge_ = false;
+    if (msg.chunked())
+    {
+      HttpBodyReader reader(socket, msg);
+      std::vector<HttpMessageBody::byte>& bytes = body.value();
+      size_t used = 0, got = 0;
+      do
+      {
+        bytes.resize(used + HttpMessageBody::defaultChunkSize);
+        got = reader.read(bytes.data() + used, HttpMessageBody::defaultChunkSize);
+        used += (got == HttpBodyReader::error) ? 0 : got;
+        bodyTooLarge_ = used > maxSize;
+      } while (got != 0 && got != HttpBodyReader::error && !bodyTooLarge_);
+      if (bodyTooLarge_)
+      {
+        body.clear();
+        return false;
+      }
+      bytes.resize(used);
+      msg.attributes().remove("transfer-encoding");
+      msg.contentLength(used);
+      connectionClosed_ = reader.failed();
+      return !connectionClosed_;
+    }
     size_t bodyLen = msg.contentLength();
-    HttpMessageBody body;
-    std::string temp;
+    bodyTooLarge_ = bodyLen > maxSize;
+    if (bodyTooLarge_)
+      return false;
     if (bodyLen > 0)
     {
       body.size(bodyLen);
-      socket.recv(bodyLen, (Sockets::Socket::byte*)(body.value().data()));
+      connectionClosed_ = !socket.recv(bodyLen, (Sockets::Socket::byte*)(body.value().data()));
     }
-    msg.body() = body;
-    return msg;
+    return !connectionClosed_;
   }
   //----< push HttpMessage into socket >-------------------------------
 
   template<typename T>
-  void HttpCommCore::postMessage(HttpMessage<T> msg)
+  void HttpCommCore::postMessage(const HttpMessage<T>& msg)
   {
-    std::string sendHeader = msg.toHeaderString();
-    pSocket_->send(sendHeader.size(), (Sockets::Socket::byte*)sendHeader.c_str());
+    msg.toHeaderString(header_);
+    const HttpMessageBody& body = msg.body();
+    if (body.isStream())
+    {
+      sendChunked(body);
+      return;
+    }
     size_t bodyLen = msg.contentLength();
-    if (bodyLen > 0)
+    if (body.isFile())
     {
-      HttpMessageBody body = msg.body();
-      pSocket_->send(bodyLen, (Sockets::Socket::byte*)body.value().data());
+      if (bodyLen > body.fileSize())
+        bodyLen = body.fileSize();
+      if (!pSocket_->sendFile(body.fileSpec(), bodyLen, &header_[0], header_.size(), body.fileOffset()))
+        pSocket_->shutDown();  // peer can't tell a short body from a slow one
+      return;
     }
-    //char terminal[1];
-    //terminal[0] = '\n';
-    pSocket_->send(1, (Sockets::Socket::byte*)"\n");
+    if (bodyLen > body.size())
+      bodyLen = body.size();
+
+    WSABUF bufs[2];
+    bufs[0].buf = &header_[0];
+    bufs[0].len = static_cast<ULONG>(header_.size());
+    bufs[1].buf = reinterpret_cast<CHAR*>(const_cast<HttpMessageBody::byte*>(body.value().data()));
+    bufs[1].len = static_cast<ULONG>(bodyLen);
+    pSocket_->sendGather(bufs, (bodyLen > 0) ? 2 : 1);
   }
 }
\ No newline at end of file
@@ -0,0 +1,360 @@
+/////////////////////////////////////////////////////////////////////////
+// HttpMessenger.cpp - one-way HTTP messaging, no replies              //
+// ver 1.3                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+
+#include "HttpMessenger.h"
+#include "../Logger/Logger.h"
+#include "../Utilities/Utilities.h"
+
+using namespace HttpCommunication;
+using namespace Sockets;
+using Show = StaticLogger<1>;
+
+/////////////////////////////////////////////////////////////////////////
+// Sender class members
+
+Sender::Sender(size_t queueCapacity, size_t connectTimeout)
+  : queue_(queueCapacity > 0 ? queueCapacity : 1), connectTimeout_(connectTimeout) {}
+
+//----< sends what was queued, then closes connections >---------------
+
+Sender::~Sender()
+{
+  stop();
+}
+//----< start sender thread >------------------------------------------
+
+void Sender::start()
+{
+  if (thread_.joinable())
+    return;
+  stopping_.store(false);
+  thread_ = std::thread([this]() { send(); });
+}
+//----< send messages already queued, then stop sender thread >-------
+/*
+*  - a null item, enQ'd past the queue bound, follows the last message
+*/
+void Sender::stop()
+{
+  if (!thread_.joinable())
+    return;
+  stopping_.store(true);
+  queue_.enQ(nullptr);
+  thread_.join();
+}
+//----< queue copy of msg, false if queue is full >--------------------
+
+bool Sender::postMessage(const Message& msg)
+{
+  return postMessage(Message(msg));
+}
+//----< queue msg, false, leaving msg as it was, if queue is full >----
+
+bool Sender::postMessage(Message&& msg)
+{
+  std::unique_ptr<Message> pMsg(new Message(std::move(msg)));
+  if (!stopping_.load() && queue_.tryEnQ(std::move(pMsg)))
+    return true;
+  msg = std::move(*pMsg);
+  ++dropped_;
+  return false;
+}
+//----< sender thread: batch messages until the queue runs dry >-------
+/*
+*  - messages that arrive while a batch is being sent are sent together
+*    in the next, so the busier the sender, the larger its sends
+*/
+void Sender::send()
+{
+  while (true)
+  {
+    std::unique_ptr<Message> pMsg = queue_.deQ();
+    if (!pMsg)
+      break;
+    append(*pMsg);
+    if (queue_.size() == 0)
+      flushAll();
+  }
+  flushAll();
+  for (auto& item : conns_)
+  {
+    Connection& conn = *item.second;
+    if (conn.socket.validState())
+    {
+      conn.socket.shutDown();
+      conn.socket.close();
+    }
+  }
+  conns_.clear();
+}
+//----< serialize msg into the batch for its EndPoint >----------------
+/*
+*  - a stream body's chunks are flushed as the batch reaches flushSize,
+*    so it isn't held in memory whole.  If its producer fails after
+*    part of it has been sent, the connection is closed, the receiver
+*    can't tell where the message ends.
+*/
+void Sender::append(Message& msg)
+{
+  EndPoint ep = msg.to();
+  ConnPtr& pConn = conns_[ep];
+  if (!pConn)
+    pConn.reset(new Connection);
+  Connection& conn = *pConn;
+  if (!conn.socket.validState() && !connect(ep, conn))
+  {
+    ++dropped_;
+    return;
+  }
+  if (!msg.body().loadFile())
+  {
+    ++dropped_;
+    return;
+  }
+  const HttpMessageBody& body = msg.body();  // const access doesn't copy a shared body
+  if (!body.isStream() && msg.contentLength() != body.size())
+    msg.contentLength(body.size());          // receiver frames messages by content-length
+  size_t start = conn.out.size();
+  msg.toHeaderString(header_);
+  conn.out += header_;
+  if (body.isStream())
+  {
+    bool partSent = false;
+    while (body.nextChunk(chunk_))
+    {
+      conn.out += chunk_;
+      if (conn.out.size() < flushSize)
+        continue;
+      flush(conn);
+      if (!conn.socket.validState())
+      {
+        ++dropped_;   // flush dropped the batch before msg, and the connection
+        return;
+      }
+      partSent = true;
+    }
+    if (body.streamFailed())
+    {
+      if (partSent)
+      {
+        Show::warning("\n  -- Sender stream body failed after it was partly sent, closing connection");
+        conn.socket.shutDown();
+        conn.socket.close();
+        conn.out.clear();
+      }
+      else
+      {
+        conn.out.resize(start);
+      }
+      ++dropped_;
+      return;
+    }
+  }
+  else
+  {
+    conn.out.append(reinterpret_cast<const char*>(body.value().data()), body.size());
+  }
+  ++conn.batched;
+  if (conn.out.size() >= flushSize)
+    flush(conn);
+}
+//----< connect to ep, unless a recent attempt failed >----------------
+
+bool Sender::connect(const EndPoint& ep, Connection& conn)
+{
+  Clock::time_point now = Clock::now();
+  if (ep.port == 0 || now < conn.retryAt)
+    return false;
+  if (!conn.socket.connect(ep.address, ep.port, connectTimeout_))
+  {
+    Show::warning("\n  -- Sender can't connect to {}, dropping its messages for {} ms", ep.toString(), retryDelay);
+    conn.retryAt = now + std::chrono::milliseconds(retryDelay);
+    return false;
+  }
+  conn.socket.noDelay(true);  // batches are already as large as they'll get
+  ++connectCount_;
+  return true;
+}
+//----< send batch, dropping it and the connection if send fails >----
+
+void Sender::flush(Connection& conn)
+{
+  if (conn.out.empty())
+    return;
+  if (conn.socket.send(conn.out.size(), &conn.out[0]))
+  {
+    sent_ += conn.batched;
+  }
+  else
+  {
+    Show::warning("\n  -- Sender send failed, {} messages dropped", conn.batched);
+    dropped_ += conn.batched;
+    conn.socket.close();
+  }
+  conn.out.clear();
+  conn.batched = 0;
+}
+//----< send batches for every EndPoint >------------------------------
+
+void Sender::flushAll()
+{
+  for (auto& item : conns_)
+    flush(*item.second);
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Receiver class members
+
+Receiver::Receiver(size_t port, Socket::IpVer ipv, size_t queueCapacity)
+  : queue_(queueCapacity > 0 ? queueCapacity : 1), listener_(port, ipv) {}
+
+//----< stops dispatch thread >----------------------------------------
+/*
+*  - connection threads hold a pointer to the Receiver, so it must
+*    outlive its connections, as HttpServer must.  Once stopping_ is
+*    set receive drops their messages, and the destructor waits for
+*    any still in receive to leave.
+*  - the dispatch thread dispatches every message queued before the
+*    null sentinel, enQ'd past the queue bound, then stops
+*/
+Receiver::~Receiver()
+{
+  stopping_.store(true);
+  listener_.stop();
+  while (receiving_.load() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (dispatchThread_.joinable())
+  {
+    queue_.enQ(nullptr);
+    dispatchThread_.join();
+  }
+}
+//----< start listening, caller deQs messages with getMessage >--------
+
+bool Receiver::start()
+{
+  return listener_.start(handler_);
+}
+//----< start listening, dispatch thread calls proc with each message >
+
+bool Receiver::start(Dispatcher proc)
+{
+  if (!start())
+    return false;
+  dispatchThread_ = std::thread([this, proc]()
+  {
+    while (true)
+    {
+      std::unique_ptr<Message> pMsg = queue_.deQ();
+      if (!pMsg)
+        break;
+      proc(*pMsg);
+    }
+  });
+  return true;
+}
+//----< next message, waits until one arrives >------------------------
+
+Receiver::Message Receiver::getMessage()
+{
+  std::unique_ptr<Message> pMsg = queue_.deQ();
+  return pMsg ? std::move(*pMsg) : Message();
+}
+//----< queue message from a connection, waiting while queue is full >-
+/*
+*  - while this connection waits it isn't read, so TCP flow control
+*    slows its sender, whose own queue then sheds the excess
+*  - false, dropping msg, once the Receiver is stopping
+*/
+bool Receiver::receive(Message&& msg)
+{
+  ++receiving_;
+  std::unique_ptr<Message> pMsg(new Message(std::move(msg)));
+  bool queued = false;
+  while (!stopping_.load() && !(queued = queue_.tryEnQ(std::move(pMsg))))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (queued)
+    ++received_;
+  --receiving_;
+  return queued;
+}
+//----< read messages until the sender closes the connection >---------
+
+void Receiver::ConnectionHandler::operator()(Socket&& socket)
+{
+  HttpCommCore comm(&socket);
+  while (true)
+  {
+    Message msg = comm.getMessage<HttpRequest>();
+    if (comm.connectionClosed() || !pReceiver_->receive(std::move(msg)))
+      break;
+  }
+  socket.shutDown();
+  socket.close();
+}
+
+#ifdef TEST_HTTPMESSENGER
+
+#include <iostream>
+
+//----< milliseconds since start >-------------------------------------
+
+size_t milliSecsSince(std::chrono::steady_clock::time_point start)
+{
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+int main()
+{
+  Show::attach(&std::cout);
+  Show::start();
+  Utilities::StringHelper::Title("Demonstrating one-way messaging");
+
+  const size_t count = 5000;
+  Receiver receiver(8090);
+  if (!receiver.start())
+  {
+    std::cout << "\n  couldn't start receiver\n\n";
+    return 1;
+  }
+  Sender sender;
+  sender.start();
+
+  std::cout << "\n  posting " << count << " messages to localhost:8090";
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i)
+  {
+    HttpMessage<HttpRequest> msg = makeHttpRequestMessage(HttpRequest::POST, "/telemetry");
+    msg.to(EndPoint("localhost", 8090));
+    msg.attribute("sample", Utilities::Converter<size_t>::toString(i));
+    msg.body() = std::string("cpu=42;mem=1024");
+    sender.postMessage(std::move(msg));
+  }
+  std::cout << "\n  posting took " << milliSecsSince(start) << " ms";
+
+  size_t outOfOrder = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    HttpMessage<HttpRequest> msg = receiver.getMessage();
+    if (Utilities::Converter<size_t>::toValue(msg.attributes()["sample"]) != i)
+      ++outOfOrder;
+  }
+  std::cout << "\n  received " << count << " messages, " << outOfOrder << " out of order, after "
+    << milliSecsSince(start) << " ms";
+
+  std::cout << "\n\n  posting a message to localhost:8091, where nobody listens";
+  HttpMessage<HttpRequest> lost = makeHttpRequestMessage(HttpRequest::POST, "/telemetry");
+  lost.to(EndPoint("localhost", 8091));
+  sender.postMessage(lost);
+  sender.stop();
+  std::cout << "\n  sent " << sender.sent() << ", dropped " << sender.dropped()
+    << ", over " << sender.connectCount() << " connection(s)";
+  std::cout << "\n\n";
+  Show::stop();
+}
+#endif
@@ -0,0 +1,177 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// HttpMessenger.h - one-way HTTP messaging, no replies                //
+// ver 1.3                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package provides the asynchronous, one-way, communication that
+*  Message.h promises, for traffic that doesn't need an answer, e.g.,
+*  telemetry.  Messages are streamed over persistent connections and
+*  no reply is sent or awaited, so a message costs a queue operation
+*  and part of a send instead of a round trip.
+*  Sender:
+*  - postMessage(msg) queues msg and returns at once.  The message goes
+*    to msg.to(), the EndPoint in its "to" attribute.
+*  - A sender thread keeps one connection open to each EndPoint it has
+*    seen.  Messages queued together for one EndPoint are serialized
+*    into one buffer and sent with one send.  A stream body is sent
+*    chunked, the batch flushed each time it reaches flushSize, so a
+*    large body is never held whole.
+*  - Delivery is best effort.  postMessage refuses messages when the
+*    queue is full, and a message is dropped if its EndPoint can't be
+*    reached or its connection fails.  After a failed connect, messages
+*    to that EndPoint are dropped for retryDelay milliseconds instead
+*    of each waiting for another connect.  dropped() counts them.
+*  - stop() sends everything queued before it, then closes connections.
+*  Receiver:
+*  - Listens on a port and reads messages from each connection, on the
+*    connection's own thread, into one receive queue.  Nothing is sent
+*    back.
+*  - getMessage() deQs the next message, blocking until one arrives,
+*    or start(proc) runs a dispatch thread that calls proc with each.
+*  - While the receive queue is full, connections aren't read, so TCP
+*    flow control slows their senders, whose queues then fill and
+*    refuse messages.
+*  - The destructor dispatches messages already queued, then stops.
+*    Messages arriving after it starts are dropped, and it waits for
+*    connections waiting on a full queue to give up.
+*
+*  Required Files:
+*  ---------------
+*  HttpMessenger.h, HttpMessenger.cpp
+*  HttpCommCore.h, Message.h, Message.cpp, HttpParser.h, HttpParser.cpp
+*  Compression.h, Compression.cpp
+*  Sockets.h, Sockets.cpp
+*  Logger.h, Logger.cpp, MpscQueue.h, Cpp11-BlockingQueue.h
+*  Utilities.h, Utilities.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.3 : 17 Oct 2026
+*  - a stream body is flushed as it's serialized, flushSize at a time,
+*    instead of being built whole in the batch
+*  ver 1.2 : 17 Oct 2026
+*  - Receiver's dispatch thread stops at a null sentinel, so messages
+*    queued before it are dispatched, and receive gives up once the
+*    Receiver is stopping
+*  ver 1.1 : 17 Oct 2026
+*  - sends stream bodies with chunked transfer-encoding
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+#include "../Message/Message.h"
+#include "../HttpCommCore/HttpCommCore.h"
+#include "../Sockets/Sockets.h"
+#include "../Logger/Cpp11-BlockingQueue.h"
+#include <string>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+namespace HttpCommunication
+{
+  /////////////////////////////////////////////////////////////////////
+  // Sender class
+  // - streams messages to the EndPoints they're addressed to
+
+  class Sender
+  {
+  public:
+    using Message = HttpMessage<HttpRequest>;
+
+    static const size_t defaultConnectTimeout = 2000;
+    static const size_t retryDelay = 1000;
+    static const size_t flushSize = 64 * 1024;
+
+    Sender(size_t queueCapacity = 8192, size_t connectTimeout = defaultConnectTimeout);
+    Sender(const Sender&) = delete;
+    Sender& operator=(const Sender&) = delete;
+    ~Sender();
+    void start();
+    void stop();
+    bool postMessage(const Message& msg);
+    bool postMessage(Message&& msg);
+    size_t sent() const { return sent_.load(); }
+    size_t dropped() const { return dropped_.load(); }
+    size_t connectCount() const { return connectCount_.load(); }
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection
+    {
+      Sockets::SocketConnecter socket;
+      std::string out;           // serialized messages waiting to be sent
+      size_t batched = 0;        // number of messages in out
+      Clock::time_point retryAt; // dropping messages until then
+    };
+    using ConnPtr = std::unique_ptr<Connection>;
+
+    void send();
+    void append(Message& msg);
+    bool connect(const EndPoint& ep, Connection& conn);
+    void flush(Connection& conn);
+    void flushAll();
+
+    BlockingQueue<std::unique_ptr<Message>> queue_;   // null stops sender thread
+    std::map<EndPoint, ConnPtr> conns_;   // used only by sender thread
+    std::string header_;                  // reused by append
+    std::string chunk_;                   // reused by append for stream bodies
+    size_t connectTimeout_;
+    Sockets::SocketSystem ss_;
+    std::thread thread_;
+    std::atomic<bool> stopping_ = false;
+    std::atomic<size_t> sent_ = 0;
+    std::atomic<size_t> dropped_ = 0;
+    std::atomic<size_t> connectCount_ = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // Receiver class
+  // - queues messages arriving on any connection to its port
+
+  class Receiver
+  {
+  public:
+    using Message = HttpMessage<HttpRequest>;
+    using Dispatcher = std::function<void(Message&)>;
+
+    Receiver(size_t port, Sockets::Socket::IpVer ipv = Sockets::Socket::IP4, size_t queueCapacity = 8192);
+    Receiver(const Receiver&) = delete;
+    Receiver& operator=(const Receiver&) = delete;
+    ~Receiver();
+    bool start();
+    bool start(Dispatcher proc);
+    Message getMessage();
+    size_t received() const { return received_.load(); }
+    size_t queued() { return queue_.size(); }
+  private:
+    // client handler, a copy runs on each connection's thread
+
+    class ConnectionHandler
+    {
+    public:
+      ConnectionHandler(Receiver* pReceiver) : pReceiver_(pReceiver) {}
+      void operator()(Sockets::Socket&& socket);
+    private:
+      Receiver* pReceiver_;
+    };
+
+    bool receive(Message&& msg);
+
+    BlockingQueue<std::unique_ptr<Message>> queue_;   // null stops dispatch thread
+    Sockets::SocketSystem ss_;
+    Sockets::SocketListener listener_;
+    ConnectionHandler handler_{ this };
+    std::thread dispatchThread_;
+    std::atomic<bool> stopping_ = false;
+    std::atomic<size_t> receiving_ = 0;  // connections in receive
+    std::atomic<size_t> received_ = 0;
+  };
+}
@@ -0,0 +1,263 @@
+/////////////////////////////////////////////////////////////////////////
+// HttpParser.cpp - incremental, non-allocating HTTP header parser     //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+
+#include "HttpParser.h"
+#include <cstring>
+
+using namespace HttpCommunication;
+
+namespace
+{
+  bool isSpace(char ch) { return ch == ' ' || ch == '\t'; }
+}
+//----< prepare to parse another message >-----------------------------
+
+void HttpParser::reset()
+{
+  data_ = nullptr;
+  size_ = 0;
+  pos_ = 0;
+  scanned_ = 0;
+  status_ = incomplete;
+  started_ = false;
+  startLine_ = Span();
+  for (auto& word : words_)
+    word = Span();
+  count_ = 0;
+}
+//----< parse complete lines of data not parsed by earlier calls >-----
+/*
+*  - returns complete once the empty line ending the header is found,
+*    headerLength() is then the offset of the first body byte
+*/
+HttpParser::Status HttpParser::parse(const char* data, size_t size)
+{
+  data_ = data;
+  size_ = size;
+  while (status_ == incomplete)
+  {
+    size_t from = (scanned_ > pos_) ? scanned_ : pos_;
+    const void* pFound = (from < size) ? ::memchr(data + from, '\n', size - from) : nullptr;
+    if (pFound == nullptr)
+    {
+      scanned_ = size;
+      break;
+    }
+    size_t eol = static_cast<const char*>(pFound) - data;
+    size_t begin = pos_;
+    size_t end = (eol > begin && data[eol - 1] == '\r') ? eol - 1 : eol;
+    pos_ = eol + 1;
+    if (begin == end)
+    {
+      if (started_)
+        status_ = complete;   // empty line ends header
+      continue;               // blank line before start line
+    }
+    status_ = parseLine(begin, end);
+  }
+  return status_;
+}
+//----< end of data ends header, for headers without a blank line >----
+
+HttpParser::Status HttpParser::finish()
+{
+  if (status_ != incomplete)
+    return status_;
+  if (pos_ < size_)
+  {
+    size_t begin = pos_;
+    size_t end = (data_[size_ - 1] == '\r') ? size_ - 1 : size_;
+    pos_ = size_;
+    if (begin < end && parseLine(begin, end) == error)
+      return status_ = error;
+  }
+  status_ = started_ ? complete : error;
+  return status_;
+}
+//----< start line, then fields >--------------------------------------
+
+HttpParser::Status HttpParser::parseLine(size_t begin, size_t end)
+{
+  if (!started_)
+    return parseStartLine(begin, end);
+  return parseField(begin, end);
+}
+//----< split start line into two words and the rest of the line >----
+/*
+*  - "GET /index.htm HTTP/1.1" or "HTTP/1.1 200 OK"
+*  - the third word of a reply may contain spaces, e.g., "not found"
+*/
+HttpParser::Status HttpParser::parseStartLine(size_t begin, size_t end)
+{
+  started_ = true;
+  startLine_.offset = begin;
+  startLine_.length = end - begin;
+  size_t pos = begin;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    while (pos < end && isSpace(data_[pos]))
+      ++pos;
+    size_t wordEnd = pos;
+    if (i < 2)
+    {
+      while (wordEnd < end && !isSpace(data_[wordEnd]))
+        ++wordEnd;
+    }
+    else
+    {
+      wordEnd = end;
+      while (wordEnd > pos && isSpace(data_[wordEnd - 1]))
+        --wordEnd;
+    }
+    words_[i].offset = pos;
+    words_[i].length = wordEnd - pos;
+    pos = wordEnd;
+  }
+  return (words_[1].length > 0) ? incomplete : error;
+}
+//----< record name and trimmed value of "name: value" >---------------
+
+HttpParser::Status HttpParser::parseField(size_t begin, size_t end)
+{
+  if (count_ == maxHeaders)
+    return error;
+  const void* pColon = ::memchr(data_ + begin, ':', end - begin);
+  if (pColon == nullptr)
+    return error;
+  size_t colon = static_cast<const char*>(pColon) - data_;
+  size_t nameBegin = begin, nameEnd = colon;
+  while (nameBegin < nameEnd && isSpace(data_[nameBegin]))
+    ++nameBegin;
+  while (nameEnd > nameBegin && isSpace(data_[nameEnd - 1]))
+    --nameEnd;
+  if (nameBegin == nameEnd)
+    return error;
+  size_t valueBegin = colon + 1, valueEnd = end;
+  while (valueBegin < valueEnd && isSpace(data_[valueBegin]))
+    ++valueBegin;
+  while (valueEnd > valueBegin && isSpace(data_[valueEnd - 1]))
+    --valueEnd;
+  names_[count_].offset = nameBegin;
+  names_[count_].length = nameEnd - nameBegin;
+  values_[count_].offset = valueBegin;
+  values_[count_].length = valueEnd - valueBegin;
+  ++count_;
+  return incomplete;
+}
+//----< i-th word of start line, the third is the rest of the line >--
+
+std::string_view HttpParser::word(size_t i) const
+{
+  if (i > 2)
+    return std::string_view();
+  return view(words_[i]);
+}
+//----< value of first field with name, ignoring case >----------------
+
+bool HttpParser::find(std::string_view name, std::string_view& value) const
+{
+  for (size_t i = 0; i < count_; ++i)
+  {
+    if (equalIgnoreCase(this->name(i), name))
+    {
+      value = this->value(i);
+      return true;
+    }
+  }
+  return false;
+}
+//----< compare ASCII strings without regard to case >-----------------
+
+bool HttpParser::equalIgnoreCase(std::string_view lhs, std::string_view rhs)
+{
+  if (lhs.size() != rhs.size())
+    return false;
+  for (size_t i = 0; i < lhs.size(); ++i)
+  {
+    char l = lhs[i], r = rhs[i];
+    if (l != r)
+    {
+      if ('A' <= l && l <= 'Z') l += 'a' - 'A';
+      if ('A' <= r && r <= 'Z') r += 'a' - 'A';
+      if (l != r)
+        return false;
+    }
+  }
+  return true;
+}
+
+#ifdef TEST_HTTPPARSER
+
+#include <iostream>
+#include <string>
+
+//----< show parse results >-------------------------------------------
+
+void show(const HttpParser& parser)
+{
+  std::cout << "\n    start line: \"" << parser.startLine() << "\"";
+  for (size_t i = 0; i < 3; ++i)
+    std::cout << "\n    word(" << i << "):    \"" << parser.word(i) << "\"";
+  for (size_t i = 0; i < parser.headerCount(); ++i)
+    std::cout << "\n    field:      \"" << parser.name(i) << "\" = \"" << parser.value(i) << "\"";
+  std::cout << "\n    header length = " << parser.headerLength();
+}
+
+int main()
+{
+  std::cout << "\n  Demonstrating HttpParser";
+  std::cout << "\n ==========================";
+
+  std::string request =
+    "\r\nGET /index.htm HTTP/1.1\r\nHost: localhost:8080\r\nContent-Length:  5 \r\n"
+    "Connection:keep-alive\n\r\nhello";
+
+  std::cout << "\n\n  request in one buffer:";
+  HttpParser parser;
+  HttpParser::Status status = parser.parse(request.data(), request.size());
+  std::cout << "\n    status = " << (status == HttpParser::complete ? "complete" : "not complete");
+  show(parser);
+  std::string_view value;
+  if (parser.find("content-length", value))
+    std::cout << "\n    find(\"content-length\") = \"" << value << "\"";
+  std::cout << "\n    body: \"" << request.substr(parser.headerLength()) << "\"";
+
+  std::cout << "\n\n  same request split at every byte:";
+  size_t failures = 0;
+  for (size_t split = 0; split < request.size(); ++split)
+  {
+    std::string received = request.substr(0, split);
+    parser.reset();
+    bool failed = parser.parse(received.data(), received.size()) == HttpParser::error;
+    received = request;   // new buffer, same contents
+    if (failed || parser.parse(received.data(), received.size()) != HttpParser::complete ||
+      parser.headerCount() != 3 || parser.value(1) != "5" || parser.headerLength() != request.size() - 5)
+      ++failures;
+  }
+  std::cout << "\n    " << request.size() << " splits, " << failures << " failures";
+
+  std::cout << "\n\n  reply, ended by finish():";
+  std::string reply = "HTTP/1.1 404 not found\ncontent-length:0";
+  parser.reset();
+  status = parser.parse(reply.data(), reply.size());
+  std::cout << "\n    parse: " << (status == HttpParser::incomplete ? "incomplete" : "unexpected");
+  status = parser.finish();
+  std::cout << "\n    finish: " << (status == HttpParser::complete ? "complete" : "unexpected");
+  show(parser);
+
+  std::cout << "\n\n  malformed headers:";
+  for (std::string bad : { "GET\r\n\r\n", "GET / HTTP/1.1\r\nno colon here\r\n\r\n", "GET / HTTP/1.1\r\n: no name\r\n\r\n" })
+  {
+    parser.reset();
+    status = parser.parse(bad.data(), bad.size());
+    std::cout << "\n    " << (status == HttpParser::error ? "error     " : "unexpected") << " for \""
+      << bad.substr(0, bad.find('\r')) << "...\"";
+  }
+  std::cout << "\n\n";
+}
+
+#endif
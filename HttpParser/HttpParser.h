@@ -0,0 +1,84 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// HttpParser.h - incremental, non-allocating HTTP header parser       //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package provides an HttpParser class that finds the start line
+*  and header fields of an HTTP message in one pass over a contiguous
+*  buffer, e.g., a linearized Socket RecvBuffer.
+*  - Results are std::string_view slices of the caller's buffer, so the
+*    parser never allocates.  Field positions are held in fixed size
+*    arrays, limiting a message to maxHeaders fields.
+*  - parse(data, size) may be called again as more of the message
+*    arrives, with data holding everything received so far.  Parsing
+*    resumes with the first incomplete line.  The buffer may move
+*    between calls, only its contents must be unchanged.
+*  - Lines end with "\n" or "\r\n".  Blank lines before the start line
+*    are skipped and an empty line ends the header.
+*  - Field values are trimmed of surrounding spaces and tabs, names are
+*    matched without regard to case.
+*  - Views are valid until the buffer is changed or the parser is reset.
+*
+*  Required Files:
+*  ---------------
+*  HttpParser.h, HttpParser.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+
+#include <string_view>
+#include <cstddef>
+
+namespace HttpCommunication
+{
+  class HttpParser
+  {
+  public:
+    enum Status { incomplete, complete, error };
+    static const size_t maxHeaders = 64;
+
+    HttpParser() = default;
+    void reset();
+    Status parse(const char* data, size_t size);
+    Status finish();
+    Status status() const { return status_; }
+    size_t headerLength() const { return pos_; }
+    std::string_view startLine() const { return view(startLine_); }
+    std::string_view word(size_t i) const;
+    size_t headerCount() const { return count_; }
+    std::string_view name(size_t i) const { return view(names_[i]); }
+    std::string_view value(size_t i) const { return view(values_[i]); }
+    bool find(std::string_view name, std::string_view& value) const;
+    static bool equalIgnoreCase(std::string_view lhs, std::string_view rhs);
+  private:
+    struct Span
+    {
+      size_t offset = 0;
+      size_t length = 0;
+    };
+    std::string_view view(Span span) const { return std::string_view(data_ + span.offset, span.length); }
+    Status parseLine(size_t begin, size_t end);
+    Status parseStartLine(size_t begin, size_t end);
+    Status parseField(size_t begin, size_t end);
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;       // start of first line not yet parsed
+    size_t scanned_ = 0;   // bytes already searched for a newline
+    Status status_ = incomplete;
+    bool started_ = false;
+    Span startLine_;
+    Span words_[3];
+    Span names_[maxHeaders];
+    Span values_[maxHeaders];
+    size_t count_ = 0;
+  };
+}
@@ -0,0 +1,748 @@
+/////////////////////////////////////////////////////////////////////////
+// EventLoop.cpp - multiplexes many HTTP connections on one thread     //
+// ver 2.6                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+
+#include "EventLoop.h"
+#include "HttpServer.h"
+#include "../Logger/Logger.h"
+#include "../Utilities/Utilities.h"
+
+using namespace HttpCommunication;
+using namespace Sockets;
+using Show = StaticLogger<1>;
+
+thread_local EventLoop* EventLoop::current_ = nullptr;
+
+//----< constructor binds loop to dispatcher of its server >-----------
+
+EventLoop::EventLoop(HttpServerCore* pServer) : pServer_(pServer) {}
+
+//----< stops thread and closes connections >--------------------------
+
+EventLoop::~EventLoop()
+{
+  stop();
+}
+//----< creates wake socket and starts loop thread >-------------------
+
+bool EventLoop::start()
+{
+  wakeSocket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (wakeSocket_ == INVALID_SOCKET)
+  {
+    Show::error("\n  -- EventLoop wake socket failed with error: {}", WSAGetLastError());
+    return false;
+  }
+  ZeroMemory(&wakeAddr_, sizeof(wakeAddr_));
+  wakeAddr_.sin_family = AF_INET;
+  wakeAddr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  wakeAddr_.sin_port = 0;
+  int addrLen = sizeof(wakeAddr_);
+  if (::bind(wakeSocket_, (sockaddr*)&wakeAddr_, addrLen) == SOCKET_ERROR ||
+    ::getsockname(wakeSocket_, (sockaddr*)&wakeAddr_, &addrLen) == SOCKET_ERROR)
+  {
+    Show::error("\n  -- EventLoop wake socket bind failed with error: {}", WSAGetLastError());
+    ::closesocket(wakeSocket_);
+    wakeSocket_ = INVALID_SOCKET;
+    return false;
+  }
+  u_long mode = 1;
+  ::ioctlsocket(wakeSocket_, FIONBIO, &mode);
+
+  WSAPOLLFD wakeFd;
+  wakeFd.fd = wakeSocket_;
+  wakeFd.events = POLLRDNORM;
+  wakeFd.revents = 0;
+  fds_.push_back(wakeFd);
+  conns_.push_back(nullptr);
+
+  blocking_.reset(new ThreadPool<std::function<void()>>(blockingThreads, blockingQueueSize,
+    [](std::function<void()>& work) { work(); }
+  ));
+  blocking_->start();
+  thread_ = std::thread([this]() { run(); });
+  return true;
+}
+//----< requests loop to stop and waits for it >-----------------------
+
+void EventLoop::stop()
+{
+  if (!thread_.joinable())
+    return;
+  stop_.store(true);
+  wake();
+  thread_.join();
+  ::closesocket(wakeSocket_);
+  wakeSocket_ = INVALID_SOCKET;
+}
+//----< queue connection for loop thread to adopt >--------------------
+
+void EventLoop::add(Socket&& socket)
+{
+  {
+    std::lock_guard<std::mutex> lock(pendingMtx_);
+    pending_.push_back(std::move(socket));
+  }
+  wake();
+}
+//----< interrupt WSAPoll by sending a byte to the wake socket >-------
+
+void EventLoop::wake()
+{
+  char signal = 'w';
+  ::sendto(wakeSocket_, &signal, 1, 0, (sockaddr*)&wakeAddr_, sizeof(wakeAddr_));
+}
+//----< discard wake signals >-----------------------------------------
+
+void EventLoop::drainWake()
+{
+  char buffer[64];
+  while (::recv(wakeSocket_, buffer, sizeof(buffer), 0) > 0)
+    ;
+}
+//----< move queued connections into the poll set >--------------------
+
+void EventLoop::adoptPending()
+{
+  std::vector<Socket> adopted;
+  {
+    std::lock_guard<std::mutex> lock(pendingMtx_);
+    adopted.swap(pending_);
+  }
+  for (auto& socket : adopted)
+  {
+    socket.nonBlocking(true);
+    socket.noDelay(true);
+    ConnPtr pConn(new Connection(std::move(socket)));
+    WSAPOLLFD fd;
+    fd.fd = (::SOCKET)pConn->socket;
+    fd.events = POLLRDNORM;
+    fd.revents = 0;
+    fds_.push_back(fd);
+    conns_.push_back(std::move(pConn));
+  }
+  connections_.store(conns_.size() - 1);
+}
+//----< close connection i, moving last connection into its slot >-----
+
+void EventLoop::remove(size_t i)
+{
+  conns_[i] = std::move(conns_.back());
+  conns_.pop_back();
+  fds_[i] = fds_.back();
+  fds_.pop_back();
+  connections_.store(conns_.size() - 1);
+}
+//----< close connections marked closed or idle past idleTimeout >-----
+/*
+*  - a connection whose handler is suspended isn't idle
+*/
+void EventLoop::closeIdle()
+{
+  Clock::time_point now = Clock::now();
+  std::chrono::milliseconds idleTimeout(pServer_->idleTimeout());
+  for (size_t i = conns_.size() - 1; i > 0; --i)
+  {
+    Connection& conn = *conns_[i];
+    if (conn.closed || (!conn.awaiting && now - conn.lastActive > idleTimeout))
+      remove(i);
+  }
+}
+//----< wait for sockets no longer than idleTimeout or next timer >----
+
+INT EventLoop::pollTimeout() const
+{
+  INT timeout = (fds_.size() > 1) ? static_cast<INT>(pServer_->idleTimeout()) : -1;
+  if (!timers_.empty())
+  {
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+      timers_.begin()->first - Clock::now()).count() + 1;
+    INT timerTimeout = static_cast<INT>((std::max)(wait, decltype(wait)(0)));
+    if (timeout < 0 || timerTimeout < timeout)
+      timeout = timerTimeout;
+  }
+  return timeout;
+}
+//----< loop thread processing >---------------------------------------
+/*
+*  - Connections are visited in reverse order so remove(i), which
+*    moves a connection already visited into slot i, is safe.
+*/
+void EventLoop::run()
+{
+  current_ = this;
+  while (!stop_.load())
+  {
+    adoptPending();
+    for (size_t i = 1; i < fds_.size(); ++i)
+    {
+      Connection& conn = *conns_[i];
+      if (conn.awaiting)
+        fds_[i].events = 0;   // nothing to do until its handler resumes
+      else
+        fds_[i].events = conn.sending() ? POLLWRNORM : POLLRDNORM;
+    }
+    int ready = ::WSAPoll(fds_.data(), (ULONG)fds_.size(), pollTimeout());
+    if (ready == SOCKET_ERROR)
+    {
+      Show::error("\n  -- EventLoop WSAPoll failed with error: {}", WSAGetLastError());
+      break;
+    }
+    if (fds_[0].revents != 0)
+      drainWake();
+
+    for (size_t i = fds_.size() - 1; i > 0; --i)
+    {
+      short revents = fds_[i].revents;
+      Connection& conn = *conns_[i];
+      if (revents == 0 || conn.awaiting)
+        continue;
+      bool keep;
+      if (revents & POLLNVAL)
+        keep = false;
+      else if (conn.sending())
+        keep = onWritable(conn);
+      else
+        keep = onReadable(conn);
+      if (!keep)
+        remove(i);
+      else
+        conn.lastActive = Clock::now();
+    }
+    resumeReady();
+    closeIdle();
+  }
+  blocking_->stop();     // no more resumptions of the frames destroyed below
+  ready_.clear();
+  readsDone_.clear();
+  timers_.clear();
+  conns_.resize(1);
+  fds_.resize(1);
+  connections_.store(0);
+  current_ = nullptr;
+}
+//----< pull available bytes and process any complete requests >-------
+
+bool EventLoop::onReadable(Connection& conn)
+{
+  if (conn.socket.recvAvailable() < 0)
+    return false;
+  return processRequests(conn);
+}
+//----< continue sending pending reply >-------------------------------
+
+bool EventLoop::onWritable(Connection& conn)
+{
+  if (!flush(conn))
+    return false;
+  if (conn.sending())
+    return true;
+  if (conn.closeAfterWrite)
+    return false;
+  return processRequests(conn);
+}
+//----< extract, dispatch, and reply to buffered requests >------------
+/*
+*  - returns false when the connection should be closed
+*  - only one reply is in flight at a time, later requests stay in
+*    the RecvBuffer until it has been sent
+*  - the header is parsed in the RecvBuffer, resuming where the last
+*    read left off, and discarded once the request has been built
+*/
+bool EventLoop::processRequests(Connection& conn)
+{
+  RecvBuffer& rb = conn.socket.recvBuffer();
+  while (!conn.sending() && !conn.awaiting)
+  {
+    if (!conn.readingBody)
+    {
+      HttpParser& parser = conn.parser;
+      HttpParser::Status status = parser.parse(rb.linearize(), rb.size());
+      if (status == HttpParser::error)
+        return false;
+      if (status == HttpParser::incomplete)
+        return !rb.full();  // a header that fills the buffer is too large
+
+      conn.request = HttpMessage<HttpRequest>::fromParser(parser);
+      rb.discard(parser.headerLength());
+      parser.reset();
+      conn.streamProc = pServer_->findStreamProc(conn.request);
+      conn.chunked = (conn.streamProc == nullptr) && conn.request.chunked();
+      conn.chunkPart = Connection::sizeLine;
+      if (conn.streamProc == nullptr && !conn.chunked)
+      {
+        if (conn.request.contentLength() > pServer_->maxBodySize())
+        {
+          refuse(conn, 413);
+          return flush(conn) && conn.sending();  // closed once it's sent
+        }
+        conn.request.body().size(conn.request.contentLength());
+      }
+      conn.bodyRead = 0;
+      conn.readingBody = true;
+    }
+    HttpMessageBody& body = conn.request.body();
+    if (conn.chunked)
+    {
+      HttpParser::Status status = readChunked(conn);
+      if (conn.tooLarge)
+      {
+        refuse(conn, 413);
+        return flush(conn) && conn.sending();  // closed once it's sent
+      }
+      if (status == HttpParser::error)
+        return false;
+      if (status == HttpParser::incomplete)
+        return true;  // wait for rest of body
+    }
+    else if (conn.bodyRead < body.size())
+    {
+      Socket::byte* pDest = (Socket::byte*)body.value().data() + conn.bodyRead;
+      conn.bodyRead += rb.read(body.size() - conn.bodyRead, pDest);
+      if (conn.bodyRead < body.size())
+        return true;  // wait for rest of body
+    }
+    conn.readingBody = false;
+    dispatch(conn);
+    if (conn.awaiting)
+      return true;  // reply is sent when the handler resumes and finishes
+    if (!flush(conn))
+      return false;
+    if (!conn.sending() && conn.closeAfterWrite)
+      return false;
+  }
+  return true;
+}
+//----< reply status to conn's request, unread, and close after it >--
+/*
+*  - the request's body is never read, so the connection can't be
+*    used for another request
+*/
+void EventLoop::refuse(Connection& conn, size_t status)
+{
+  HttpMessage<HttpReply> reply = makeHttpReplyMessage(status);
+  reply.contentLength(0);
+  conn.request.keepAlive(false);
+  conn.readingBody = false;
+  queueReply(conn, reply);
+}
+//----< decode as much of a chunked request body as is buffered >-----
+/*
+*  - the framing HttpBodyReader decodes, but read only from the
+*    RecvBuffer, so the loop never waits for the rest of a chunk
+*  - complete once the last chunk's trailer has been read, the body is
+*    then framed by its content-length, as getBody leaves it
+*  - error for a malformed chunk, or a line that fills the RecvBuffer
+*  - error, and conn.tooLarge, for a chunk that would take the body
+*    past the server's maxBodySize, before any of it is read
+*/
+HttpParser::Status EventLoop::readChunked(Connection& conn)
+{
+  RecvBuffer& rb = conn.socket.recvBuffer();
+  std::vector<HttpMessageBody::byte>& bytes = conn.request.body().value();
+  while (true)
+  {
+    if (conn.chunkPart == Connection::chunkData)
+    {
+      size_t used = bytes.size();
+      size_t want = (std::min)(conn.chunkLeft, rb.size());
+      bytes.resize(used + want);
+      rb.read(want, reinterpret_cast<Socket::byte*>(bytes.data() + used));
+      conn.chunkLeft -= want;
+      if (conn.chunkLeft > 0)
+        return HttpParser::incomplete;
+      conn.chunkPart = Connection::chunkEnd;
+    }
+    size_t pos = rb.find('\n');
+    if (pos == RecvBuffer::npos)
+      return rb.full() ? HttpParser::error : HttpParser::incomplete;
+    conn.line.clear();
+    rb.append(pos + 1, conn.line);
+    bool blank = Utilities::StringHelper::trimView(conn.line).empty();
+    switch (conn.chunkPart)
+    {
+    case Connection::sizeLine:
+      if (!HttpMessageBody::parseChunkSize(conn.line, conn.chunkLeft))
+        return HttpParser::error;
+      conn.tooLarge = conn.chunkLeft > pServer_->maxBodySize() - bytes.size();
+      if (conn.tooLarge)
+        return HttpParser::error;
+      conn.chunkPart = (conn.chunkLeft > 0) ? Connection::chunkData : Connection::trailer;
+      break;
+    case Connection::chunkEnd:
+      if (!blank)
+        return HttpParser::error;  // chunk data must end with CRLF
+      conn.chunkPart = Connection::sizeLine;
+      break;
+    default:  // trailer fields are read and ignored
+      if (!blank)
+        break;
+      conn.request.attributes().remove("transfer-encoding");
+      conn.request.contentLength(bytes.size());
+      return HttpParser::complete;
+    }
+  }
+}
+//----< apply server processing and queue serialized reply >-----------
+/*
+*  - a coroutine handler is started here, if it suspends, conn is left
+*    awaiting and its reply is queued when it finishes
+*/
+void EventLoop::dispatch(Connection& conn)
+{
+  if (conn.streamProc != nullptr)
+  {
+    conn.task = serveStream(conn, *conn.streamProc);
+    resume(conn, conn.task.handle());
+    return;
+  }
+  const CoMessageProcessType* pCoProc = pServer_->findCoProc(conn.request);
+  if (pCoProc != nullptr)
+  {
+    conn.task = (*pCoProc)(conn.request);
+    resume(conn, conn.task.handle());
+    return;
+  }
+  HttpMessage<HttpReply> reply = pServer_->doProcessing(conn.request);
+  queueReply(conn, reply);
+}
+//----< run a handler that reads the request body on a blocking thread >
+/*
+*  - conn awaits, so isn't polled, while the handler reads its socket
+*/
+Task<HttpMessage<HttpReply>> EventLoop::serveStream(Connection& conn, const StreamProcessType& proc)
+{
+  HttpServerCore* pServer = pServer_;
+  co_return co_await offload([pServer, &conn, &proc]() {
+    HttpBodyReader reader(conn.socket, conn.request, pServer->idleTimeout());
+    return pServer->doProcessing(conn.request, reader, proc);
+  });
+}
+//----< serialize reply for sending >----------------------------------
+/*
+*  - a file backed reply body is handed to a FileRead, see queueFile,
+*    the loop's non-blocking sends can't wait on a blocking
+*    TransmitFile, and the file may be too large to hold
+*/
+void EventLoop::queueReply(Connection& conn, HttpMessage<HttpReply>& reply)
+{
+  pServer_->encode(conn.request, reply);
+  if (reply.body().isFile() && !queueFile(conn, reply))
+  {
+    reply.type().status(500);
+    reply.body().clear();
+    reply.contentLength(0);
+  }
+  conn.closeAfterWrite = !pServer_->persist(conn.request, reply, ++conn.served);
+  reply.toHeaderString(conn.outHeader);
+  conn.outBody = std::move(reply.body());
+  conn.outPos = 0;
+}
+//----< move file backed body into a FileRead for flush to send >-----
+/*
+*  - returns false if the file can't be opened
+*  - the reply keeps its content-length, the body is sent unframed
+*  - a smaller file's first chunk is read while the header is sent
+*/
+bool EventLoop::queueFile(Connection& conn, HttpMessage<HttpReply>& reply)
+{
+  HttpMessageBody& body = reply.body();
+  FileReadPtr pRead = std::make_shared<FileRead>();
+  pRead->in.open(body.fileSpec(), std::ios::binary);
+  if (!pRead->in.good() || !pRead->in.seekg(static_cast<std::streamoff>(body.fileOffset())))
+    return false;
+  pRead->fileSpec = body.fileSpec();
+  pRead->offset = body.fileOffset();
+  pRead->size = pRead->left = body.fileSize();
+  pRead->transmit = pRead->size >= transmitFileSize;
+  pRead->pConn = &conn;
+  body.clear();
+
+  conn.endFileRead();
+  conn.fileRead = pRead;
+  if (!pRead->transmit)
+    readAhead(pRead);
+  return true;
+}
+//----< read next chunk of a file backed body >------------------------
+/*
+*  - runs on a blocking thread, or on the loop thread when there is
+*    nothing left to read or the blocking threads' queue is full
+*  - an empty chunk means the whole body has been read
+*/
+void EventLoop::FileRead::read()
+{
+  size_t bytes = (std::min)(HttpMessageBody::defaultChunkSize, left);
+  chunk.resize(bytes);
+  if (bytes > 0)
+  {
+    in.read(&chunk[0], bytes);
+    if (static_cast<size_t>(in.gcount()) != bytes)
+      failed = true;
+    left -= bytes;
+  }
+  ready.store(true);
+}
+//----< stop sending file backed body, a read in progress is ignored >-
+
+void EventLoop::Connection::endFileRead()
+{
+  if (fileRead)
+    fileRead->pConn = nullptr;
+  fileRead.reset();
+}
+//----< send conn's header and file with TransmitFile, off the loop >-
+/*
+*  - the socket blocks while a blocking thread sends, conn awaits,
+*    unpolled, and resumeReady resumes it when it's done
+*  - if the blocking threads' queue is full the file is read and sent
+*    a chunk at a time instead
+*/
+bool EventLoop::transmitFile(Connection& conn)
+{
+  FileReadPtr pRead = conn.fileRead;
+  std::function<void()> item = [this, pRead, &conn]()
+  {
+    Socket& socket = conn.socket;
+    socket.nonBlocking(false);
+    pRead->failed = !socket.sendFile(pRead->fileSpec, pRead->size,
+      conn.outHeader.data(), conn.outHeader.size(), pRead->offset);
+    socket.nonBlocking(true);
+    pRead->ready.store(true);
+    {
+      std::lock_guard<std::mutex> lock(readyMtx_);
+      readsDone_.push_back(pRead);
+    }
+    wake();
+  };
+  if (blocking_->submit(std::move(item)))
+  {
+    conn.awaiting = true;
+    return true;
+  }
+  pRead->transmit = false;
+  readAhead(pRead);
+  return flush(conn);
+}
+//----< read pRead's next chunk on a blocking thread >-----------------
+/*
+*  - its connection, if waiting for the chunk, is resumed by resumeReady
+*/
+void EventLoop::readAhead(FileReadPtr pRead)
+{
+  if (pRead->left == 0)
+  {
+    pRead->read();  // the last, empty, chunk
+    return;
+  }
+  std::function<void()> item = [this, pRead]()
+  {
+    pRead->read();
+    {
+      std::lock_guard<std::mutex> lock(readyMtx_);
+      readsDone_.push_back(pRead);
+    }
+    wake();
+  };
+  if (!blocking_->submit(std::move(item)))
+    pRead->read();
+}
+//----< run conn's coroutine handler until it suspends or finishes >---
+/*
+*  - handle is the handler or a Task it awaits, running_ tells the
+*    awaitables which connection they suspend
+*  - an exception thrown by the handler is answered with 500
+*/
+void EventLoop::resume(Connection& conn, std::coroutine_handle<> handle)
+{
+  running_ = &conn;
+  handle.resume();
+  running_ = nullptr;
+  conn.awaiting = !conn.task.done();
+  if (conn.awaiting)
+    return;
+
+  HttpMessage<HttpReply> reply;
+  try
+  {
+    reply = conn.task.result();
+  }
+  catch (std::exception& exc)
+  {
+    Show::error("\n  -- EventLoop handler threw: {}", exc.what());
+    reply = HttpMessage<HttpReply>();
+    reply.type().status(500);
+  }
+  catch (...)
+  {
+    reply = HttpMessage<HttpReply>();
+    reply.type().status(500);
+  }
+  conn.task = Task<HttpMessage<HttpReply>>();
+  queueReply(conn, reply);
+}
+//----< resume handlers whose blocking work or timer has finished >----
+/*
+*  - a finished handler's reply is sent, then any requests pipelined
+*    behind it are served, as after any other reply
+*  - a connection waiting for a file backed body's next chunk, or its
+*    TransmitFile, carries on once it has been read, or sent
+*/
+void EventLoop::resumeReady()
+{
+  std::vector<Resumption> ready;
+  std::vector<FileReadPtr> reads;
+  {
+    std::lock_guard<std::mutex> lock(readyMtx_);
+    ready.swap(ready_);
+    reads.swap(readsDone_);
+  }
+  Clock::time_point now = Clock::now();
+  while (!timers_.empty() && timers_.begin()->first <= now)
+  {
+    ready.push_back(timers_.begin()->second);
+    timers_.erase(timers_.begin());
+  }
+  for (auto& resumption : ready)
+  {
+    Connection& conn = *resumption.pConn;
+    resume(conn, resumption.handle);
+    if (conn.awaiting)
+      continue;
+    conn.lastActive = now;
+    if (!onWritable(conn))
+      conn.closed = true;   // removed by closeIdle
+  }
+  for (auto& pRead : reads)
+  {
+    Connection* pConn = pRead->pConn;
+    if (pConn == nullptr || !pConn->awaiting)
+      continue;  // closed, or chunk was read before flush needed it
+    pConn->awaiting = false;
+    pConn->lastActive = now;
+    if (!onWritable(*pConn))
+      pConn->closed = true;
+  }
+}
+//----< resume handle on this loop after delay >-----------------------
+
+void EventLoop::resumeAfter(std::chrono::milliseconds delay, std::coroutine_handle<> handle)
+{
+  timers_.emplace(Clock::now() + delay, Resumption{ handle, running_ });
+}
+//----< run work on a blocking thread, then resume handle here >-------
+/*
+*  - returns false, without running work, if the queue is full
+*  - handle is resumed even if work throws, BlockingAwaiter's work
+*    catches its function's exceptions for the handler to rethrow
+*/
+bool EventLoop::resumeAfterBlocking(std::function<void()> work, std::coroutine_handle<> handle)
+{
+  Resumption resumption{ handle, running_ };
+  std::function<void()> item = [this, work, resumption]()
+  {
+    try
+    {
+      work();
+    }
+    catch (std::exception& exc)
+    {
+      Show::error("\n  -- EventLoop blocking work threw: {}", exc.what());
+    }
+    catch (...)
+    {
+      Show::error("\n  -- EventLoop blocking work threw");
+    }
+    {
+      std::lock_guard<std::mutex> lock(readyMtx_);
+      ready_.push_back(resumption);
+    }
+    wake();
+  };
+  return blocking_->submit(std::move(item));
+}
+//----< send as much of pending reply as socket accepts >--------------
+/*
+*  - a stream body is sent a chunk at a time, outHeader holding the
+*    header, then each chunk in turn, so the connection holds only one
+*  - a file backed body is sent by transmitFile, or a chunk at a time
+*    after the header, unframed, as it's read.  If the next chunk hasn't
+*    been read yet, conn awaits it, and isn't polled until resumeReady
+*    resumes it.
+*/
+bool EventLoop::flush(Connection& conn)
+{
+  while (true)
+  {
+    if (conn.fileRead && conn.fileRead->transmit)
+    {
+      if (!conn.fileRead->ready.load())
+        return transmitFile(conn);
+      if (conn.fileRead->failed)
+        return false;
+      break;
+    }
+    while (conn.outPos < conn.outSize())
+    {
+      WSABUF bufs[2];
+      size_t numBufs = 0;
+      size_t headerSize = conn.outHeader.size();
+      if (conn.outPos < headerSize)
+      {
+        bufs[numBufs].buf = &conn.outHeader[conn.outPos];
+        bufs[numBufs].len = static_cast<ULONG>(headerSize - conn.outPos);
+        ++numBufs;
+      }
+      const HttpMessageBody& outBody = conn.outBody;  // const access doesn't copy a shared body
+      const std::vector<HttpMessageBody::byte>& body = outBody.value();
+      size_t bodyPos = (conn.outPos > headerSize) ? conn.outPos - headerSize : 0;
+      if (bodyPos < body.size())
+      {
+        bufs[numBufs].buf = reinterpret_cast<CHAR*>(const_cast<HttpMessageBody::byte*>(body.data() + bodyPos));
+        bufs[numBufs].len = static_cast<ULONG>(body.size() - bodyPos);
+        ++numBufs;
+      }
+      long bytesSent = conn.socket.sendAvailable(bufs, numBufs);
+      if (bytesSent < 0)
+        return false;
+      if (bytesSent == 0)
+        return true;  // would block, WSAPoll reports when writable
+      conn.outPos += bytesSent;
+    }
+    if (conn.fileRead)
+    {
+      FileRead& read = *conn.fileRead;
+      if (!read.ready.load())
+      {
+        conn.awaiting = true;
+        return true;
+      }
+      if (read.failed)
+        return false;  // close short of the content-length, the body is truncated
+      if (read.chunk.empty())
+        break;
+      conn.outHeader.swap(read.chunk);
+      read.ready.store(false);
+      readAhead(conn.fileRead);
+      conn.outPos = 0;
+      continue;
+    }
+    if (!conn.outBody.isStream())
+      break;
+    if (!conn.outBody.nextChunk(conn.outHeader))
+    {
+      if (conn.outBody.streamFailed())
+        return false;  // close without the last chunk, the body is truncated
+      break;
+    }
+    conn.outPos = 0;
+  }
+  conn.endFileRead();
+  conn.outHeader.clear();
+  conn.outBody = HttpMessageBody();
+  conn.outPos = 0;
+  return true;
+}
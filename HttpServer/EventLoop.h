@@ -0,0 +1,361 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// EventLoop.h - multiplexes many HTTP connections on one thread       //
+// ver 2.6                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package implements an EventLoop class that serves a set of client
+*  connections from a single thread.  HttpServer::startEventLoops creates
+*  a fixed number of them and hands each accepted connection to one, so
+*  thousands of clients need only a handful of threads.
+*  - Sockets are non-blocking and are waited on with WSAPoll.
+*  - Request bytes are read into each socket's RecvBuffer as they arrive
+*    and the header is parsed there, each read resuming the parse where
+*    the last stopped.  A chunked body is decoded from the RecvBuffer in
+*    the same way, a chunk size line or chunk at a time.  When a complete
+*    request has been buffered it is dispatched through HttpServerCore::doProcessing, the same dispatcher
+*    used by the thread per connection ClientHandler.
+*  - Replies are written without blocking.  While a reply is pending the
+*    loop waits for the socket to become writable instead of readable.
+*    A stream body's producer is called, on the loop thread, for its
+*    next chunk each time the last has been sent.
+*  - A file backed body, e.g., a file too large for getProc's cache, is
+*    sent with its content-length, and never held in memory whole.  A
+*    file of transmitFileSize bytes or more is sent, with its header, by
+*    TransmitFile on one of the loop's blocking threads, so its bytes
+*    never pass through user space.  That holds the thread until the
+*    client has taken the whole file, so smaller files, or any file
+*    when the blocking threads are all busy, are read on the blocking
+*    threads a chunk ahead of the chunk being sent, and sent from the
+*    loop.  Either way, while the connection waits for the file it's
+*    set aside, as for a suspended coroutine, so a slow disk or client
+*    doesn't stall the other connections.
+*  - New connections and stop requests wake the loop by sending a byte
+*    to a loopback UDP socket that is part of the poll set.
+*  - A body larger than the server's maxBodySize isn't read, the request
+*    is answered with 413 and its connection closed.  A chunked body is
+*    refused at the first chunk that would take it past that size.
+*  - Connections persist, as with ClientHandler, until the client asks to
+*    close, the server's request cap is reached, or the connection has
+*    been idle for the server's idleTimeout.
+*  - A request for a coroutine handler, Task<ReplyMsg>, is started on
+*    the loop.  When it suspends, its connection is set aside and the
+*    loop serves others, and its reply is sent once it co_returns.
+*    Handlers suspend by awaiting:
+*    - sleepFor(ms), resumed by the loop when the time is up
+*    - offload(f), which runs f, e.g., reading a file or calling another
+*      server with HttpClient, on one of the loop's blocking threads,
+*      and resumes with f's result, or rethrows what f threw
+*    - other Tasks, which may await these in turn
+*  - A request for a handler that reads its own body, StreamProcessType,
+*    is handed to a blocking thread as soon as its header is parsed.
+*    Its connection is set aside, as for a suspended coroutine, while
+*    the handler reads the body from the socket with an HttpBodyReader.
+*
+*  Required Files:
+*  ---------------
+*  EventLoop.h, EventLoop.cpp, Task.h
+*  HttpServer.h, HttpServer.cpp
+*  ThreadPool.h
+*  Message.h, Message.cpp, HttpParser.h, HttpParser.cpp
+*  Sockets.h, Sockets.cpp
+*  Logger.h, Logger.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 2.6 : 17 Oct 2026
+*  - a chunked request body that grows past the server's maxBodySize is
+*    answered with 413, and its connection closed, before that chunk
+*    is read
+*  ver 2.5 : 17 Oct 2026
+*  - file backed reply bodies keep their content-length instead of
+*    being sent chunked, and files of transmitFileSize or more are sent
+*    with TransmitFile on a blocking thread
+*  ver 2.4 : 17 Oct 2026
+*  - a request whose content-length is more than the server's
+*    maxBodySize is answered with 413, and its connection closed,
+*    before its body is allocated
+*  ver 2.3 : 17 Oct 2026
+*  - file backed reply bodies are read a chunk ahead on the blocking
+*    threads instead of on the loop thread
+*  ver 2.2 : 17 Oct 2026
+*  - file backed reply bodies are sent as streams, read a chunk at a
+*    time, instead of being loaded whole
+*  ver 2.1 : 17 Oct 2026
+*  - an exception thrown by offload's function is rethrown in the
+*    handler, which is resumed as if the function had returned
+*  ver 2.0 : 17 Oct 2026
+*  - chunked request bodies are decoded for handlers that don't read
+*    their own, instead of being taken for the next request
+*  ver 1.9 : 17 Oct 2026
+*  - replies are compressed by HttpServerCore::encode before they're
+*    queued
+*  ver 1.8 : 17 Oct 2026
+*  - request bodies for StreamProcessType handlers aren't read into
+*    memory, the handler reads them on a blocking thread
+*  ver 1.7 : 17 Oct 2026
+*  - sends stream reply bodies with chunked transfer-encoding
+*  ver 1.6 : 17 Oct 2026
+*  - serves coroutine handlers, with sleepFor and offload awaitables
+*  ver 1.5 : 17 Oct 2026
+*  - diagnostics are logged as records, formatted by the logging thread
+*  ver 1.4 : 17 Oct 2026
+*  - request headers are parsed in the socket's RecvBuffer by an
+*    HttpParser, instead of being copied out and split into lines
+*  ver 1.3 : 17 Oct 2026
+*  - file backed reply bodies are loaded before sending
+*  ver 1.2 : 17 Oct 2026
+*  - replies are sent with gathering sends of header and body, the body
+*    is moved from the reply rather than copied behind the header
+*  ver 1.1 : 17 Oct 2026
+*  - keep-alive, with request cap and idle timeout
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+#include "../Message/Message.h"
+#include "../Sockets/Sockets.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "Task.h"
+#include "HttpServerProc.h"
+#include <coroutine>
+#include <functional>
+#include <map>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+
+namespace HttpCommunication
+{
+  class HttpServerCore;
+
+  /////////////////////////////////////////////////////////////////////
+  // EventLoop class
+  // - owns a thread and the connections assigned to it
+  // - add(socket) may be called from any thread
+
+  class EventLoop
+  {
+  public:
+    EventLoop(HttpServerCore* pServer);
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool start();
+    void stop();
+    void add(Sockets::Socket&& socket);
+    size_t connections() const { return connections_.load(); }
+
+    static EventLoop* current() { return current_; }
+    void resumeAfter(std::chrono::milliseconds delay, std::coroutine_handle<> handle);
+    bool resumeAfterBlocking(std::function<void()> work, std::coroutine_handle<> handle);
+
+    static const size_t blockingThreads = 4;
+    static const size_t blockingQueueSize = 1024;
+    static const size_t transmitFileSize = 8 * 1024 * 1024;
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection;
+
+    // a file backed reply body, sent by TransmitFile or read a chunk
+    // ahead of the one being sent
+    // - one read, or the TransmitFile, at a time, on a blocking thread,
+    //   hands its result to the loop thread by setting ready
+
+    struct FileRead
+    {
+      void read();
+      std::ifstream in;
+      std::string fileSpec;
+      size_t offset = 0;                      // where in the file the body starts
+      size_t size = 0;                        // bytes of body
+      size_t left = 0;                        // bytes not yet read
+      std::string chunk;                      // swapped into outHeader to be sent
+      bool transmit = false;                  // TransmitFile sends header and body
+      bool failed = false;                    // file shrank, or TransmitFile failed
+      std::atomic<bool> ready = false;        // chunk holds next bytes, or sent
+      Connection* pConn = nullptr;            // null once conn isn't sending it
+    };
+    using FileReadPtr = std::shared_ptr<FileRead>;
+
+    struct Connection
+    {
+      Connection(Sockets::Socket&& s) : socket(std::move(s)), lastActive(Clock::now()) {}
+      ~Connection() { endFileRead(); }
+      void endFileRead();
+      Sockets::Socket socket;
+      HttpParser parser;
+      HttpMessage<HttpRequest> request;
+      bool readingBody = false;
+      const StreamProcessType* streamProc = nullptr;  // handler reads body itself
+      size_t bodyRead = 0;
+      enum ChunkPart { sizeLine, chunkData, chunkEnd, trailer };
+      bool chunked = false;                 // body is decoded by readChunked
+      ChunkPart chunkPart = sizeLine;
+      size_t chunkLeft = 0;                 // bytes of current chunk not yet read
+      bool tooLarge = false;                // chunks would pass maxBodySize
+      std::string line;                     // chunk size line, or trailer field
+      std::string outHeader;     // capacity reused by each reply
+      HttpMessageBody outBody;
+      size_t outPos = 0;         // bytes of header then body already sent
+      FileReadPtr fileRead;      // reads outBody's chunks, if it's a file
+      size_t outSize() const { return outHeader.size() + outBody.size(); }
+      bool sending() const { return outPos < outSize() || outBody.isStream() || fileRead != nullptr; }
+      bool closeAfterWrite = false;
+      size_t served = 0;
+      Clock::time_point lastActive;
+      Task<HttpMessage<HttpReply>> task;  // coroutine handler in progress
+      bool awaiting = false;              // task is suspended, or waiting for fileRead
+      bool closed = false;                // close at next sweep
+    };
+    using ConnPtr = std::unique_ptr<Connection>;
+
+    // a suspended coroutine and the connection whose handler it serves
+
+    struct Resumption
+    {
+      std::coroutine_handle<> handle;
+      Connection* pConn;
+    };
+
+    void run();
+    void wake();
+    void drainWake();
+    void adoptPending();
+    void remove(size_t i);
+    void closeIdle();
+    bool onReadable(Connection& conn);
+    bool onWritable(Connection& conn);
+    bool processRequests(Connection& conn);
+    void refuse(Connection& conn, size_t status);
+    HttpParser::Status readChunked(Connection& conn);
+    void dispatch(Connection& conn);
+    Task<HttpMessage<HttpReply>> serveStream(Connection& conn, const StreamProcessType& proc);
+    void queueReply(Connection& conn, HttpMessage<HttpReply>& reply);
+    bool queueFile(Connection& conn, HttpMessage<HttpReply>& reply);
+    void readAhead(FileReadPtr pRead);
+    bool transmitFile(Connection& conn);
+    bool flush(Connection& conn);
+    void resume(Connection& conn, std::coroutine_handle<> handle);
+    void resumeReady();
+    INT pollTimeout() const;
+
+    HttpServerCore* pServer_;
+    std::vector<WSAPOLLFD> fds_;    // fds_[0] is the wake socket
+    std::vector<ConnPtr> conns_;    // conns_[i] is polled by fds_[i], conns_[0] unused
+    std::vector<Sockets::Socket> pending_;
+    std::mutex pendingMtx_;
+    ::SOCKET wakeSocket_ = INVALID_SOCKET;
+    sockaddr_in wakeAddr_;
+    std::thread thread_;
+    std::atomic<bool> stop_ = false;
+    std::atomic<size_t> connections_ = 0;
+
+    std::multimap<Clock::time_point, Resumption> timers_;
+    std::vector<Resumption> ready_;   // finished blocking work
+    std::vector<FileReadPtr> readsDone_;
+    std::mutex readyMtx_;
+    std::unique_ptr<ThreadPool<std::function<void()>>> blocking_;
+    Connection* running_ = nullptr;   // connection whose task is running
+    static thread_local EventLoop* current_;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // awaitables for coroutine handlers
+  // - on a thread no EventLoop runs they complete in place, blocking
+
+  //----< co_await sleepFor(ms) resumes after ms milliseconds >--------
+
+  struct SleepAwaiter
+  {
+    std::chrono::milliseconds delay;
+
+    bool await_ready()
+    {
+      if (EventLoop::current() != nullptr)
+        return delay.count() <= 0;
+      std::this_thread::sleep_for(delay);
+      return true;
+    }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      EventLoop::current()->resumeAfter(delay, handle);
+    }
+    void await_resume() {}
+  };
+
+  inline SleepAwaiter sleepFor(std::chrono::milliseconds delay)
+  {
+    return SleepAwaiter{ delay };
+  }
+  //----< co_await offload(f) runs f on a blocking thread >------------
+  /*
+  *  - f returns a value, which is the result of the co_await
+  *  - an exception f throws is caught where f runs, and rethrown by
+  *    the co_await, so the handler always resumes
+  *  - f runs on the loop thread instead when the blocking threads'
+  *    queue is full
+  */
+  template <typename F>
+  class BlockingAwaiter
+  {
+  public:
+    using Result = std::invoke_result_t<F&>;
+
+    explicit BlockingAwaiter(F f) : f_(std::move(f)) {}
+    bool await_ready()
+    {
+      if (EventLoop::current() != nullptr)
+        return false;
+      run();
+      return true;
+    }
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      if (EventLoop::current()->resumeAfterBlocking([this]() { run(); }, handle))
+        return true;
+      run();
+      return false;
+    }
+    Result await_resume()
+    {
+      if (exception_)
+        std::rethrow_exception(exception_);
+      return std::move(*result_);
+    }
+  private:
+    void run()
+    {
+      try
+      {
+        result_.emplace(f_());
+      }
+      catch (...)
+      {
+        exception_ = std::current_exception();
+      }
+    }
+    F f_;
+    std::optional<Result> result_;
+    std::exception_ptr exception_;
+  };
+
+  template <typename F>
+  BlockingAwaiter<F> offload(F f)
+  {
+    return BlockingAwaiter<F>(std::move(f));
+  }
+}
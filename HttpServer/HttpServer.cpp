@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////
 // HttpServer.cpp - Provides HTTP Message service                      //
-// ver 1.0                                                             //
+// ver 2.1                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2018           //
 // Application: OOD Demo                                               //
 // Platform:    Visual Studio 2017, Dell XPS 8920, Windows 10 pro      //
@@ -14,6 +14,10 @@
 #include "HttpServerProc.h"
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <cstring>
+#include <memory>
+#include <algorithm>
 
 using namespace Sockets;
 using Show = StaticLogger<1>;
@@ -33,7 +37,7 @@ namespace HttpCommunication
   }
   //----< push message into socket >-----------------------------------
 
-  void HttpServerCore::postMessage(HttpMessage<HttpReply> reply)
+  void HttpServerCore::postMessage(const HttpMessage<HttpReply>& reply)
   {
     HttpCommCore::postMessage<HttpReply>(reply);
   }
@@ -47,38 +51,83 @@ namespace HttpCommunication
   *    its server processing.
   */
 
-  //----< hook for application defined processing >--------------------
+  //----< dispatcher key: command attribute, else the HTTP command >---
 
-  ReplyMsg HttpServerCore::doProcessing(HttpMessage<HttpRequest>& msg)
+  Key HttpServerCore::procKey(RequestMsg& msg)
   {
     HttpMessage<HttpRequest>::Key key = "command";
+    if (msg.containsKey(key))  // non-HTTP command
+      return msg.attributes()[key];
+    return msg.type().toString(false);
+  }
+  //----< hook for application defined processing >--------------------
+  /*
+  *  - a coroutine handler is run to completion on the calling thread,
+  *    event loops start them with findCoProc instead, so they can
+  *    suspend
+  *  - an exception leaving a coroutine handler is answered with 500,
+  *    as the event loops do
+  */
+  ReplyMsg HttpServerCore::doProcessing(HttpMessage<HttpRequest>& msg)
+  {
+    // Uses find, not operator[], so that concurrent client threads and
+    // event loops only read the dispatcher.
 
-    if (msg.containsKey(key))  // process non-HTTP command
-    { 
-      HttpMessage<HttpRequest>::Value cmdValue = msg.attributes()[key];
-      if (containsKey(cmdValue))
-        return dispatcher_[cmdValue](msg);
-    }
-    else  // process HTTP command
+    Key key = procKey(msg);
+    auto iter = dispatcher_.find(key);
+    if (iter != dispatcher_.end())
+      return iter->second(msg);
+    auto coIter = coDispatcher_.find(key);
+    if (coIter != coDispatcher_.end())
     {
-      Key procKey = msg.type().toString(false);
-      if (containsKey(procKey))
+      try
       {
-        HttpMessage<HttpReply> reply = dispatcher_[procKey](msg);
-        return reply;
+        return coIter->second(msg).get();
+      }
+      catch (...)
+      {
+        HttpMessage<HttpReply> errReply;
+        errReply.type().status(500);
+        return errReply;
       }
     }
+
     // return error message
 
     HttpMessage<HttpReply> errReply;
     errReply.type().status(400);
     return errReply;
   }
+  //----< apply a handler that reads the request body from reader >---
+  /*
+  *  - the rest of the body, if the handler didn't read it all, is read
+  *    and discarded, so the next request can be read
+  *  - if the body can't be read, the connection is closed after the
+  *    reply
+  *  - an exception leaving the handler is answered with 500
+  */
+  ReplyMsg HttpServerCore::doProcessing(HttpMessage<HttpRequest>& msg, HttpBodyReader& reader, const StreamProcessType& proc)
+  {
+    HttpMessage<HttpReply> reply;
+    try
+    {
+      reply = proc(msg, reader);
+    }
+    catch (...)
+    {
+      reply = HttpMessage<HttpReply>();
+      reply.type().status(500);
+    }
+    if (!reader.skip())
+      msg.keepAlive(false);
+    return reply;
+  }
   //----< does dispatcher contain this key? >--------------------------
 
   bool HttpServerCore::containsKey(Key key)
   {
-    return dispatcher_.find(key) != dispatcher_.end();
+    return dispatcher_.find(key) != dispatcher_.end() || coDispatcher_.find(key) != coDispatcher_.end() ||
+      streamDispatcher_.find(key) != streamDispatcher_.end();
   }
   //----< add server processing callable object >----------------------
 
@@ -88,48 +137,246 @@ namespace HttpCommunication
       return;
     dispatcher_[key] = proc;
   }
+  //----< add server processing coroutine >----------------------------
+
+  void HttpServerCore::addProc(Key key, CoMessageProcessType proc)
+  {
+    if (containsKey(key))
+      return;
+    coDispatcher_[key] = proc;
+  }
+  //----< add server processing that reads the request body itself >--
+
+  void HttpServerCore::addProc(Key key, StreamProcessType proc)
+  {
+    if (containsKey(key))
+      return;
+    streamDispatcher_[key] = proc;
+  }
+  //----< coroutine handler for msg, nullptr if its handler isn't one >-
+
+  const CoMessageProcessType* HttpServerCore::findCoProc(RequestMsg& msg) const
+  {
+    if (coDispatcher_.empty())
+      return nullptr;
+    auto iter = coDispatcher_.find(procKey(msg));
+    return iter != coDispatcher_.end() ? &iter->second : nullptr;
+  }
+  //----< body reading handler for msg, nullptr if its handler isn't one >
+
+  const StreamProcessType* HttpServerCore::findStreamProc(RequestMsg& msg) const
+  {
+    if (streamDispatcher_.empty())
+      return nullptr;
+    auto iter = streamDispatcher_.find(procKey(msg));
+    return iter != streamDispatcher_.end() ? &iter->second : nullptr;
+  }
+  //----< set limits on persistent connections >----------------------
+  /*
+  *  - maxRequests of 1 restores one request per connection
+  */
+  void HttpServerCore::keepAlive(size_t maxRequests, size_t idleTimeout)
+  {
+    maxRequests_ = (maxRequests > 0) ? maxRequests : 1;
+    idleTimeout_ = idleTimeout;
+  }
+  //----< decide if connection stays open and tell client >------------
+  /*
+  *  - served counts requests on this connection, including msg
+  *  - sets reply's connection attribute to match the decision
+  */
+  bool HttpServerCore::persist(const RequestMsg& msg, ReplyMsg& reply, size_t served) const
+  {
+    bool keep = msg.keepAlive() && served < maxRequests_;
+    reply.keepAlive(keep);
+    return keep;
+  }
+  //----< compress reply, if msg allows, before it's sent >------------
+  /*
+  *  - called by both server modes for every reply
+  */
+  void HttpServerCore::encode(RequestMsg& msg, ReplyMsg& reply) const
+  {
+    if (compress_)
+      compressReply(msg, reply);
+  }
+  //----< log message at debug level, with a title >------------------
+
+  template <typename T>
+  void showMessage(const std::string& title, const HttpMessage<T>& msg)
+  {
+    std::ostringstream out;
+    out << title;
+    msg.show(out);
+    out << "\n";
+    Show::write(out.str());
+  }
   //----< defines server processing for each client thread >-----------
   /*
   *  - Client threads are created in Sockets::SocketListener::start(...).
   *  - The SocketListener thread creates an instance of ClientHandler
   *    and a thread that executes that instance.
+  *  - Serves requests until the client closes or asks to close, the
+  *    server's request cap is reached, or the connection is idle for
+  *    the server's idleTimeout.
+  *  - In pool mode it also stops when other connections are waiting for
+  *    a pool thread, see awaitRequest.
+  *  - Verbose output is logged at debug level, so is compiled out of
+  *    builds whose LOG_LEVEL is less verbose.
   */
   void ClientHandler::operator()(Socket&& socket)
   {
-    std::cout << "\n  entered ClientHandler::operator()";
-    std::cout << "\n  socket handle = " << (int)socket;
-    // The following statement must be the first in every 
-    // application defined ClientHandler::operator().
+    bool verbose = verbose_ && Show::enabled<LogLevel::debug>();
+    if (verbose)
+    {
+      Show::debug("\n  entered ClientHandler::operator()");
+      Show::debug("\n  socket handle = {}", static_cast<int>(socket));
+    }
+    // Each client thread uses its own HttpCommCore for I/O, so threads
+    // don't share the server's socket pointer.  Only the dispatcher is
+    // shared.
+
+    HttpCommCore comm(&socket);
+    socket.noDelay(true);
+    size_t served = 0;
+    bool persist = true;
 
-    //HttpServerCore server(&socket);
-    pServer_->setSocket(&socket);
+    while (persist)
+    {
+      if (!awaitRequest(socket, served))
+      {
+        if (verbose)
+          Show::debug("\n  closing idle connection");
+        break;
+      }
+      if (verbose)
+        Show::debug("\n  calling getMessage");
+      HttpMessage<HttpRequest> msg = comm.getHeader<HttpRequest>();
+      if (comm.connectionClosed())
+        break;
 
-    std::cout << "\n  calling getMessage";
-    HttpMessage<HttpRequest> msg = pServer_->getMessage();
-    
-    std::cout << "\n--received request message:";
-    msg.show();
-    Utilities::putline();
+      // apply application define processing, a handler that reads
+      // the body itself gets it as it arrives
 
-    // apply application define processing
+      HttpMessage<HttpReply> reply;
+      const StreamProcessType* pStreamProc = pServer_->findStreamProc(msg);
+      if (pStreamProc != nullptr)
+      {
+        if (verbose)
+          showMessage("\n--received request header:", msg);
+        HttpBodyReader reader(socket, msg, pServer_->idleTimeout());
+        reply = pServer_->doProcessing(msg, reader, *pStreamProc);
+      }
+      else
+      {
+        if (!comm.getBody(msg, pServer_->maxBodySize()))
+        {
+          if (comm.bodyTooLarge())
+          {
+            HttpMessage<HttpReply> tooLarge = makeHttpReplyMessage(413);
+            tooLarge.keepAlive(false);
+            tooLarge.contentLength(0);
+            comm.postMessage<HttpReply>(tooLarge);
+          }
+          break;
+        }
+        if (verbose)
+          showMessage("\n--received request message:", msg);
+        reply = pServer_->doProcessing(msg);
+      }
+      pServer_->encode(msg, reply);
+      persist = pServer_->persist(msg, reply, ++served);
+      if (persist && pServer_->connectionsWaiting() > 0)
+      {
+        persist = false;  // hand this pool thread to a waiting connection
+        reply.keepAlive(false);
+      }
 
-    HttpMessage<HttpReply> reply = pServer_->doProcessing(msg);
-    
-    pServer_->postMessage(reply);
-    std::cout << "\n--sent reply message:";
-    reply.show();
-    Utilities::putline();
+      comm.postMessage<HttpReply>(reply);
+      if (verbose)
+        showMessage("\n--sent reply message:", reply);
+    }
 
     // terminate session
 
     socket.shutDown();
   }
+  //----< wait for next request on a kept-alive connection >----------
+  /*
+  *  - false if the connection is idle for the server's idleTimeout
+  *  - in pool mode, once a request has been served, also false as soon
+  *    as another connection is waiting for a pool thread, checked
+  *    every poolCheck milliseconds, so idle clients can't hold every
+  *    thread
+  */
+  bool ClientHandler::awaitRequest(Socket& socket, size_t served)
+  {
+    size_t timeout = pServer_->idleTimeout();
+    if (!pServer_->pooled() || served == 0)
+      return socket.waitForData(timeout);
+    for (size_t waited = 0; waited < timeout; waited += poolCheck)
+    {
+      if (pServer_->connectionsWaiting() > 0)
+        return false;
+      if (socket.waitForData((std::min)(poolCheck, timeout - waited)))
+        return true;
+    }
+    return false;
+  }
+  //----< tell an overloaded server's client to try later >----------
+  /*
+  *  - Reads whatever part of the request has already arrived, so that
+  *    closing doesn't reset the connection before the client reads the
+  *    reply.
+  */
+  void HttpServer::reject(Socket& socket)
+  {
+    socket.nonBlocking(true);
+    socket.recvAvailable();
+    socket.nonBlocking(false);
+
+    HttpMessage<HttpReply> reply = makeHttpReplyMessage(503);
+    reply.keepAlive(false);
+    HttpCommCore comm(&socket);
+    comm.postMessage<HttpReply>(reply);
+    socket.shutDownSend();
+  }
+  //----< serve all connections from numLoops event loop threads >----
+  /*
+  *  - Accepted connections are assigned to loops round-robin.
+  *  - Each loop dispatches requests with doProcessing, so procs added
+  *    with addProc work in either server mode.
+  */
+  bool HttpServer::startEventLoops(size_t numLoops)
+  {
+    std::cout << "\n  starting server listener with " << numLoops << " event loops";
+    if (numLoops == 0)
+      numLoops = 1;
+    for (size_t i = 0; i < numLoops; ++i)
+    {
+      loops_.push_back(std::unique_ptr<EventLoop>(new EventLoop(this)));
+      if (!loops_.back()->start())
+        return false;
+    }
+    size_t next = 0;
+    return socketListener.startAccepting([this, next](Socket&& socket) mutable
+    {
+      loops_[next++ % loops_.size()]->add(std::move(socket));
+    });
+  }
 }
 //----< server entry point >-----------------------------------------
+/*
+*  - HttpServer              : thread per connection
+*  - HttpServer eventloop n  : n event loop threads, n defaults to 4
+*  - HttpServer pool n cap   : n pool threads, defaults to 8, with cap
+*                              waiting connections, defaults to 64
+*/
+#ifdef TEST_HTTPSERVER
 
 using namespace HttpCommunication;
 
-int main()
+int main(int argc, char* argv[])
 {
   SetConsoleTitle(L"HttpServer");
 
@@ -141,9 +388,66 @@ int main()
     HttpServer server(8080, Socket::IP4);
     server.addProc("GET", getProc);
     server.addProc("POST", postProc);
-    
+    server.addProc("PUT", putProc);
+
+    // a coroutine handler, for requests with a command:delay attribute,
+    // waits without holding a thread when served by event loops
+
+    server.addProc("delay", [](RequestMsg& msg) -> Task<ReplyMsg> {
+      co_await sleepFor(std::chrono::milliseconds(500));
+      co_return getProc(msg);
+    });
+
+    // a report, for requests with a command:report attribute, is
+    // generated a chunk at a time while it's sent, so however many
+    // lines are asked for, one chunk is held in memory
+
+    server.addProc("report", [](RequestMsg& msg) {
+      size_t lines = Utilities::Converter<size_t>::toValue(msg.attributes()["lines"]);
+      auto next = std::make_shared<size_t>(0);
+      ReplyMsg reply = makeHttpReplyMessage(200);
+      reply.stream([lines, next](HttpMessageBody::byte* buffer, size_t size) {
+        size_t used = 0;
+        for (; *next < lines; ++*next)
+        {
+          std::string line = "line " + Utilities::Converter<size_t>::toString(*next) + " of report\n";
+          if (used + line.size() > size)
+            break;
+          std::memcpy(buffer + used, line.data(), line.size());
+          used += line.size();
+        }
+        return used;
+      });
+      return reply;
+    });
+
+    // an echo, for requests with a command:echo attribute, replies with
+    // the request's body, whether it was sent with a content-length or
+    // chunked
+
+    server.addProc("echo", [](RequestMsg& msg) {
+      ReplyMsg reply = makeHttpReplyMessage(200);
+      reply.body() = msg.body();
+      reply.contentLength(reply.body().size());
+      return reply;
+    });
+
     ClientHandler cp(&server);
-    server.start<ClientHandler>(cp);
+    if (argc > 1 && std::string(argv[1]) == "eventloop")
+    {
+      size_t numLoops = (argc > 2) ? Utilities::Converter<size_t>::toValue(argv[2]) : 4;
+      server.startEventLoops(numLoops);
+    }
+    else if (argc > 1 && std::string(argv[1]) == "pool")
+    {
+      size_t numThreads = (argc > 2) ? Utilities::Converter<size_t>::toValue(argv[2]) : 8;
+      size_t capacity = (argc > 3) ? Utilities::Converter<size_t>::toValue(argv[3]) : 64;
+      server.startPool<ClientHandler>(cp, numThreads, capacity);
+    }
+    else
+    {
+      server.start<ClientHandler>(cp);
+    }
 
     Show::write("\n --------------------\n  press key to exit: \n --------------------");
     std::cout.flush();
@@ -155,4 +459,5 @@ int main()
     std::string exMsg = "\n  " + std::string(exc.what()) + "\n\n";
     Show::write(exMsg);
   }
-}
\ No newline at end of file
+}
+#endif
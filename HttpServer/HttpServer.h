@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // HttpServer.h - Provides HTTP Message service                        //
-// ver 1.0                                                             //
+// ver 2.1                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2018           //
 // Application: OOD Demo                                               //
 // Platform:    Visual Studio 2017, Dell XPS 8920, Windows 10 pro      //
@@ -16,10 +16,51 @@
 * - HttpMessages are defined in a separate Message package.
 * - The default processing provided here will accept and display messages
 *   from Chrome, FireFox, and Edge.
+* - Alternatively, startEventLoops(n) serves all connections from n
+*   EventLoop threads, using the same dispatcher.
+* - startPool(co, n, capacity) runs co for each connection on one of n
+*   pool threads.  When capacity connections are already waiting for a
+*   thread, new ones get a 503 reply instead of a thread.
+*   A kept-alive connection holds its pool thread between requests, so
+*   n idle clients would otherwise keep every thread from the clients
+*   queued behind them.  ClientHandler, in pool mode, closes a
+*   connection after a request whenever other connections are waiting,
+*   and stops waiting for an idle connection's next request as soon as
+*   one is.
+* - addProc also accepts coroutine handlers, returning Task<ReplyMsg>.
+*   Event loops run other connections while one is suspended, so many
+*   slow requests need only a few threads.  ClientHandler threads run
+*   them to completion, blocking where they would have suspended.
+* - addProc also accepts handlers that read the request body from an
+*   HttpBodyReader, StreamProcessType, e.g., putProc, so an upload is
+*   consumed as it arrives, in memory independent of its size.  Event
+*   loops run them on their blocking threads.  A body the handler
+*   leaves unread is read and discarded before the next request.
+* - A handler may reply with a stream body, see HttpMessage::stream,
+*   whose producer is called for each chunk as the reply is sent, so a
+*   large generated reply never sits in memory whole.
+* - Replies are compressed with gzip or deflate when the request's
+*   Accept-Encoding allows it.  getProc serves precompressed .gz
+*   siblings and caches compressed files, other replies are compressed
+*   as they're sent, see compressReply.  compressReplies(false) turns
+*   the latter off.
+* - Connections persist across requests unless the client sends
+*   "connection:close".  keepAlive(maxRequests, idleTimeout) limits
+*   the requests served on one connection and how long, in milliseconds,
+*   an idle connection is held open.
+* - maxBodySize(bytes) bounds the request bodies read into memory for
+*   handlers, 64 MB by default.  A larger one is answered with 413 and
+*   the connection closed, before any of it is read, so a client can't
+*   exhaust the server's memory with a large content-length.  Handlers
+*   that read their own bodies, StreamProcessType, aren't limited.
 *
 *  Required Files:
 * -----------------
-*   HttpServer.h, HttpServer.cpp
+*   HttpServer.h, HttpServer.cpp, HttpServerProc.h, Task.h
+*   EventLoop.h, EventLoop.cpp
+*   FileCache.h, FileCache.cpp
+*   Compression.h, Compression.cpp
+*   ThreadPool.h
 *   HttpClient.h, HttpClient.cpp
 *   Message.h, Message.cpp
 *   Sockets.h, Sockets.cpp,
@@ -29,6 +70,41 @@
 *
 *  Maintenance History:
 * ----------------------
+*   ver 2.1 : 17 Oct 2026
+*   - in pool mode a kept-alive connection gives up its thread when
+*     other connections are waiting for one
+*   ver 2.0 : 17 Oct 2026
+*   - added maxBodySize, a request body read into memory larger than it
+*     is answered with 413 and the connection closed
+*   ver 1.9 : 17 Oct 2026
+*   - test stub echoes the body of a command:echo request, so clients
+*     can check a chunked request body arrives whole
+*   ver 1.8 : 17 Oct 2026
+*   - replies are compressed when the request's Accept-Encoding allows,
+*     see compressReplies
+*   ver 1.7 : 17 Oct 2026
+*   - addProc registers StreamProcessType handlers, which read request
+*     bodies from an HttpBodyReader, test stub serves PUT with putProc
+*   ver 1.6 : 17 Oct 2026
+*   - both server modes send stream reply bodies chunked, test stub
+*     serves a generated report that way
+*   ver 1.5 : 17 Oct 2026
+*   - addProc registers coroutine handlers too, CoMessageProcessType
+*   ver 1.4 : 17 Oct 2026
+*   - ClientHandler's verbose output is logged at debug level instead of
+*     written to std::cout, so it costs nothing when compiled out
+*   ver 1.3 : 17 Oct 2026
+*   - added HttpServer::startPool, a fixed size thread pool server mode
+*     with a bounded admission queue
+*   ver 1.2 : 17 Oct 2026
+*   - added keep-alive: ClientHandler and EventLoop serve requests on a
+*     connection until the client asks to close, the request cap is
+*     reached, or the connection is idle for idleTimeout milliseconds
+*   ver 1.1 : 17 Oct 2026
+*   - added HttpServer::startEventLoops, an event driven server mode
+*   - ClientHandler does its I/O through its own HttpCommCore so that
+*     concurrent client threads don't share the server's socket pointer
+*   - main is now the test stub, defined by TEST_HTTPSERVER
 *   ver 1.0 : 07 Jan 2017
 *   - first release
 *
@@ -39,6 +115,10 @@
 #include "../Sockets/Sockets.h"
 #include "../HttpCommCore/HttpCommCore.h"
 #include "HttpServerProc.h"
+#include "EventLoop.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <vector>
+#include <memory>
 
 namespace HttpCommunication
 {
@@ -58,12 +138,33 @@ namespace HttpCommunication
     HttpServerCore() = default;
     virtual ~HttpServerCore() {}
     HttpMessage<HttpRequest> getMessage();
-    void postMessage(HttpMessage<HttpReply> msg);
+    void postMessage(const HttpMessage<HttpReply>& msg);
     HttpMessage<HttpReply> doProcessing(HttpMessage<HttpRequest>& msg);
+    HttpMessage<HttpReply> doProcessing(HttpMessage<HttpRequest>& msg, HttpBodyReader& reader, const StreamProcessType& proc);
     void addProc(Key key, MessageProcessType proc);
+    void addProc(Key key, CoMessageProcessType proc);
+    void addProc(Key key, StreamProcessType proc);
+    const CoMessageProcessType* findCoProc(RequestMsg& msg) const;
+    const StreamProcessType* findStreamProc(RequestMsg& msg) const;
     bool containsKey(Key key);
+    void keepAlive(size_t maxRequests, size_t idleTimeout);
+    size_t maxRequests() const { return maxRequests_; }
+    size_t idleTimeout() const { return idleTimeout_; }
+    void maxBodySize(size_t bytes) { maxBodySize_ = bytes; }
+    size_t maxBodySize() const { return maxBodySize_; }
+    bool persist(const RequestMsg& msg, ReplyMsg& reply, size_t served) const;
+    void compressReplies(bool compress) { compress_ = compress; }
+    bool compressReplies() const { return compress_; }
+    void encode(RequestMsg& msg, ReplyMsg& reply) const;
   private:
+    static Key procKey(RequestMsg& msg);
     std::unordered_map<std::string, MessageProcessType> dispatcher_;
+    std::unordered_map<std::string, CoMessageProcessType> coDispatcher_;
+    std::unordered_map<std::string, StreamProcessType> streamDispatcher_;
+    size_t maxRequests_ = 100;   // requests served on one connection
+    size_t idleTimeout_ = 5000;  // milliseconds
+    size_t maxBodySize_ = 64 * 1024 * 1024;  // bytes, of a body read into memory
+    bool compress_ = true;
   };
 
   /////////////////////////////////////////////////////////////////////
@@ -71,6 +172,8 @@ namespace HttpCommunication
   // - A single instance is created by the application.
   // - Instances start socket listener with an appropriate port,
   //   IP version Socket::IP4 or Socket::IP6, and client handler instance
+  // - or start a fixed number of event loops that share all connections
+  // - or start a fixed size pool of client handling threads
   //
   class HttpServer : public HttpServerCore
   {
@@ -82,10 +185,41 @@ namespace HttpCommunication
       std::cout << "\n  starting server listener";
       return socketListener.start(co);
     }
+    bool startEventLoops(size_t numLoops);
+    template <typename ClientHandlerType>
+    bool startPool(ClientHandlerType& co, size_t numThreads, size_t queueCapacity);
+    size_t rejected() const { return pool_ ? pool_->refused() : 0; }
+    bool pooled() const { return pool_ != nullptr; }
+    size_t connectionsWaiting() { return pool_ ? pool_->queued() : 0; }
   private:
+    void reject(Sockets::Socket& socket);
     Sockets::SocketSystem ss;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::unique_ptr<ThreadPool<Sockets::Socket>> pool_;
     Sockets::SocketListener socketListener;
   };
+
+  //----< serve connections from a fixed number of pool threads >-----
+  /*
+  *  - Each pool thread runs its own copy of co on the connections it
+  *    deQs, so co is applied just as start(co) does.
+  *  - A connection arriving when queueCapacity connections are waiting
+  *    is rejected with 503 on the listener thread.
+  */
+  template <typename ClientHandlerType>
+  bool HttpServer::startPool(ClientHandlerType& co, size_t numThreads, size_t queueCapacity)
+  {
+    std::cout << "\n  starting server listener with " << numThreads << " pool threads";
+    pool_.reset(new ThreadPool<Sockets::Socket>(numThreads, queueCapacity,
+      [co](Sockets::Socket& socket) mutable { co(std::move(socket)); }
+    ));
+    pool_->start();
+    return socketListener.startAccepting([this](Sockets::Socket&& socket)
+    {
+      if (!pool_->submit(std::move(socket)))
+        reject(socket);
+    });
+  }
   /////////////////////////////////////////////////////////////////////
   // ClientHandler class
   // - defines processing for each server thread, created when a client connects
@@ -97,9 +231,12 @@ namespace HttpCommunication
   class ClientHandler
   {
   public:
-    ClientHandler(HttpServer* pServer) : pServer_(pServer) {};
+    ClientHandler(HttpServer* pServer, bool verbose = true) : pServer_(pServer), verbose_(verbose) {};
     void operator()(Sockets::Socket&& socket);
+    static constexpr size_t poolCheck = 50;  // milliseconds between checks for waiting connections
   private:
+    bool awaitRequest(Sockets::Socket& socket, size_t served);
     HttpServer* pServer_;
+    bool verbose_;
   };
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // HttpServerProc.h - Provides application specific server processing  //
-// ver 1.0                                                             //
+// ver 2.0                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2018           //
 // Application: OOD Projects                                           //
 // Platform:    Visual Studio 2017, Dell XPS 8920, Windows 10 pro      //
@@ -12,25 +12,82 @@
 * This package implements application specific processing, e.g., 
 * transformation of HttpMessage<HttpRequest> into HttpMessage<HttpReply>
 * provided as a set of functions.  Note that lambdas would work too.
+* Handlers that wait, on timers, files, or other servers, may instead
+* be coroutines returning Task<ReplyMsg>, CoMessageProcessType, so an
+* EventLoop serves other connections while they're suspended.
+* Handlers taking an HttpBodyReader, StreamProcessType, read the request
+* body themselves, as it arrives, instead of receiving it in memory.
+* putProc uses one to stream uploads to disk.
+* getProc serves byte ranges of a file for Range requests, reading only
+* the bytes in those ranges, whether the file is cached or not.
+* getProc and compressReply encode replies with gzip or deflate when the
+* client's Accept-Encoding allows it, see Compression.h.
+* getProc sends each file's validators, ETag and Last-Modified, and
+* answers If-None-Match and If-Modified-Since requests for a version
+* the client already has with 304, not modified, and no body.
 *
 *  Required Files:
 * -----------------
-*   HttpServerProc.h
+*   HttpServerProc.h, Task.h, HttpCommCore.h
+*   FileCache.h, FileCache.cpp
+*   Compression.h, Compression.cpp
 *   Message.h, Message.cpp
 *   Utilities.h, Utilities.cpp
 *
 *  Maintenance History:
 * ----------------------
+*   ver 2.0 : 17 Oct 2026
+*   - added localPath, getProc and putProc answer 400 for a path that
+*     could leave the server's directory
+*   ver 1.9 : 17 Oct 2026
+*   - putProc writes each upload to its own temporary file
+*   ver 1.8 : 17 Oct 2026
+*   - getProc sends ETag and Last-Modified, answers conditional GETs
+*     with 304, and serves If-Range requests' ranges if they match
+*   - an encoded reply's ETag names its coding, see codedTag
+*   ver 1.7 : 17 Oct 2026
+*   - getProc negotiates Accept-Encoding, serving a precompressed .gz
+*     sibling if there is one, else compressing cached contents once
+*   - added compressReply, which HttpServer applies to other replies
+*   ver 1.6 : 17 Oct 2026
+*   - getProc answers Range requests with 206, one range as the body,
+*     several as multipart/byteranges, and 416 if none can be served
+*   ver 1.5 : 17 Oct 2026
+*   - added StreamProcessType, handlers that read the request body
+*     from an HttpBodyReader
+*   - added putProc, which writes a PUT's body to a file as it arrives
+*   ver 1.4 : 17 Oct 2026
+*   - added CoMessageProcessType, coroutine handlers
+*   ver 1.3 : 17 Oct 2026
+*   - getProc and postProc take the request by reference, matching
+*     MessageProcessType, so dispatching doesn't copy it
+*   ver 1.2 : 17 Oct 2026
+*   - getProc serves files from a FileCache, replies share the cached
+*     contents, files too large to cache are still sent from disk
+*   ver 1.1 : 17 Oct 2026
+*   - getProc replies with a file backed body, the file is sent by
+*     postMessage without being read into memory
 *   ver 1.0 : 07 Jan 2017
 *   - first release
 *
 */
 #include "../Message/Message.h"
 #include "../Utilities/Utilities.h"
+#include "../FileCache/FileCache.h"
+#include "../HttpCommCore/HttpCommCore.h"
+#include "../Compression/Compression.h"
+#include "Task.h"
 #include <functional>
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <ctime>
+#include <atomic>
 
 namespace HttpCommunication
 {
@@ -38,28 +95,457 @@ namespace HttpCommunication
   using ReplyMsg = HttpMessage<HttpReply>;
   using Key = std::string;
   using MessageProcessType = std::function < ReplyMsg(RequestMsg&)>;
+  using CoMessageProcessType = std::function < Task<ReplyMsg>(RequestMsg&)>;
+  using StreamProcessType = std::function < ReplyMsg(RequestMsg&, HttpBodyReader&)>;
+
+  /////////////////////////////////////////////////////////////////////
+  // fileCache: contents of files served by getProc
+  // - shared by all servers in the process
+  // - fileCache().capacity(0) turns caching off
+
+  inline FileCache& fileCache()
+  {
+    static FileCache cache;
+    return cache;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // rangeBoundary: separates the parts of multipart/byteranges replies
+  // - chosen at random once per process, so files are unlikely to
+  //   contain it
+
+  inline const std::string& rangeBoundary()
+  {
+    static const std::string boundary = []() {
+      std::random_device random;
+      std::ostringstream out;
+      out << "byteranges_" << std::hex << random() << random() << random();
+      return out.str();
+    }();
+    return boundary;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // rangeReply: makes reply a 206 with ranges of a file
+  // - one range is the body, with a Content-Range header.  Several are
+  //   parts of a multipart/byteranges body, each with its own.
+  // - cached contents are copied range by range.  An uncached file is
+  //   sent from an offset, or, for several ranges, streamed a chunk at
+  //   a time, reading each range with a seek, so none of the file
+  //   outside the ranges is read.
+
+  inline void rangeReply(
+    HttpMessage<HttpReply>& reply, const std::string& fileSpec, const FileCache::Buffer& contents,
+    size_t fileSize, const std::vector<ByteRange>& ranges
+  )
+  {
+    using byte = HttpMessageBody::byte;
+    reply.type().status(206);
+    if (ranges.size() == 1)
+    {
+      const ByteRange& range = ranges[0];
+      reply.attribute("Content-Range", range.contentRange(fileSize));
+      reply.contentLength(range.size());
+      if (contents)
+        reply.body().value().assign(contents->begin() + range.first, contents->begin() + range.last + 1);
+      else
+        reply.body().file(fileSpec, range.size(), range.first);
+      return;
+    }
+
+    // the body is a list of pieces, part headers held as text and
+    // ranges of the file, ending with the closing boundary
+
+    struct Piece
+    {
+      std::string text;   // if empty, bytes [offset, offset + size) of the file
+      size_t offset = 0;
+      size_t size = 0;
+    };
+    struct Parts
+    {
+      std::vector<Piece> pieces;
+      size_t index = 0;  // piece being sent
+      size_t pos = 0;    // bytes of it already sent
+      std::ifstream in;
+    };
+    auto parts = std::make_shared<Parts>();
+    size_t length = 0;
+    for (const ByteRange& range : ranges)
+    {
+      Piece head;
+      head.text = "\r\n--" + rangeBoundary() + "\r\nContent-Range: " + range.contentRange(fileSize) + "\r\n\r\n";
+      head.size = head.text.size();
+      Piece bytes;
+      bytes.offset = range.first;
+      bytes.size = range.size();
+      length += head.size + bytes.size;
+      parts->pieces.push_back(std::move(head));
+      parts->pieces.push_back(bytes);
+    }
+    Piece tail;
+    tail.text = "\r\n--" + rangeBoundary() + "--\r\n";
+    tail.size = tail.text.size();
+    length += tail.size;
+    parts->pieces.push_back(std::move(tail));
+    reply.attribute("Content-Type", "multipart/byteranges; boundary=" + rangeBoundary());
+
+    if (contents)
+    {
+      std::vector<byte>& body = reply.body().value();
+      body.reserve(length);
+      for (const Piece& piece : parts->pieces)
+      {
+        if (piece.text.empty())
+          body.insert(body.end(), contents->begin() + piece.offset, contents->begin() + piece.offset + piece.size);
+        else
+          body.insert(body.end(), piece.text.begin(), piece.text.end());
+      }
+      reply.contentLength(length);
+      return;
+    }
+
+    reply.stream([parts, fileSpec](byte* buffer, size_t size) -> size_t {
+      if (!parts->in.is_open())
+      {
+        parts->in.open(fileSpec, std::ios::binary);
+        if (!parts->in.good())
+          return HttpMessageBody::streamError;
+      }
+      size_t filled = 0;
+      while (filled < size && parts->index < parts->pieces.size())
+      {
+        const Piece& piece = parts->pieces[parts->index];
+        size_t bytes = (std::min)(size - filled, piece.size - parts->pos);
+        if (piece.text.empty())
+        {
+          parts->in.seekg(static_cast<std::streamoff>(piece.offset + parts->pos));
+          if (!parts->in.read(reinterpret_cast<char*>(buffer + filled), bytes))
+            return HttpMessageBody::streamError;  // file shrank since its size was read
+        }
+        else
+        {
+          std::memcpy(buffer + filled, piece.text.data() + parts->pos, bytes);
+        }
+        filled += bytes;
+        parts->pos += bytes;
+        if (parts->pos == piece.size)
+        {
+          ++parts->index;
+          parts->pos = 0;
+        }
+      }
+      return filled;
+    });
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // compressible: could a file's contents be made smaller?
+  // - formats that are already compressed aren't worth the time
+
+  inline bool compressible(const std::string& fileSpec)
+  {
+    static const char* compressed[] = {
+      ".gz", ".zip", ".7z", ".png", ".jpg", ".jpeg", ".gif", ".webp", ".ico",
+      ".mp3", ".mp4", ".webm", ".woff", ".woff2", ".pdf", ".docx"
+    };
+    size_t dot = fileSpec.find_last_of("./\\");
+    if (dot == std::string::npos || fileSpec[dot] != '.')
+      return true;
+    std::string_view extension = std::string_view(fileSpec).substr(dot);
+    for (const char* ext : compressed)
+    {
+      if (HttpParser::equalIgnoreCase(extension, ext))
+        return false;
+    }
+    return true;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // codedTag: entity tag of a file version's encoded representation
+  // - "xyz" encoded with gzip is "xyz-gzip", so each representation has
+  //   its own strong tag, as RFC 9110 requires
+
+  inline std::string codedTag(const std::string& etag, Compression::Coding coding)
+  {
+    if (etag.size() < 2 || coding == Compression::identity)
+      return etag;
+    return etag.substr(0, etag.size() - 1) + "-" + Compression::name(coding) + "\"";
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // addValidators: adds a file version's validators to reply, etag for
+  // the tag, which may be an encoding's
+  // - a tag or time that isn't known, empty or 0, isn't sent
+
+  inline void addValidators(HttpMessage<HttpReply>& reply, const std::string& etag, const FileCache::Version& version)
+  {
+    if (!etag.empty())
+      reply.attribute("ETag", etag);
+    if (version.lastModified != 0)
+    {
+      char date[Validator::dateChars];
+      reply.attribute("Last-Modified", std::string_view(date, Validator::httpDate(version.lastModified, date, sizeof(date))));
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // notModified: makes reply a 304 if msg shows the client already has
+  // the file's current version, else returns false
+  // - If-None-Match decides if it's present, and If-Modified-Since is
+  //   then ignored, as RFC 9110 orders them.  A tag of any encoding of
+  //   the version matches, they're all made from the same contents.
+  // - an If-Modified-Since date later than now is ignored
+  // - a 304 has no body and no content-length, its ETag, Last-Modified,
+  //   and Vary let the client update the copy it has
+
+  inline bool notModified(
+    HttpMessage<HttpRequest>& msg, HttpMessage<HttpReply>& reply, const FileCache::Version& version
+  )
+  {
+    std::string etag;
+    const std::string* ifNoneMatch = msg.attributes().find("If-None-Match");
+    if (ifNoneMatch != nullptr)
+    {
+      for (Compression::Coding coding : { Compression::identity, Compression::gzip, Compression::deflate })
+      {
+        std::string tag = codedTag(version.etag, coding);
+        if (Validator::matches(*ifNoneMatch, tag, false))
+        {
+          etag = tag;
+          break;
+        }
+      }
+      if (etag.empty())
+        return false;
+    }
+    else
+    {
+      const std::string* ifModifiedSince = msg.attributes().find("If-Modified-Since");
+      std::time_t since;
+      if (ifModifiedSince == nullptr || version.lastModified == 0 ||
+        !Validator::parseHttpDate(*ifModifiedSince, since) ||
+        since > std::time(nullptr) || version.lastModified > since)
+        return false;
+      etag = version.etag;
+    }
+    reply.type().status(304);
+    addValidators(reply, etag, version);
+    return true;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // rangeCurrent: does an If-Range header name the file's version?
+  // - an entity tag must match the file's tag strongly, a date must
+  //   be its Last-Modified exactly, else the whole file is sent
+
+  inline bool rangeCurrent(const std::string& ifRange, const FileCache::Version& version)
+  {
+    std::string_view value = Utilities::StringHelper::trimView(ifRange);
+    if (!value.empty() && (value[0] == '"' || value[0] == 'W'))
+      return Validator::matches(value, version.etag, true);
+    std::time_t date;
+    return version.lastModified != 0 && Validator::parseHttpDate(value, date) && date == version.lastModified;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // encodedFileReply: makes reply a file's contents, encoded as the
+  // request's Accept-Encoding asks, false if it isn't encoded
+  // - a precompressed sibling, foo.html.gz for foo.html, is sent as is,
+  //   whatever the file's size.  Whoever makes siblings keeps them
+  //   current, as with nginx's gzip_static.
+  // - otherwise cached contents are compressed once per version of the
+  //   file, and the result cached with them.  Files too large to cache
+  //   aren't compressed, give them a sibling.
+  // - contents that don't get smaller are sent as they are
+  // - an ETag already in reply becomes the encoding's, see codedTag
+
+  inline bool encodedFileReply(
+    const std::string& acceptEncoding, HttpMessage<HttpReply>& reply, const std::string& fileSpec,
+    const FileCache::Buffer& contents
+  )
+  {
+    FileCache::Buffer encoded;
+    size_t encodedSize = 0;
+    Compression::Coding coding = Compression::gzip;
+    if (Compression::quality(acceptEncoding, Compression::gzip) > 0 &&
+      fileCache().lookup(fileSpec + ".gz", encoded, encodedSize))
+    {
+      if (encoded)
+        reply.body().share(encoded);
+      else
+        reply.body().file(fileSpec + ".gz", encodedSize);
+    }
+    else
+    {
+      coding = Compression::negotiate(acceptEncoding);
+      if (coding == Compression::identity || !contents || !Compression::available())
+        return false;
+      encoded = fileCache().variant(fileSpec, contents, Compression::name(coding),
+        [coding](const std::vector<HttpMessageBody::byte>& bytes) -> FileCache::Buffer {
+          auto packed = std::make_shared<std::vector<HttpMessageBody::byte>>();
+          if (!Compression::compress(bytes.data(), bytes.size(), coding, *packed))
+            return nullptr;
+          return packed;
+        });
+      if (!encoded || encoded->size() >= contents->size())
+        return false;
+      encodedSize = encoded->size();
+      reply.body().share(encoded);
+    }
+    reply.attribute("Content-Encoding", Compression::name(coding));
+    const std::string* etag = reply.attributes().find("ETag");
+    if (etag != nullptr)
+      reply.attribute("ETag", codedTag(*etag, coding));
+    reply.contentLength(encodedSize);
+    reply.type().status(200);
+    return true;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // compressReply: encodes reply's body as msg's Accept-Encoding asks
+  // - for replies made per request, e.g., postProc's.  Those whose
+  //   bodies are shared, from a cache, or sent from a file or stream,
+  //   are left as they are, getProc encodes its own.
+  // - bodies smaller than minCompressSize, partial and unsuccessful
+  //   replies, and media types that are already compressed are sent as
+  //   they are, as is a body that doesn't get smaller
+
+  const size_t minCompressSize = 256;
+
+  inline void compressReply(HttpMessage<HttpRequest>& msg, HttpMessage<HttpReply>& reply)
+  {
+    const HttpMessageBody& body = reply.body();
+    size_t status = reply.type().status();
+    if (status < 200 || status >= 300 || status == 204 || status == 206 ||
+      body.isShared() || body.isFile() || body.isStream() || body.size() < minCompressSize ||
+      reply.containsKey("Content-Encoding"))
+      return;
+    const std::string* accept = msg.attributes().find("Accept-Encoding");
+    if (accept == nullptr)
+      return;
+    const std::string* type = reply.attributes().find("Content-Type");
+    if (type != nullptr && (type->compare(0, 6, "image/") == 0 || type->compare(0, 6, "video/") == 0 ||
+      type->compare(0, 6, "audio/") == 0 || type->find("zip") != std::string::npos))
+      return;
+    Compression::Coding coding = Compression::negotiate(*accept);
+    if (coding == Compression::identity)
+      return;
+    std::vector<HttpMessageBody::byte> packed;
+    if (!Compression::compress(body.value().data(), body.size(), coding, packed) || packed.size() >= body.size())
+      return;
+    reply.body().value().swap(packed);
+    reply.attribute("Content-Encoding", Compression::name(coding));
+    reply.attribute("Vary", "Accept-Encoding");
+    const std::string* etag = reply.attributes().find("ETag");
+    if (etag != nullptr)
+      reply.attribute("ETag", codedTag(*etag, coding));
+    reply.contentLength(reply.body().size());
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // localPath: file under the server's current directory named by a
+  //   request's path
+  // - false if path doesn't start with '/', holds a ':' or '\\', or
+  //   has a ".." segment, so it can't name a drive, share, stream, or
+  //   parent directory
+  // - the path, made absolute by GetFullPathNameA, must also lie under
+  //   the current directory, which rejects device names, e.g., /CON
+  // - fileSpec is the path relative to the current directory, "./..."
+
+  inline bool localPath(const std::string& path, std::string& fileSpec)
+  {
+    if (path.empty() || path[0] != '/' || path.find_first_of(":\\") != std::string::npos)
+      return false;
+    for (size_t pos = 1; pos <= path.size();)
+    {
+      size_t end = path.find('/', pos);
+      if (end == std::string::npos)
+        end = path.size();
+      if (path.compare(pos, end - pos, "..") == 0)
+        return false;
+      pos = end + 1;
+    }
+    char root[MAX_PATH];
+    char full[MAX_PATH];
+    DWORD rootLen = ::GetCurrentDirectoryA(MAX_PATH, root);
+    if (rootLen == 0 || rootLen >= MAX_PATH)
+      return false;
+    if (root[rootLen - 1] == '\\')
+      --rootLen;  // a drive root such as C:\ keeps its separator
+
+    fileSpec = "." + path;
+    DWORD fullLen = ::GetFullPathNameA(fileSpec.c_str(), MAX_PATH, full, NULL);
+    if (fullLen == 0 || fullLen >= MAX_PATH || fullLen < rootLen)
+      return false;
+    if (::_strnicmp(full, root, rootLen) != 0)
+      return false;
+    return fullLen == rootLen || full[rootLen] == '\\';
+  }
 
   /////////////////////////////////////////////////////////////////////
   // getProc: processing for GET message
+  // - a Range header asks for parts of the file, see rangeReply,
+  //   which are parts of the file as it is, not encoded
+  // - otherwise an Accept-Encoding header may get an encoded file,
+  //   see encodedFileReply
+  // - conditional requests for the version the client has get a 304,
+  //   see notModified, checked before Range, as RFC 9110 orders them
+  // - a Range with an If-Range that doesn't name the current version,
+  //   see rangeCurrent, gets the whole file
+  // - a path that could leave the server's directory, see localPath,
+  //   gets a 400
 
-  inline HttpMessage<HttpReply> getProc(HttpMessage<HttpRequest> msg)
+  inline HttpMessage<HttpReply> getProc(HttpMessage<HttpRequest>& msg)
   {
     HttpMessage<HttpReply> reply;
 
-    const size_t bufSize = 255;
-    char buffer[bufSize];
-    ::GetCurrentDirectoryA(bufSize, buffer);
-    std::string fileSpec = msg.type().fileSpec();
-    if (fileSpec[0] == '/')
-      fileSpec.insert(fileSpec.begin(), '.');
-    std::ifstream in(fileSpec);
-    if (in.good())
-    {
-      std::stringstream out;
-      out << in.rdbuf();
-      std::string& text = out.str();
-      reply.contentLength(text.size());
-      reply.body().load(text.size(), (HttpMessageBody::byte*)&text[0]);
+    std::string fileSpec;
+    if (!localPath(msg.type().fileSpec(), fileSpec))
+    {
+      reply.type().status(400);
+      reply.contentLength(0);
+      return reply;
+    }
+    FileCache::Buffer contents;
+    size_t fileSize;
+    FileCache::Version version;
+    if (fileCache().lookup(fileSpec, contents, fileSize, version))
+    {
+      reply.attribute("Accept-Ranges", "bytes");
+      bool negotiable = compressible(fileSpec);
+      if (negotiable)
+        reply.attribute("Vary", "Accept-Encoding");
+      if (notModified(msg, reply, version))
+        return reply;
+      addValidators(reply, version.etag, version);
+      const std::string* range = msg.attributes().find("Range");
+      const std::string* ifRange = msg.attributes().find("If-Range");
+      if (range != nullptr && (ifRange == nullptr || rangeCurrent(*ifRange, version)))
+      {
+        std::vector<ByteRange> ranges;
+        ByteRange::Status status = ByteRange::parse(*range, fileSize, ranges);
+        if (status == ByteRange::partial)
+        {
+          rangeReply(reply, fileSpec, contents, fileSize, ranges);
+          return reply;
+        }
+        if (status == ByteRange::unsatisfiable)
+        {
+          reply.type().status(416);
+          reply.attribute("Content-Range", ByteRange::unsatisfied(fileSize));
+          reply.contentLength(0);
+          return reply;
+        }
+      }
+      const std::string* accept = msg.attributes().find("Accept-Encoding");
+      if (negotiable && accept != nullptr && encodedFileReply(*accept, reply, fileSpec, contents))
+        return reply;
+      reply.contentLength(fileSize);
+      if (contents)
+        reply.body().share(contents);
+      else
+        reply.body().file(fileSpec, fileSize);  // too large to cache
       reply.type().status(200);
       return reply;
     }
@@ -71,7 +557,7 @@ namespace HttpCommunication
   /////////////////////////////////////////////////////////////////////
   // postProc: processing for POST message
 
-  inline HttpMessage<HttpReply> postProc(HttpMessage<HttpRequest> msg)
+  inline HttpMessage<HttpReply> postProc(HttpMessage<HttpRequest>& msg)
   {
     HttpMessage<HttpReply> reply;
 
@@ -80,6 +566,60 @@ namespace HttpCommunication
     reply.contentLength(17);
     return reply;
   }
+  /////////////////////////////////////////////////////////////////////
+  // putProc: processing for PUT message
+  // - the body is written to a temporary file as it's read, 64 KB at a
+  //   time, and the temporary replaces the target once it's complete,
+  //   so getProc never serves a partial upload
+  // - each upload has its own temporary, named for the process and a
+  //   count of uploads, so concurrent PUTs to one path compete only
+  //   in the final rename, and the last to finish wins
+  // - replies 201 if the file is new, 200 if it was replaced, 400 if
+  //   the path could leave the server's directory, see localPath, or
+  //   the upload is cut short
+
+  inline HttpMessage<HttpReply> putProc(HttpMessage<HttpRequest>& msg, HttpBodyReader& reader)
+  {
+    HttpMessage<HttpReply> reply;
+    reply.contentLength(0);
+
+    std::string fileSpec;
+    if (!localPath(msg.type().fileSpec(), fileSpec))
+    {
+      reply.type().status(400);
+      return reply;
+    }
+    static std::atomic<size_t> uploads = 0;
+    std::string tempSpec = fileSpec + "." + Utilities::Converter<size_t>::toString(::GetCurrentProcessId())
+      + "." + Utilities::Converter<size_t>::toString(++uploads) + ".part";
+
+    std::ofstream out(tempSpec, std::ios::binary | std::ios::trunc);
+    if (!out.good())
+    {
+      reply.type().status(500);
+      return reply;
+    }
+    std::vector<HttpMessageBody::byte> buffer(64 * 1024);
+    size_t bytes;
+    while ((bytes = reader.read(buffer.data(), buffer.size())) != 0 && bytes != HttpBodyReader::error)
+      out.write(reinterpret_cast<const char*>(buffer.data()), bytes);
+    out.close();
+    if (reader.failed() || !out)
+    {
+      ::DeleteFileA(tempSpec.c_str());
+      reply.type().status(reader.failed() ? 400 : 500);
+      return reply;
+    }
+    bool existed = ::GetFileAttributesA(fileSpec.c_str()) != INVALID_FILE_ATTRIBUTES;
+    if (!::MoveFileExA(tempSpec.c_str(), fileSpec.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+      ::DeleteFileA(tempSpec.c_str());
+      reply.type().status(500);
+      return reply;
+    }
+    reply.type().status(existed ? 200 : 201);
+    return reply;
+  }
   ////----< helper function for ClientHandler operator() >---------------
   ///*
   //*  - This function is provided by each application to define
@@ -0,0 +1,141 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// Task.h - lazily started coroutine returning a value                 //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package provides Task<T>, the return type of coroutine server
+*  handlers.  A function returning Task<T> may co_await other Tasks and
+*  the awaitables defined in EventLoop.h, and co_returns a T.
+*  - A Task doesn't run until it is awaited, or its owner calls
+*    resume() or get().
+*  - Awaiting a Task runs it, and resumes the awaiting coroutine when
+*    it co_returns, without going back through the owner.
+*  - get() runs the Task to completion on the calling thread.  The
+*    EventLoop awaitables don't suspend when no EventLoop is running
+*    the thread, they wait in place, so a coroutine handler can also be
+*    served by ClientHandler threads.
+*  - An exception leaving the coroutine is rethrown by result().
+*  - Task owns its coroutine frame, and is movable but not copyable.
+*
+*  Required Files:
+*  ---------------
+*  Task.h
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace HttpCommunication
+{
+  /////////////////////////////////////////////////////////////////////
+  // Task class
+  // - T must be movable
+
+  template <typename T>
+  class Task
+  {
+  public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    // resumes whoever awaited the finished Task, if anyone did
+
+    struct FinalAwaiter
+    {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(Handle handle) noexcept
+      {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+      }
+      void await_resume() noexcept {}
+    };
+
+    struct promise_type
+    {
+      std::optional<T> value;
+      std::exception_ptr error;
+      std::coroutine_handle<> continuation;
+
+      Task get_return_object() { return Task(Handle::from_promise(*this)); }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      FinalAwaiter final_suspend() noexcept { return {}; }
+      template <typename U>
+      void return_value(U&& u) { value.emplace(std::forward<U>(u)); }
+      void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task() = default;
+    Task(Task&& task) noexcept : handle_(std::exchange(task.handle_, nullptr)) {}
+    Task& operator=(Task&& task) noexcept;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (handle_) handle_.destroy(); }
+
+    bool valid() const { return static_cast<bool>(handle_); }
+    bool done() const { return !handle_ || handle_.done(); }
+    void resume() { handle_.resume(); }
+    std::coroutine_handle<> handle() const { return handle_; }
+    T result();
+    T get();
+
+    // awaiting a Task runs it, with the awaiter as its continuation
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      handle_.promise().continuation = awaiter;
+      return handle_;
+    }
+    T await_resume() { return result(); }
+  private:
+    explicit Task(Handle handle) : handle_(handle) {}
+    Handle handle_ = nullptr;
+  };
+  //----< move assignment destroys frame this Task owned >-------------
+
+  template <typename T>
+  Task<T>& Task<T>::operator=(Task&& task) noexcept
+  {
+    if (this != &task)
+    {
+      if (handle_)
+        handle_.destroy();
+      handle_ = std::exchange(task.handle_, nullptr);
+    }
+    return *this;
+  }
+  //----< value of a finished Task, rethrowing its exception >---------
+
+  template <typename T>
+  T Task<T>::result()
+  {
+    promise_type& promise = handle_.promise();
+    if (promise.error)
+      std::rethrow_exception(promise.error);
+    return std::move(*promise.value);
+  }
+  //----< run Task to completion on this thread >----------------------
+  /*
+  *  - awaitables that can't complete in place would leave the Task
+  *    suspended, so get() is only for threads no EventLoop runs
+  */
+  template <typename T>
+  T Task<T>::get()
+  {
+    if (!done())
+      resume();
+    return result();
+  }
+}
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.cpp - Thread-safe Blocking Queue      //
-// ver 1.1                                                   //
+// ver 1.2                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2013 //
 ///////////////////////////////////////////////////////////////
 
@@ -77,6 +77,20 @@ int main()
   q.enQ(msg);
   std::cout << "\n  q3 element = " << q3.deQ() << "\n";
 
+  std::cout << "\n  Bounded BlockingQueue";
+  std::cout << "\n -----------------------";
+  BlockingQueue<std::string> bq(2);
+  for (int i = 0; i < 3; ++i)
+  {
+    std::string item = "item#" + std::to_string(i);
+    bool accepted = bq.tryEnQ(std::move(item));
+    std::cout << "\n  tryEnQ item#" << i << (accepted ? " accepted" : " refused, queue full");
+  }
+  std::cout << "\n  bq.size() = " << bq.size() << ", bq.capacity() = " << bq.capacity();
+  std::cout << "\n  bq element = " << bq.deQ();
+  std::cout << "\n  tryEnQ after deQ " << (bq.tryEnQ("item#3") ? "accepted" : "refused");
+  std::cout << "\n";
+
   std::cout << "\n\n";
 }
 
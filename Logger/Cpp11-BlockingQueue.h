@@ -2,7 +2,7 @@
 #define CPP11_BLOCKINGQUEUE_H
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.h - Thread-safe Blocking Queue        //
-// ver 1.1                                                   //
+// ver 1.2                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
 ///////////////////////////////////////////////////////////////
 /*
@@ -13,6 +13,9 @@
  * It is implemented using C++11 threading constructs including 
  * std::condition_variable and std::mutex.  The underlying storage
  * is provided by the non-thread-safe std::queue<T>.
+ * A queue constructed with a capacity is bounded: tryEnQ refuses items
+ * when it is full, so producers can shed load instead of piling it up.
+ * enQ ignores the bound.
  *
  * Required Files:
  * ---------------
@@ -24,6 +27,10 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.2 : 17 Oct 2026
+ * - added optional capacity and tryEnQ for bounded queues
+ * - added enQ(T&&), and deQ moves items out, so move-only types,
+ *   e.g., Sockets, can be queued
  * ver 1.1 : 26 Jan 2015
  * - added copy constructor and assignment operator
  * ver 1.0 : 03 Mar 2014
@@ -46,19 +53,24 @@ template <typename T>
 class BlockingQueue {
 public:
   BlockingQueue() {}
+  explicit BlockingQueue(size_t capacity) : capacity_(capacity) {}
   BlockingQueue(const BlockingQueue<T>&);
   BlockingQueue<T>& operator=(const BlockingQueue<T>&);
   T deQ();
   void enQ(const T& t);
+  void enQ(T&& t);
+  bool tryEnQ(T&& t);
   size_t size();
+  size_t capacity() const { return capacity_; }
 private:
   std::queue<T> q_;
+  size_t capacity_ = 0;  // zero means unbounded
   std::mutex mtx_;
   std::condition_variable cv_;
 };
 
 template<typename T>
-BlockingQueue<T>::BlockingQueue(const BlockingQueue<T>& bq) : q_(bq.q_)
+BlockingQueue<T>::BlockingQueue(const BlockingQueue<T>& bq) : q_(bq.q_), capacity_(bq.capacity_)
 {
   /* can't copy mutex or condition variable, so use default members */
 }
@@ -68,6 +80,7 @@ BlockingQueue<T>& BlockingQueue<T>::operator=(const BlockingQueue<T>& bq)
 {
   if (this == &bq) return *this;
   q_ = bq.q_;
+  capacity_ = bq.capacity_;
   /* can't assign mutex or condition variable so use target's */
   return *this;
 }
@@ -78,7 +91,7 @@ T BlockingQueue<T>::deQ()
   std::unique_lock<std::mutex> l(mtx_);
   if(q_.size() > 0)
   {
-    T temp = q_.front();
+    T temp = std::move(q_.front());
     q_.pop();
     return temp;
   }
@@ -86,7 +99,7 @@ T BlockingQueue<T>::deQ()
 
   while (q_.size() == 0)
     cv_.wait(l, [this] () { return q_.size() > 0; });
-  T temp = q_.front();
+  T temp = std::move(q_.front());
   q_.pop();
   return temp;
 }
@@ -101,6 +114,32 @@ void BlockingQueue<T>::enQ(const T& t)
   cv_.notify_one();
 }
 
+template<typename T>
+void BlockingQueue<T>::enQ(T&& t)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    q_.push(std::move(t));
+  }
+  cv_.notify_one();
+}
+//----< enqueue unless bounded queue is full >-----------------------
+/*
+ * - t is moved from only if it was enqueued
+ */
+template<typename T>
+bool BlockingQueue<T>::tryEnQ(T&& t)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    if (capacity_ > 0 && q_.size() >= capacity_)
+      return false;
+    q_.push(std::move(t));
+  }
+  cv_.notify_one();
+  return true;
+}
+
 template<typename T>
 size_t BlockingQueue<T>::size()
 {
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 // Logger.cpp - log text messages to std::ostream                  //
-// ver 1.0                                                         //
+// ver 1.3                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -12,20 +12,150 @@
 /////////////////////////////////////////////////////////////////////
 
 #include <functional>
+#include <chrono>
+#include <charconv>
+#include <cstdio>
 #include "Logger.h"
 #include "../Utilities/Utilities.h"
 
+/////////////////////////////////////////////////////////////////////
+// LogRecord methods
+
+//----< copy text argument into record, truncating if it won't fit >-
+
+void LogRecord::add(std::string_view text)
+{
+  if (count_ == maxArgs)
+    return;
+  size_t size = text.size();
+  if (size > textCapacity - textUsed_)
+    size = textCapacity - textUsed_;
+  text.copy(text_ + textUsed_, size);
+  types_[count_] = chars;
+  args_[count_].t.offset = static_cast<unsigned short>(textUsed_);
+  args_[count_].t.size = static_cast<unsigned short>(size);
+  textUsed_ += size;
+  ++count_;
+}
+//----< append formatted text, each {} replaced by next argument >---
+
+void LogRecord::format(std::string& out) const
+{
+  if (format_ == nullptr)
+  {
+    out += message_;
+    return;
+  }
+  size_t next = 0;
+  for (const char* pCh = format_; *pCh != '\0'; ++pCh)
+  {
+    if (pCh[0] != '{' || pCh[1] != '}' || next == count_)
+    {
+      out += *pCh;
+      continue;
+    }
+    ++pCh;
+    const Arg& arg = args_[next];
+    char buffer[32];
+    switch (types_[next++])
+    {
+    case signedInt:
+      out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), arg.i).ptr);
+      break;
+    case unsignedInt:
+      out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), arg.u).ptr);
+      break;
+    case real:
+      out.append(buffer, std::snprintf(buffer, sizeof(buffer), "%g", arg.d));
+      break;
+    case chars:
+      out.append(text_ + arg.t.offset, arg.t.size);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+// Logger methods
+
+//----< queue record, waiting for room if the queue is full >--------
+
+void Logger::enQ(LogRecord&& record)
+{
+  while (!_queue.tryEnQ(std::move(record)))
+  {
+    if (!_ThreadRunning)
+      return;
+    std::this_thread::yield();
+  }
+  wake();
+}
 //----< send text message to std::ostream >--------------------------
 
 void Logger::write(const std::string& msg)
 {
   if(_ThreadRunning)
-    _queue.enQ(msg);
+    enQ(LogRecord(std::string(msg)));
+}
+//----< send text message to std::ostream, moving it into queue >----
+
+void Logger::write(std::string&& msg)
+{
+  if (_ThreadRunning)
+    enQ(LogRecord(std::move(msg)));
 }
 void Logger::title(const std::string& msg, char underline)
 {
   std::string temp = "\n  " + msg + "\n " + std::string(msg.size() + 2, underline);
-  write(temp);
+  write(std::move(temp));
+}
+//----< wake logging thread if it is waiting for messages >----------
+/*
+*  - the fence orders the caller's enqueue before reading _sleeping,
+*    matching the fence in run(), so either the logging thread sees
+*    the message or the caller sees it sleeping
+*/
+void Logger::wake()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (_sleeping.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _cv.notify_one();
+  }
+}
+//----< logging thread: write queued messages in batches >-----------
+
+void Logger::run()
+{
+  std::string batch;
+  LogRecord record;
+  while (true)
+  {
+    bool stopping = _stopRequested;  // read first, so the drain sees all
+                                     // messages queued before stop()
+    batch.clear();
+    while (batch.size() < maxBatch && _queue.tryDeQ(record))
+      record.format(batch);
+    if (!batch.empty())
+    {
+      _pOut->write(batch.data(), batch.size());
+      _pOut->flush();
+      ++_batches;
+      continue;
+    }
+    if (stopping)
+      break;
+
+    std::unique_lock<std::mutex> lock(_mtx);
+    _sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_queue.empty() && !_stopRequested)
+      _cv.wait_for(lock, std::chrono::milliseconds(100));
+    _sleeping.store(false, std::memory_order_relaxed);
+  }
 }
 //----< attach logger to existing std::ostream >---------------------
 
@@ -39,34 +169,28 @@ void Logger::start()
 {
   if (_ThreadRunning)
     return;
+  _stopRequested = false;
   _ThreadRunning = true;
-  std::function<void()> tp = [=]() {
-    while (true)
-    {
-      std::string msg = _queue.deQ();
-      if (msg == "quit")
-      {
-        _ThreadRunning = false;
-        break;
-      }
-      *_pOut << msg;
-    }
-  };
-  std::thread thr(tp);
-  thr.detach();
+  _thread = std::thread([this]() { run(); });
 }
 //----< stop logging >-----------------------------------------------
-
+/*
+*  - returns after queued messages have been written
+*/
 void Logger::stop(const std::string& msg)
 {
   if (_ThreadRunning)
   {
     if(msg != "")
       write(msg);
-    write("quit");  // request thread to stop
-    while (_ThreadRunning)
-      /* wait for thread to stop*/
-      ;
+    _ThreadRunning = false;  // later writes are ignored
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      _stopRequested = true;
+      _cv.notify_one();
+    }
+    if (_thread.joinable())
+      _thread.join();
   }
 }
 //----< stop logging thread >----------------------------------------
@@ -100,6 +224,9 @@ int main()
   log.write("\n  won't get logged - stopped");
   log.start();
   log.write("\n  starting again");
+  log.log("\n  record with {} arguments: {}, {}, \"{}\"", 4, -42, 2.5, std::string("text"));
+  log.log("\n  unmatched {} and extra arguments", "placeholder", 1, 2);
+  log.log("\n  more placeholders than arguments: {} {}", 1);
   log.write("\n  and stopping again");
   log.stop("\n  terminating now");
 
@@ -110,6 +237,19 @@ int main()
   StaticLogger<1>::write("\n  static logger at work");
   Logger& logger = StaticLogger<1>::instance();
   logger.write("\n  static logger still at work");
+
+  StaticLogger<1>::title("Testing log levels");
+  StaticLogger<1>::write("\n  compiled log level is " + std::to_string(LOG_LEVEL));
+  StaticLogger<1>::error("\n  error is written, code {}", 42);
+  StaticLogger<1>::info("\n  info is written unless LOG_LEVEL < 2");
+  StaticLogger<1>::debug("\n  debug is written only if LOG_LEVEL is 3");
+  size_t evaluated = 0;
+  if (StaticLogger<1>::enabled<LogLevel::debug>())
+    StaticLogger<1>::debug("\n  guarded debug message {}", ++evaluated);
+  StaticLogger<1>::log("\n  guarded argument evaluated {} times", evaluated);
+  StaticLogger<1>::level(LogLevel::warning);
+  StaticLogger<1>::info("\n  info isn't written after level(LogLevel::warning)");
+  StaticLogger<1>::warning("\n  warning is still written");
   logger.stop("\n  stopping static logger");
 }
 
@@ -2,7 +2,7 @@
 #define LOGGER_H
 /////////////////////////////////////////////////////////////////////
 // Logger.h - log text messages to std::ostream                    //
-// ver 1.0                                                         //
+// ver 1.3                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -17,17 +17,52 @@
 * -------------------
 * This package supports logging for multiple concurrent clients to a
 * single std::ostream.  It does this be enqueuing messages in a
-* blocking queue and dequeuing with a single thread that writes to
+* lock-free queue and dequeuing with a single thread that writes to
 * the std::ostream.
+* - Writers never take a lock unless the logging thread is asleep and
+*   must be woken.  If the queue is full they yield until it isn't.
+* - The logging thread writes everything queued, up to maxBatch bytes,
+*   with one write and flush to the std::ostream.
+* - stop() waits for queued messages to be written and the logging
+*   thread to exit.
+* - log(format, args...) queues a LogRecord holding the format and the
+*   raw argument values.  Text is formatted on the logging thread, so
+*   callers don't build strings and, unless the queue is full, don't
+*   allocate.  The format must be a string literal, each {} in it is
+*   replaced by the next argument, e.g.,
+*     Show::log("\n  -- bind failed with error: {}", error);
+* - Messages may be given a LogLevel: error, warning, info, or debug,
+*   e.g., Show::debug("\n  -- Listen port = {}", port).  A level is
+*   written if it is no more verbose than both LOG_LEVEL, fixed when
+*   compiling, and the logger's level(), set at run time.  Levels
+*   above LOG_LEVEL compile to nothing.  Arguments are still evaluated
+*   unless the call is guarded with enabled<level>(), so do that for
+*   arguments that are costly to compute.
+* - LOG_LEVEL defaults to debug when _DEBUG is defined, and to info
+*   otherwise.  Define it as 0 to 3 to choose another level.  Messages
+*   without a level, from write(...) and log(...), are always written.
 *
 * Build Process:
 * --------------
-* Required Files: Logger.h, Logger.cpp, Utilities.h, Utilities.cpp
+* Required Files: Logger.h, Logger.cpp, MpscQueue.h,
+*                 Utilities.h, Utilities.cpp
 *
 * Build Command: devenv logger.sln /rebuild debug
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 17 Oct 2026
+* - added LogLevel with compile time and run time filtering, and
+*   error, warning, info, and debug methods to StaticLogger
+* ver 1.2 : 17 Oct 2026
+* - added log(format, args...) and LogRecord, messages are queued as
+*   records and formatted by the logging thread
+* ver 1.1 : 17 Oct 2026
+* - messages are queued in a lock-free MpscQueue instead of a
+*   BlockingQueue, and written in batches
+* - stop() joins the logging thread instead of spinning on a flag, and
+*   no longer stops on a message that happens to be "quit"
+* - added write(std::string&&), so temporaries are moved into the queue
 * ver 1.0 : 22 Feb 2016
 * - first release
 *
@@ -39,7 +74,95 @@
 #include <iostream>
 #include <string>
 #include <thread>
-#include "Cpp11-BlockingQueue.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string_view>
+#include <type_traits>
+#include "MpscQueue.h"
+
+/////////////////////////////////////////////////////////////////////
+// LogLevel
+// - levels are ordered from least to most verbose
+// - LOG_LEVEL is the most verbose level compiled into a program
+
+enum class LogLevel { error, warning, info, debug };
+
+#ifndef LOG_LEVEL
+#ifdef _DEBUG
+#define LOG_LEVEL 3
+#else
+#define LOG_LEVEL 2
+#endif
+#endif
+
+constexpr LogLevel compiledLogLevel = static_cast<LogLevel>(LOG_LEVEL);
+
+/////////////////////////////////////////////////////////////////////
+// LogRecord class
+// - fixed size record of a log call: a format with static storage
+//   duration and up to maxArgs argument values
+// - text arguments are copied into the record, truncated to fit its
+//   textCapacity bytes, numbers are stored as they are
+// - a record made from a string by write(...) holds that string as its
+//   message instead
+
+class LogRecord
+{
+public:
+  static const size_t maxArgs = 4;
+  static const size_t textCapacity = 96;
+
+  LogRecord(const char* format = nullptr) : format_(format) {}
+  LogRecord(std::string&& message) : message_(std::move(message)) {}
+  template <typename T>
+  void add(const T& arg);
+  void add(std::string_view text);
+  void add(const char* text) { add(std::string_view(text)); }
+  void add(const std::string& text) { add(std::string_view(text)); }
+  void format(std::string& out) const;
+private:
+  enum ArgType : unsigned char { none, signedInt, unsignedInt, real, chars };
+  union Arg
+  {
+    long long i;
+    unsigned long long u;
+    double d;
+    struct { unsigned short offset, size; } t;   // slice of text_
+  };
+  const char* format_ = nullptr;
+  std::string message_;
+  ArgType types_[maxArgs] = { none, none, none, none };
+  Arg args_[maxArgs];
+  size_t count_ = 0;
+  size_t textUsed_ = 0;
+  char text_[textCapacity];
+};
+//----< store number, arguments past maxArgs are ignored >-----------
+
+template <typename T>
+void LogRecord::add(const T& arg)
+{
+  static_assert(std::is_arithmetic<T>::value, "log arguments must be numbers or text");
+  if (count_ == maxArgs)
+    return;
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    types_[count_] = real;
+    args_[count_].d = arg;
+  }
+  else if constexpr (std::is_signed<T>::value)
+  {
+    types_[count_] = signedInt;
+    args_[count_].i = arg;
+  }
+  else
+  {
+    types_[count_] = unsignedInt;
+    args_[count_].u = arg;
+  }
+  ++count_;
+}
 
 class Logger
 {
@@ -49,16 +172,45 @@ public:
   void start();
   void stop(const std::string& msg = "");
   void write(const std::string& msg);
+  void write(std::string&& msg);
+  template <size_t N, typename... Args>
+  void log(const char (&format)[N], const Args&... args);
   void title(const std::string& msg, char underline = '-');
+  void level(LogLevel level) { _level = level; }
+  LogLevel level() const { return _level; }
+  size_t batches() const { return _batches; }
   ~Logger();
   Logger(const Logger&) = delete;
   Logger& operator=(const Logger&) = delete;
+  static const size_t maxBatch = 64 * 1024;
 private:
-  std::thread* _pThr;
-  std::ostream* _pOut;
-  BlockingQueue<std::string> _queue;
-  bool _ThreadRunning = false;
+  void enQ(LogRecord&& record);
+  void wake();
+  void run();
+
+  std::thread _thread;
+  std::ostream* _pOut = &std::cout;
+  MpscQueue<LogRecord> _queue;
+  std::atomic<bool> _ThreadRunning = false;
+  std::atomic<bool> _stopRequested = false;
+  std::atomic<bool> _sleeping = false;    // logging thread waits on _cv
+  std::atomic<size_t> _batches = 0;       // writes to _pOut
+  std::atomic<LogLevel> _level = compiledLogLevel;
+  std::mutex _mtx;
+  std::condition_variable _cv;
 };
+//----< queue record of format and args, formatted when written >----
+
+template <size_t N, typename... Args>
+void Logger::log(const char (&format)[N], const Args&... args)
+{
+  static_assert(sizeof...(Args) <= LogRecord::maxArgs, "too many log arguments");
+  if (!_ThreadRunning)
+    return;
+  LogRecord record(format);
+  (record.add(args), ...);
+  enQ(std::move(record));
+}
 
 template<int i>
 class StaticLogger
@@ -68,7 +220,24 @@ public:
   static void start() { _logger.start(); }
   static void stop(const std::string& msg="") { _logger.stop(msg); }
   static void write(const std::string& msg) { _logger.write(msg); }
+  static void write(std::string&& msg) { _logger.write(std::move(msg)); }
+  template <size_t N, typename... Args>
+  static void log(const char (&format)[N], const Args&... args) { _logger.log(format, args...); }
   static void title(const std::string& msg, char underline = '-') { _logger.title(msg, underline); }
+  static void level(LogLevel level) { _logger.level(level); }
+  static LogLevel level() { return _logger.level(); }
+  template <LogLevel L>
+  static bool enabled();
+  template <LogLevel L, size_t N, typename... Args>
+  static void log(const char (&format)[N], const Args&... args);
+  template <size_t N, typename... Args>
+  static void error(const char (&format)[N], const Args&... args) { log<LogLevel::error>(format, args...); }
+  template <size_t N, typename... Args>
+  static void warning(const char (&format)[N], const Args&... args) { log<LogLevel::warning>(format, args...); }
+  template <size_t N, typename... Args>
+  static void info(const char (&format)[N], const Args&... args) { log<LogLevel::info>(format, args...); }
+  template <size_t N, typename... Args>
+  static void debug(const char (&format)[N], const Args&... args) { log<LogLevel::debug>(format, args...); }
   static Logger& instance() { return _logger; }
   StaticLogger(const StaticLogger&) = delete;
   StaticLogger& operator=(const StaticLogger&) = delete;
@@ -79,4 +248,28 @@ private:
 template<int i>
 Logger StaticLogger<i>::_logger;
 
+//----< will messages of level L be written? >-----------------------
+
+template<int i>
+template <LogLevel L>
+bool StaticLogger<i>::enabled()
+{
+  if constexpr (L > compiledLogLevel)
+    return false;
+  else
+    return L <= _logger.level();
+}
+//----< queue record if level L is enabled, else compiles to nothing >
+
+template<int i>
+template <LogLevel L, size_t N, typename... Args>
+void StaticLogger<i>::log(const char (&format)[N], const Args&... args)
+{
+  if constexpr (L <= compiledLogLevel)
+  {
+    if (L <= _logger.level())
+      _logger.log(format, args...);
+  }
+}
+
 #endif
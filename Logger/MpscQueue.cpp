@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////
+// MpscQueue.cpp - bounded lock-free multi-producer queue    //
+// ver 1.0                                                   //
+// Application: OOD Projects                                 //
+// Platform:    Visual Studio 2019, Windows 10 pro           //
+///////////////////////////////////////////////////////////////
+
+#include "MpscQueue.h"
+
+#ifdef TEST_MPSCQUEUE
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+
+int main()
+{
+  std::cout << "\n  Demonstrating lock-free MpscQueue";
+  std::cout << "\n ===================================";
+
+  MpscQueue<std::string> q(5);
+  std::cout << "\n\n  capacity 5 rounds up to " << q.capacity();
+  size_t accepted = 0;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    if (q.tryEnQ("item #" + std::to_string(i)))
+      ++accepted;
+  }
+  std::cout << "\n  enqueued " << accepted << " of 10 items";
+  std::string item;
+  while (q.tryDeQ(item))
+    std::cout << "\n  deQed " << item;
+
+  std::cout << "\n\n  8 producers, one consumer:";
+  const size_t numProducers = 8;
+  const size_t perProducer = 100000;
+  MpscQueue<size_t> numbers(1024);
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < numProducers; ++p)
+  {
+    producers.push_back(std::thread([&numbers, p]() {
+      for (size_t i = 0; i < perProducer; ++i)
+      {
+        while (!numbers.tryEnQ(p * perProducer + i))
+          std::this_thread::yield();
+      }
+    }));
+  }
+  std::vector<size_t> next(numProducers, 0);
+  size_t received = 0, outOfOrder = 0, n;
+  while (received < numProducers * perProducer)
+  {
+    if (!numbers.tryDeQ(n))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    size_t p = n / perProducer;
+    if (n % perProducer != next[p]++)
+      ++outOfOrder;  // each producer's items must arrive in order
+    ++received;
+  }
+  for (auto& producer : producers)
+    producer.join();
+  std::cout << "\n  received " << received << " items, " << outOfOrder << " out of order, queue "
+    << (numbers.empty() ? "empty" : "not empty");
+  std::cout << "\n\n";
+}
+
+#endif
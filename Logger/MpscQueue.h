@@ -0,0 +1,152 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+///////////////////////////////////////////////////////////////
+// MpscQueue.h - bounded lock-free multi-producer queue      //
+// ver 1.0                                                   //
+// Application: OOD Projects                                 //
+// Platform:    Visual Studio 2019, Windows 10 pro           //
+///////////////////////////////////////////////////////////////
+/*
+ * Package Operations:
+ * -------------------
+ * This package contains one thread-safe class: MpscQueue<T>.
+ * Any number of threads may enqueue, but only one thread may
+ * dequeue.  It serves the same purpose as BlockingQueue<T> for
+ * a single consumer, without taking a lock per item.
+ * - Items are held in a ring of cells allocated once, whose
+ *   capacity is rounded up to a power of two.
+ * - Each cell has a sequence number telling producers when it is
+ *   free and the consumer when it is full, so producers only
+ *   contend on one atomic position, with compare-exchange.
+ * - Neither side blocks.  tryEnQ returns false when the ring is
+ *   full and tryDeQ returns false when it is empty.  Callers
+ *   decide whether to wait, e.g., the Logger's consumer sleeps
+ *   until a producer wakes it.
+ *
+ * Required Files:
+ * ---------------
+ * MpscQueue.h
+ *
+ * Maintenance History:
+ * --------------------
+ * ver 1.0 : 17 Oct 2026
+ * - first release
+ */
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+template <typename T>
+class MpscQueue {
+public:
+  explicit MpscQueue(size_t capacity = 8192);
+  MpscQueue(const MpscQueue<T>&) = delete;
+  MpscQueue<T>& operator=(const MpscQueue<T>&) = delete;
+  bool tryEnQ(const T& t);
+  bool tryEnQ(T&& t);
+  bool tryDeQ(T& t);
+  bool empty() const;
+  size_t capacity() const { return mask_ + 1; }
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+  template <typename U>
+  bool enQ(U&& u);
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> enQPos_;  // next cell a producer claims
+  alignas(64) size_t deQPos_;               // next cell the consumer reads
+};
+//----< allocate ring of at least capacity cells >---------------------
+
+template<typename T>
+MpscQueue<T>::MpscQueue(size_t capacity) : enQPos_(0), deQPos_(0)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size *= 2;
+  cells_.reset(new Cell[size]);
+  for (size_t i = 0; i < size; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  mask_ = size - 1;
+}
+//----< claim a free cell, fill it, then publish it to the consumer >--
+/*
+ * - a cell is free when its sequence equals the position claiming it,
+ *   and full when its sequence is one more
+ */
+template<typename T>
+template<typename U>
+bool MpscQueue<T>::enQ(U&& u)
+{
+  size_t pos = enQPos_.load(std::memory_order_relaxed);
+  while (true)
+  {
+    Cell& cell = cells_[pos & mask_];
+    size_t seq = cell.sequence.load(std::memory_order_acquire);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+    if (diff == 0)
+    {
+      if (enQPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        cell.value = std::forward<U>(u);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+    {
+      return false;  // consumer hasn't emptied this cell, ring is full
+    }
+    else
+    {
+      pos = enQPos_.load(std::memory_order_relaxed);  // another producer took it
+    }
+  }
+}
+//----< enqueue copy of t unless ring is full >------------------------
+
+template<typename T>
+bool MpscQueue<T>::tryEnQ(const T& t)
+{
+  return enQ(t);
+}
+//----< enqueue t unless ring is full >--------------------------------
+/*
+ * - t is moved from only if it was enqueued
+ */
+template<typename T>
+bool MpscQueue<T>::tryEnQ(T&& t)
+{
+  return enQ(std::move(t));
+}
+//----< move oldest item into t, consumer thread only >----------------
+
+template<typename T>
+bool MpscQueue<T>::tryDeQ(T& t)
+{
+  Cell& cell = cells_[deQPos_ & mask_];
+  size_t seq = cell.sequence.load(std::memory_order_acquire);
+  if (seq != deQPos_ + 1)
+    return false;
+  t = std::move(cell.value);
+  cell.sequence.store(deQPos_ + mask_ + 1, std::memory_order_release);
+  ++deQPos_;
+  return true;
+}
+//----< is there nothing to dequeue, consumer thread only >------------
+
+template<typename T>
+bool MpscQueue<T>::empty() const
+{
+  const Cell& cell = cells_[deQPos_ & mask_];
+  return cell.sequence.load(std::memory_order_acquire) != deQPos_ + 1;
+}
+
+#endif
@@ -6,6 +6,10 @@
 
 #include "Message.h"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 
 using namespace HttpCommunication;
 using SUtils = Utilities::StringHelper;
@@ -32,17 +36,17 @@ HttpRequest::HttpRequest(HttpCommand command, const std::string& fileSpec)
 HttpRequest HttpRequest::fromString(const std::string& commStr)
 {
   HttpRequest cmd;
-  std::vector<std::string> splits = Utilities::StringHelper::split(commStr, ' ');
-  std::string cmdStr;
+  std::vector<std::string_view> splits;
+  Utilities::StringHelper::splitView(commStr, ' ', splits);
   if (splits.size() > 1)
   {
-    cmdStr = Utilities::StringHelper::trim(splits[0]);
+    std::string_view cmdStr = splits[0];
     if (cmdStr == "GET") cmd.cmd_ = GET;
     if (cmdStr == "PUT") cmd.cmd_ = PUT;
     if (cmdStr == "POST") cmd.cmd_ = POST;
     if (cmdStr == "DELETE") cmd.cmd_ = DELETE;
     if (cmdStr == "HEAD") cmd.cmd_ = HEAD;
-    cmd.fileSpec_ = Utilities::StringHelper::trim(splits[1]);
+    cmd.fileSpec_.assign(splits[1]);
   }
   else
   {
@@ -51,7 +55,20 @@ HttpRequest HttpRequest::fromString(const std::string& commStr)
   }
   return cmd;
 }
+//----< HttpRequest from start line of parsed header >-----------------
 
+HttpRequest HttpRequest::fromParser(const HttpParser& parser)
+{
+  HttpRequest cmd;
+  std::string_view cmdStr = parser.word(0);
+  if (cmdStr == "GET") cmd.cmd_ = GET;
+  if (cmdStr == "PUT") cmd.cmd_ = PUT;
+  if (cmdStr == "POST") cmd.cmd_ = POST;
+  if (cmdStr == "DELETE") cmd.cmd_ = DELETE;
+  if (cmdStr == "HEAD") cmd.cmd_ = HEAD;
+  cmd.fileSpec_.assign(parser.word(1));
+  return cmd;
+}
 //----< return command string >----------------------------------------
 
 std::string HttpRequest::toString(bool full) const
@@ -100,7 +117,7 @@ void HttpRequest::command(HttpCommand cmd)
 }
 //----< return command's file specification >--------------------------
 
-std::string HttpRequest::fileSpec() const
+const std::string& HttpRequest::fileSpec() const
 {
   return fileSpec_;
 }
@@ -131,28 +148,55 @@ void HttpReply::status(size_t status)
 {
   status_ = status;
 }
+//----< status messages, shared by all replies >------------------------
+
+const HttpReply::StatusType& HttpReply::statusType()
+{
+  static const StatusType types {
+    {100, "info"}, {200, "OK"}, {201, "created"}, {206, "partial content"},
+    {300, "redirect"}, {304, "not modified"}, {400, "error"}, {404, "not found"},
+    {413, "payload too large"}, {416, "range not satisfiable"}, {500, "server error"},
+    {503, "service unavailable"}
+  };
+  return types;
+}
 //----< get status message >-------------------------------------------
 
 std::string HttpReply::message() const
 {
-  auto iter = statusType.find(status_);
-  if(iter != statusType.end())
+  auto iter = statusType().find(status_);
+  if(iter != statusType().end())
     return iter->second;
   return "";
 }
+//----< may a reply with this status have a body? >--------------------
+/*
+*  - 1xx, 204, and 304 replies end with their headers, whatever their
+*    content-length says
+*/
+bool HttpReply::bodyAllowed() const
+{
+  return status_ >= 200 && status_ != 204 && status_ != 304;
+}
 //----< convert to string >--------------------------------------------
 
 std::string HttpReply::toString() const
 {
-  std::string statusStr = Utilities::Converter<size_t>::toString(status_);
-  return "HTTP/1.1 " + statusStr + " " + message();
+  std::string text = message();
+  char buffer[Utilities::Converter<size_t>::maxChars];
+  size_t length = Utilities::Converter<size_t>::toChars(status_, buffer, sizeof(buffer));
+  std::string statusLine;
+  statusLine.reserve(10 + length + text.size());
+  statusLine.append("HTTP/1.1 ").append(buffer, length).append(1, ' ').append(text);
+  return statusLine;
 }
 //----< convert string representation to HttpReply instance >----------
 
 HttpReply HttpReply::fromString(const std::string& cmdStr)
 {
   HttpReply reply;
-  std::vector<std::string> splits = Utilities::StringHelper::split(cmdStr, ' ');
+  std::vector<std::string_view> splits;
+  Utilities::StringHelper::splitView(cmdStr, ' ', splits);
   if (splits.size() > 2)
   {
     size_t st = Utilities::Converter<size_t>::toValue(splits[1]);
@@ -164,6 +208,127 @@ HttpReply HttpReply::fromString(const std::string& cmdStr)
   }
   return reply;
 }
+//----< HttpReply from start line of parsed header, 400 if no status >-
+
+HttpReply HttpReply::fromParser(const HttpParser& parser)
+{
+  HttpReply reply;
+  std::string_view statusStr = parser.word(1);
+  size_t st = 0;
+  for (char ch : statusStr)
+  {
+    if (ch < '0' || '9' < ch)
+    {
+      st = 0;
+      break;
+    }
+    st = 10 * st + (ch - '0');
+  }
+  reply.status_ = (st > 0) ? st : 400;
+  return reply;
+}
+
+///////////////////////////////////////////////////////////////////////
+// HttpHeaders methods
+
+//----< id of a name HttpMessage uses, custom for any other >----------
+/*
+*  - the length selects the one or two names worth comparing
+*/
+HttpHeaders::Id HttpHeaders::intern(std::string_view name)
+{
+  auto is = [name](std::string_view known) { return HttpParser::equalIgnoreCase(name, known); };
+  switch (name.size())
+  {
+  case 2:  return is("to") ? idTo : custom;
+  case 4:  return is("host") ? idHost : is("name") ? idName : is("from") ? idFrom : custom;
+  case 6:  return is("action") ? idAction : custom;
+  case 10: return is("connection") ? idConnection : custom;
+  case 14: return is("content-length") ? idContentLength : custom;
+  default: return custom;
+  }
+}
+//----< index of header with name and its id, size() if none >--------
+
+size_t HttpHeaders::indexOf(std::string_view name, Id id) const
+{
+  auto matches = [name, id](const Header& header) {
+    return header.id == id && (id != custom ||
+      (header.name.size() == name.size() && HttpParser::equalIgnoreCase(header.name, name)));
+  };
+  size_t inlineCount = (count_ < inlineCapacity) ? count_ : inlineCapacity;
+  for (size_t i = 0; i < inlineCount; ++i)
+  {
+    if (matches(inline_[i]))
+      return i;
+  }
+  for (size_t i = inlineCapacity; i < count_; ++i)
+  {
+    if (matches(overflow_[i - inlineCapacity]))
+      return i;
+  }
+  return count_;
+}
+//----< add a header, reusing a cleared slot's strings >---------------
+
+HttpHeaders::Header& HttpHeaders::append(std::string_view name, Id id)
+{
+  if (count_ >= inlineCapacity && overflow_.size() <= count_ - inlineCapacity)
+    overflow_.emplace_back();
+  Header& header = at(count_++);
+  header.id = id;
+  header.name.assign(name.data(), name.size());
+  header.value.clear();
+  return header;
+}
+//----< replace value of header with name, or add header >-------------
+/*
+*  - a replaced header keeps its position and the spelling of its name
+*/
+void HttpHeaders::set(std::string_view name, std::string_view value)
+{
+  Id id = intern(name);
+  size_t i = indexOf(name, id);
+  Header& header = (i < count_) ? at(i) : append(name, id);
+  header.value.assign(value.data(), value.size());
+}
+//----< value of header with name, adding an empty one if none >-------
+
+std::string& HttpHeaders::operator[](std::string_view name)
+{
+  Id id = intern(name);
+  size_t i = indexOf(name, id);
+  return (i < count_) ? at(i).value : append(name, id).value;
+}
+//----< value of header with name, nullptr if none >-------------------
+
+std::string* HttpHeaders::find(std::string_view name)
+{
+  size_t i = indexOf(name, intern(name));
+  return (i < count_) ? &at(i).value : nullptr;
+}
+//----< value of header with name, nullptr if none >-------------------
+
+const std::string* HttpHeaders::find(std::string_view name) const
+{
+  size_t i = indexOf(name, intern(name));
+  return (i < count_) ? &at(i).value : nullptr;
+}
+//----< remove header with name, keeping order of the rest >-----------
+/*
+*  - swaps move the removed header's strings to the free slot, so
+*    their capacity is reused by the next append
+*/
+bool HttpHeaders::remove(std::string_view name)
+{
+  size_t i = indexOf(name, intern(name));
+  if (i == count_)
+    return false;
+  for (; i + 1 < count_; ++i)
+    std::swap(at(i), at(i + 1));
+  --count_;
+  return true;
+}
 
 ///////////////////////////////////////////////////////////////////////
 // MessageBody methods
@@ -184,6 +349,9 @@ HttpMessageBody::HttpMessageBody(size_t size, byte* buffer)
 
 void HttpMessageBody::load(size_t size, HttpMessageBody::byte* buffer)
 {
+  fileSpec_.clear();
+  shared_.reset();
+  stream_.reset();
   body_.resize(size);
   std::memcpy(&body_[0], buffer, size);
 }
@@ -198,6 +366,9 @@ HttpMessageBody::HttpMessageBody(const std::string& bodyStr)
 
 HttpMessageBody& HttpMessageBody::operator=(const std::string& bodyStr)
 {
+  fileSpec_.clear();
+  shared_.reset();
+  stream_.reset();
   body_.resize(0);
   body_.insert(body_.end(), bodyStr.begin(), bodyStr.end());
   return *this;
@@ -206,56 +377,201 @@ HttpMessageBody& HttpMessageBody::operator=(const std::string& bodyStr)
 
 HttpMessageBody::byte& HttpMessageBody::operator[](size_t i)
 {
-  if (i < 0 || body_.size() <= i)
+  if (i < 0 || size() <= i)
     throw std::invalid_argument("index out of range");
-  return body_[i];
+  return value()[i];
 }
 //----< const indexer >------------------------------------------------
 
 HttpMessageBody::byte HttpMessageBody::operator[](size_t i) const
 {
-  if (i < 0 || body_.size() <= i)
+  if (i < 0 || size() <= i)
     throw std::invalid_argument("index out of range");
-  return body_[i];
+  return value()[i];
 }
 //----< return body size >---------------------------------------------
 
 size_t HttpMessageBody::size() const
 {
-  return body_.size();
+  return value().size();
 }
 //----< reset body size >----------------------------------------------
 
 void HttpMessageBody::size(size_t size)
 {
-  body_.resize(size);
+  fileSpec_.clear();
+  stream_.reset();
+  value().resize(size);
 }
 //----< return iterator pointing to first byte >-----------------------
 
 HttpMessageBody::iterator HttpMessageBody::begin()
 {
-  return body_.begin();
+  return value().begin();
 }
 //----< return iterator pointing to one past the last byte >-----------
 
 HttpMessageBody::iterator HttpMessageBody::end()
 {
-  return body_.end();
+  return value().end();
 }
 //----< clear body contents >------------------------------------------
 
 void HttpMessageBody::clear()
 {
+  fileSpec_.clear();
+  fileSize_ = 0;
+  fileOffset_ = 0;
+  shared_.reset();
+  stream_.reset();
   body_.clear();
 }
+//----< bytes, copying a shared buffer so changes don't affect others >-
+
+std::vector<HttpMessageBody::byte>& HttpMessageBody::value()
+{
+  if (shared_)
+  {
+    body_ = *shared_;
+    shared_.reset();
+  }
+  return body_;
+}
+//----< refer to an immutable buffer that other bodies may share >---
+/*
+*  - no bytes are copied, until the body is modified through value(),
+*    an indexer, or an iterator
+*/
+void HttpMessageBody::share(Buffer buffer)
+{
+  body_.clear();
+  fileSpec_.clear();
+  stream_.reset();
+  shared_ = buffer;
+}
+//----< refer to size bytes of a file, from offset, instead of holding bytes >-
+/*
+*  - the file isn't opened here, it's read when the message is posted,
+*    e.g., by Socket::sendFile
+*/
+void HttpMessageBody::file(const std::string& fileSpec, size_t size, size_t offset)
+{
+  body_.clear();
+  shared_.reset();
+  stream_.reset();
+  fileSpec_ = fileSpec;
+  fileSize_ = size;
+  fileOffset_ = offset;
+}
+//----< replace file reference with the file's contents >------------
+/*
+*  - for senders that can't send from a file, e.g., EventLoop
+*/
+bool HttpMessageBody::loadFile()
+{
+  if (!isFile())
+    return true;
+  std::ifstream in(fileSpec_, std::ios::binary);
+  if (!in.good() || !in.seekg(static_cast<std::streamoff>(fileOffset_)))
+    return false;
+  body_.resize(fileSize_);
+  in.read(reinterpret_cast<char*>(body_.data()), fileSize_);
+  if (static_cast<size_t>(in.gcount()) != fileSize_)
+  {
+    body_.clear();
+    return false;
+  }
+  fileSpec_.clear();
+  return true;
+}
+//----< body is produced by calls to producer as it's sent >----------
+/*
+*  - producer fills at most size bytes of buffer and returns how many
+*    it wrote, 0 at the end of the body, or streamError to abandon it
+*  - at most chunkSize bytes are held at a time, however long the body
+*/
+void HttpMessageBody::stream(Producer producer, size_t chunkSize)
+{
+  body_.clear();
+  fileSpec_.clear();
+  shared_.reset();
+  stream_ = std::make_shared<Stream>();
+  stream_->producer = std::move(producer);
+  stream_->chunkSize = (std::min)((std::max)(chunkSize, size_t(1)), size_t(0xffffffff));
+}
+//----< write next chunk, framed for chunked transfer-encoding, to out >-
+/*
+*  - returns false once the last chunk, of size zero, has been written,
+*    or if the producer failed, see streamFailed()
+*  - the size is written as eight hex digits, so the producer fills out
+*    in place and nothing is copied
+*/
+bool HttpMessageBody::nextChunk(std::string& out) const
+{
+  out.clear();
+  if (!stream_ || stream_->done)
+    return false;
+  const size_t sizeLine = 10;  // eight hex digits and CRLF
+  size_t chunkSize = stream_->chunkSize;
+  out.resize(sizeLine + chunkSize + 2);  // room for the CRLF after the data
+  size_t bytes = stream_->producer(reinterpret_cast<byte*>(&out[sizeLine]), chunkSize);
+  if (bytes == streamError)
+  {
+    stream_->done = stream_->failed = true;
+    out.clear();
+    return false;
+  }
+  if (bytes == 0)
+  {
+    stream_->done = true;
+    out = "0\r\n\r\n";
+    return true;
+  }
+  bytes = (std::min)(bytes, chunkSize);
+  static const char hexDigits[] = "0123456789abcdef";
+  for (size_t i = 0; i < 8; ++i)
+    out[7 - i] = hexDigits[(bytes >> (4 * i)) & 0xf];
+  out[8] = '\r';
+  out[9] = '\n';
+  out.resize(sizeLine + bytes);
+  out += "\r\n";
+  return true;
+}
+//----< read chunk size from its line, ignoring any extensions >-------
+
+bool HttpMessageBody::parseChunkSize(std::string_view line, size_t& size)
+{
+  line = SUtils::trimView(line);
+  size_t end = line.find(';');
+  if (end != std::string_view::npos)
+    line = SUtils::trimView(line.substr(0, end));
+  if (line.empty() || line.size() > 2 * sizeof(size_t))
+    return false;
+  size = 0;
+  for (char ch : line)
+  {
+    size_t digit;
+    if ('0' <= ch && ch <= '9')
+      digit = ch - '0';
+    else if ('a' <= ch && ch <= 'f')
+      digit = ch - 'a' + 10;
+    else if ('A' <= ch && ch <= 'F')
+      digit = ch - 'A' + 10;
+    else
+      return false;
+    size = (size << 4) | digit;
+  }
+  return true;
+}
 //----< convert to std::string >---------------------------------------
 
 std::string HttpMessageBody::toString() const
 {
   std::string temp;
-  for (size_t i = 0; i < body_.size(); ++i)
+  const std::vector<byte>& bytes = value();
+  for (size_t i = 0; i < bytes.size(); ++i)
   {
-    temp += body_[i];
+    temp += bytes[i];
   }
   return temp;
 }
@@ -272,12 +588,301 @@ HttpMessageBody HttpMessageBody::fromString(const std::string& bodyStr)
 void HttpMessageBody::show(std::ostream& out) const
 {
   out << "\nbody:";
-  for (auto ch : body_)
+  if (isFile())
+    out << " file " << fileSpec_ << ", " << fileSize_ << " bytes from " << fileOffset_;
+  for (auto ch : value())
   {
     out << ch;
   }
 }
 ///////////////////////////////////////////////////////////////////////
+// ByteRange methods
+
+//----< Content-Range value for this range of a resource >------------
+
+std::string ByteRange::contentRange(size_t total) const
+{
+  using Conv = Utilities::Converter<size_t>;
+  return "bytes " + Conv::toString(first) + "-" + Conv::toString(last) + "/" + Conv::toString(total);
+}
+//----< Content-Range value for a 416 reply >--------------------------
+
+std::string ByteRange::unsatisfied(size_t total)
+{
+  return "bytes */" + Utilities::Converter<size_t>::toString(total);
+}
+//----< ranges of a resource of size total that a Range header asks for >-
+/*
+*  - whole: the header is malformed, isn't in bytes, or has more than
+*    maxRanges ranges, so it's ignored and the whole resource is sent
+*  - unsatisfiable: no range starts inside the resource
+*  - partial: ranges holds those that do, sorted, with overlapping and
+*    adjacent ranges merged, as RFC 7233 allows
+*  - "first-" runs to the end, "-n" is the last n bytes, and a last
+*    byte past the end is clipped to it
+*/
+ByteRange::Status ByteRange::parse(std::string_view header, size_t total, std::vector<ByteRange>& ranges)
+{
+  ranges.clear();
+  auto toSize = [](std::string_view digits, size_t& value)
+  {
+    if (digits.empty())
+      return false;
+    value = 0;
+    for (char ch : digits)
+    {
+      if (ch < '0' || '9' < ch)
+        return false;
+      size_t digit = ch - '0';
+      value = (value > (SIZE_MAX - digit) / 10) ? SIZE_MAX : value * 10 + digit;
+    }
+    return true;
+  };
+
+  header = SUtils::trimView(header);
+  const std::string_view unit = "bytes=";
+  if (header.size() <= unit.size() || !HttpParser::equalIgnoreCase(header.substr(0, unit.size()), unit))
+    return whole;
+  std::vector<std::string_view> specs;
+  SUtils::splitView(header.substr(unit.size()), ',', specs);
+  size_t count = 0;
+  for (std::string_view spec : specs)
+  {
+    if (spec.empty())
+      continue;
+    size_t dash = spec.find('-');
+    if (++count > maxRanges || dash == std::string_view::npos)
+    {
+      ranges.clear();
+      return whole;
+    }
+    std::string_view firstText = SUtils::trimView(spec.substr(0, dash));
+    std::string_view lastText = SUtils::trimView(spec.substr(dash + 1));
+    ByteRange range;
+    if (firstText.empty())
+    {
+      size_t suffix;
+      if (!toSize(lastText, suffix))
+      {
+        ranges.clear();
+        return whole;
+      }
+      if (suffix == 0 || total == 0)
+        continue;
+      range.first = total - (std::min)(suffix, total);
+      range.last = total - 1;
+    }
+    else
+    {
+      bool valid = toSize(firstText, range.first) &&
+        (lastText.empty() || (toSize(lastText, range.last) && range.first <= range.last));
+      if (!valid)
+      {
+        ranges.clear();
+        return whole;
+      }
+      if (range.first >= total)
+        continue;
+      if (lastText.empty() || range.last >= total)
+        range.last = total - 1;
+    }
+    ranges.push_back(range);
+  }
+  if (ranges.empty())
+    return (count > 0) ? unsatisfiable : whole;
+
+  std::sort(ranges.begin(), ranges.end(),
+    [](const ByteRange& lhs, const ByteRange& rhs) { return lhs.first < rhs.first; });
+  size_t merged = 0;
+  for (size_t i = 1; i < ranges.size(); ++i)
+  {
+    if (ranges[i].first <= ranges[merged].last + 1)
+      ranges[merged].last = (std::max)(ranges[merged].last, ranges[i].last);
+    else
+      ranges[++merged] = ranges[i];
+  }
+  ranges.resize(merged + 1);
+  return partial;
+}
+///////////////////////////////////////////////////////////////////////
+// Validator methods
+
+namespace
+{
+  const char* dayNames[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+  const char* monthNames[] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+
+  //----< days since 1970-01-01 of a date in the Gregorian calendar >--
+
+  long long daysFromCivil(long long year, unsigned month, unsigned day)
+  {
+    year -= (month <= 2) ? 1 : 0;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<long long>(dayOfEra) - 719468;
+  }
+  //----< date in the Gregorian calendar of days since 1970-01-01 >----
+
+  void civilFromDays(long long days, long long& year, unsigned& month, unsigned& day)
+  {
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shifted = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+    month = shifted < 10 ? shifted + 3 : shifted - 9;
+    year = static_cast<long long>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+  }
+  //----< value of a string of digits, false if there are none >------
+
+  bool toNumber(std::string_view digits, unsigned& value)
+  {
+    if (digits.empty() || digits.size() > 4)
+      return false;
+    value = 0;
+    for (char ch : digits)
+    {
+      if (ch < '0' || '9' < ch)
+        return false;
+      value = value * 10 + (ch - '0');
+    }
+    return true;
+  }
+  //----< month, 1 to 12, of its three letter name >------------------
+
+  bool toMonth(std::string_view name, unsigned& month)
+  {
+    for (unsigned i = 0; i < 12; ++i)
+    {
+      if (HttpParser::equalIgnoreCase(name, monthNames[i]))
+      {
+        month = i + 1;
+        return true;
+      }
+    }
+    return false;
+  }
+}
+//----< does a list of entity tags, or "*", match etag? >-------------
+/*
+*  - strong comparison, for If-Range, matches only tags that aren't
+*    weak, W/"xyz", weak comparison, for If-None-Match, ignores W/
+*  - tags may hold commas, so the list is scanned quote to quote, not
+*    split on commas
+*/
+bool Validator::matches(std::string_view header, std::string_view etag, bool strong)
+{
+  bool etagWeak = etag.size() >= 2 && etag[0] == 'W' && etag[1] == '/';
+  if (etag.empty() || (strong && etagWeak))
+    return false;
+  std::string_view opaque = etagWeak ? etag.substr(2) : etag;
+  header = SUtils::trimView(header);
+  if (header == "*")
+    return true;
+  size_t pos = 0;
+  while (pos < header.size())
+  {
+    size_t open = header.find('"', pos);
+    if (open == std::string_view::npos)
+      break;
+    size_t close = header.find('"', open + 1);
+    if (close == std::string_view::npos)
+      break;
+    bool weak = open >= 2 && header[open - 2] == 'W' && header[open - 1] == '/';
+    if (!(strong && weak) && header.substr(open, close - open + 1) == opaque)
+      return true;
+    pos = close + 1;
+  }
+  return false;
+}
+//----< IMF-fixdate of a time, "Sun, 06 Nov 1994 08:49:37 GMT" >------
+
+std::string Validator::httpDate(std::time_t time)
+{
+  char buffer[dateChars];
+  return std::string(buffer, httpDate(time, buffer, sizeof(buffer)));
+}
+//----< write IMF-fixdate of a time into buffer, returns its length >-
+/*
+*  - writes into the caller's buffer, dateChars long, as Converter's
+*    toChars does, so a reply's Last-Modified is formatted without
+*    allocating
+*  - returns 0 if buffer is too small
+*/
+size_t Validator::httpDate(std::time_t time, char* buffer, size_t size)
+{
+  long long seconds = static_cast<long long>(time);
+  long long days = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+  long long secondOfDay = seconds - days * 86400;
+  long long year;
+  unsigned month, day;
+  civilFromDays(days, year, month, day);
+  int length = std::snprintf(buffer, size, "%s, %02u %s %04lld %02lld:%02lld:%02lld GMT",
+    dayNames[((days % 7) + 11) % 7], day, monthNames[month - 1], year,
+    secondOfDay / 3600, secondOfDay / 60 % 60, secondOfDay % 60);
+  return (length > 0 && static_cast<size_t>(length) < size) ? static_cast<size_t>(length) : 0;
+}
+//----< time of an HTTP-date, false if text isn't one >---------------
+/*
+*  - accepts the three forms RFC 9110 asks recipients to accept:
+*    "Sun, 06 Nov 1994 08:49:37 GMT", "Sunday, 06-Nov-94 08:49:37 GMT",
+*    and asctime's "Sun Nov  6 08:49:37 1994"
+*  - two digit years are taken as 1970 to 2069
+*/
+bool Validator::parseHttpDate(std::string_view text, std::time_t& time)
+{
+  text = SUtils::trimView(text);
+  size_t skip = text.find_first_of(", ");
+  if (skip == std::string_view::npos)
+    return false;
+  std::vector<std::string_view> fields;
+  size_t pos = skip + 1;
+  while (pos < text.size() && fields.size() < 6)
+  {
+    size_t end = text.find_first_of(" -", pos);
+    if (end == std::string_view::npos)
+      end = text.size();
+    if (end > pos)
+      fields.push_back(text.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  unsigned day, month, year, hour, minute, second;
+  std::string_view clock;
+  if (fields.size() == 4 && toMonth(fields[0], month))           // asctime
+  {
+    if (!toNumber(fields[1], day) || !toNumber(fields[3], year))
+      return false;
+    clock = fields[2];
+  }
+  else if (fields.size() == 5 && fields[4] == "GMT")
+  {
+    if (!toNumber(fields[0], day) || !toMonth(fields[1], month) || !toNumber(fields[2], year))
+      return false;
+    if (fields[2].size() == 2)
+      year += (year < 70) ? 2000 : 1900;
+    clock = fields[3];
+  }
+  else
+  {
+    return false;
+  }
+  if (clock.size() != 8 || clock[2] != ':' || clock[5] != ':' ||
+    !toNumber(clock.substr(0, 2), hour) || !toNumber(clock.substr(3, 2), minute) ||
+    !toNumber(clock.substr(6, 2), second))
+    return false;
+  if (day < 1 || day > 31 || year < 1970 || hour > 23 || minute > 59 || second > 60)
+    return false;
+  long long seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+  time = static_cast<std::time_t>(seconds);
+  return true;
+}
+///////////////////////////////////////////////////////////////////////
 // EndPoint methods
 
 //----< initialize address and port >----------------------------------
@@ -288,7 +893,12 @@ EndPoint::EndPoint(Address anAddress, Port aPort) : address(anAddress), port(aPo
 
 std::string EndPoint::toString() const
 {
-  return address + ":" + Utilities::Converter<size_t>::toString(port);
+  char buffer[Utilities::Converter<size_t>::maxChars];
+  size_t length = Utilities::Converter<size_t>::toChars(port, buffer, sizeof(buffer));
+  std::string str;
+  str.reserve(address.size() + 1 + length);
+  str.append(address).append(1, ':').append(buffer, length);
+  return str;
 }
 //----< build EndPoint from address:port string >----------------------
 
@@ -420,6 +1030,17 @@ int main()
   testMsg.show();
   Utilities::putline();
 
+  SUtils::title("attribute names match without regard to case");
+  std::cout << "\n  keepAlive()            : " << (testMsg.keepAlive() ? "true" : "false");
+  std::cout << "\n  containsKey(\"HOST\")    : " << (testMsg.containsKey("HOST") ? "true" : "false");
+  testMsg.attribute("connection", "close");
+  std::cout << "\n  after connection:close : " << (testMsg.keepAlive() ? "true" : "false");
+  std::cout << "\n  attribute count        : " << testMsg.attributes().size();
+  std::cout << "\n  first key              : " << testMsg.keys()[0];
+  testMsg.attributes().remove("Cache-Control");
+  std::cout << "\n  after remove           : " << testMsg.attributes().size();
+  Utilities::putline();
+
   SUtils::title("testing reply message");
   HttpMessage<HttpReply> reply = makeHttpReplyMessage(200);
   std::string bodyStr = "<h3>Got a message for you</h3>";
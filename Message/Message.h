@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // Message.h - defines HTTP request and reply messages                 //
-// ver 2.1                                                             //
+// ver 3.5                                                             //
 // Jim Fawcett, CSE687 Object Oriented Design, Spring 2018             //
 /////////////////////////////////////////////////////////////////////////
 /*
@@ -13,7 +13,17 @@
 *  - Endpoints define a message source or destination with an address and port number.
 *  - HttpRequest defines the command line for HttpMessage<HttpRequest> instances.
 *  - HttpReply defines the command line for HttpMessage<HttpReply> instances.
-*  - HttpMessageBody manages message body contents.
+*  - HttpMessageBody manages message body contents.  A body either holds its bytes
+*    or refers to a file, see file(path, size), whose contents are sent when the
+*    message is posted, or shares a read-only buffer, see share(buffer), or is
+*    produced a chunk at a time while the message is sent, see stream(producer).
+*  - ByteRange parses a Range header, "bytes=0-499,-500", into the byte ranges of a
+*    resource that it asks for.
+*  - Validator compares a resource's entity tag and modification time with the
+*    If-None-Match, If-Modified-Since, and If-Range headers of a conditional
+*    request, and formats and parses the HTTP-dates they use.
+*  - HttpHeaders holds attribute name:value pairs in order.  Most messages have few
+*    attributes so they are kept in a small array, searched without regard to case.
 *  - HttpMessage<T> has an HTTP style structure with a set of attribute lines containing
 *    name:value pairs.
 *  - Message have a number of getter, setter methods for common attributes, and allow
@@ -21,10 +31,65 @@
 *
 *  Required Files:
 *  ---------------
-*  Message.h, Message.cpp, Utilities.h, Utilities.cpp
+*  Message.h, Message.cpp, HttpParser.h, HttpParser.cpp,
+*  Utilities.h, Utilities.cpp
 *
 *  Maintenance History:
 *  --------------------
+*  ver 3.5 : 17 Oct 2026
+*  - added 413 status, sent for a request body larger than a server allows
+*  ver 3.4 : 17 Oct 2026
+*  - added const type()
+*  ver 3.3 : 17 Oct 2026
+*  - added Validator, which matches entity tags and reads HTTP-dates
+*  - added status 304, not modified, and HttpReply::bodyAllowed
+*  ver 3.2 : 17 Oct 2026
+*  - file(path, size, offset) refers to size bytes starting at offset
+*  - added ByteRange, which parses Range headers
+*  - added status 206, partial content, and 416, range not satisfiable
+*  ver 3.1 : 17 Oct 2026
+*  - added status 201, created
+*  ver 3.0 : 17 Oct 2026
+*  - HttpMessageBody may be a stream, a producer called for one chunk of
+*    the body at a time, and HttpMessage::stream(producer) marks the
+*    message "transfer-encoding: chunked"
+*  - nextChunk frames chunks, parseChunkSize reads a chunk size line
+*  ver 2.9 : 17 Oct 2026
+*  - EndPoints can be compared, so they can key a std::map
+*  ver 2.8 : 17 Oct 2026
+*  - keepAlive and the fromString start line parsers use StringHelper's
+*    view returning trimView and splitView, instead of copying
+*  ver 2.7 : 17 Oct 2026
+*  - content-length, status codes, and ports are converted with
+*    Converter's toChars, into stack buffers, not string streams
+*  ver 2.6 : 17 Oct 2026
+*  - HttpReply's status messages are one static table, instead of a map
+*    built by every reply
+*  - attribute(...) and containsKey(...) take string_views, so literal
+*    arguments are not copied into temporary strings
+*  - HttpRequest::fileSpec() returns a reference
+*  ver 2.5 : 17 Oct 2026
+*  - attributes are held in HttpHeaders, a flat list with inline storage
+*    for the first 16, instead of an unordered_map.  Names match without
+*    regard to case, so "Content-Length" is found by contentLength().
+*  - attributes keep the order in which they were added
+*  ver 2.4 : 17 Oct 2026
+*  - fromString uses HttpParser, a single pass parser, instead of splitting
+*    the header into strings, and fromParser builds a message from a
+*    header parsed where it was received
+*  - attribute values no longer keep the spaces that follow a colon
+*  ver 2.3 : 17 Oct 2026
+*  - HttpMessageBody may refer to a file instead of holding bytes, so a
+*    server can send a file without reading it into memory
+*  - HttpMessageBody may share an immutable buffer, e.g., cached file
+*    contents, with other bodies.  It's copied only if modified.
+*  ver 2.2 : 17 Oct 2026
+*  - added keepAlive getter and setter for the connection attribute
+*  - added 503 status, sent when a server is overloaded
+*  - const body() returns a reference instead of a copy, contentLength()
+*    is const, and toHeaderString(out) writes into a caller's buffer
+*  - header of a message without attributes now ends with a blank line,
+*    as every other header does
 *  ver 2.1 : 15 Jan 2018
 *  - added HttpMessage<T>::toHeaderString() method
 *  ver 2.0 : 04 Jan 2018
@@ -37,10 +102,16 @@
 *
 */
 #include "../Utilities/Utilities.h"
+#include "../HttpParser/HttpParser.h"
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include <memory>
+#include <functional>
 #include <iostream>
+#include <cctype>
+#include <ctime>
 
 namespace HttpCommunication
 {
@@ -56,6 +127,8 @@ namespace HttpCommunication
     EndPoint(Address anAddress = "", Port aPort = 0);
     std::string toString() const;
     static EndPoint fromString(const std::string& str);
+    bool operator==(const EndPoint& ep) const { return port == ep.port && address == ep.address; }
+    bool operator<(const EndPoint& ep) const { return port < ep.port || (port == ep.port && address < ep.address); }
   };
 
   /////////////////////////////////////////////////////////////////////
@@ -72,9 +145,10 @@ namespace HttpCommunication
     HttpRequest(HttpCommand command, const std::string& fileSpec);
     std::string toString(bool full = true) const;
     static HttpRequest fromString(const std::string& cmdStr);
+    static HttpRequest fromParser(const HttpParser& parser);
     HttpCommand command() const;
     void command(HttpCommand cmd);
-    std::string fileSpec() const;
+    const std::string& fileSpec() const;
     void fileSpec(const std::string& fileSpec);
   private:
     HttpCommand cmd_;
@@ -93,25 +167,90 @@ namespace HttpCommunication
     size_t status();
     void status(size_t st);
     std::string message() const;
+    bool bodyAllowed() const;
     std::string toString() const;
     static HttpReply fromString(const std::string& cmdStr);
+    static HttpReply fromParser(const HttpParser& parser);
   private:
-    StatusType statusType { 
-      {100, "info"}, {200, "OK"}, {300, "redirect"}, 
-      {400, "error"}, {404, "not found"}, {500, "server error"}
-    };
+    static const StatusType& statusType();
     size_t status_ = 200;
   };
 
+  ///////////////////////////////////////////////////////////////////
+  // HttpHeaders class
+  // - ordered name:value pairs, names matched without regard to case
+  // - the first inlineCapacity headers are stored in the object itself,
+  //   any more are kept in a vector, so typical messages make no node
+  //   allocations and compute no hashes
+  // - names HttpMessage uses are interned, matching them compares ids
+  // - clear() keeps each slot's strings, so a reused instance reuses
+  //   their capacity
+
+  class HttpHeaders
+  {
+  public:
+    enum Id { custom, idContentLength, idConnection, idHost, idName, idAction, idTo, idFrom };
+    static const size_t inlineCapacity = 16;
+
+    struct Header
+    {
+      Id id = custom;
+      std::string name;
+      std::string value;
+    };
+
+    class const_iterator
+    {
+    public:
+      const_iterator(const HttpHeaders* pHeaders, size_t i) : pHeaders_(pHeaders), i_(i) {}
+      const Header& operator*() const { return pHeaders_->at(i_); }
+      const Header* operator->() const { return &pHeaders_->at(i_); }
+      const_iterator& operator++() { ++i_; return *this; }
+      bool operator!=(const const_iterator& other) const { return i_ != other.i_; }
+      bool operator==(const const_iterator& other) const { return i_ == other.i_; }
+    private:
+      const HttpHeaders* pHeaders_;
+      size_t i_;
+    };
+
+    static Id intern(std::string_view name);
+    void set(std::string_view name, std::string_view value);
+    std::string& operator[](std::string_view name);
+    std::string* find(std::string_view name);
+    const std::string* find(std::string_view name) const;
+    bool contains(std::string_view name) const { return find(name) != nullptr; }
+    bool remove(std::string_view name);
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    void clear() { count_ = 0; }
+    Header& at(size_t i) { return (i < inlineCapacity) ? inline_[i] : overflow_[i - inlineCapacity]; }
+    const Header& at(size_t i) const { return (i < inlineCapacity) ? inline_[i] : overflow_[i - inlineCapacity]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count_); }
+  private:
+    size_t indexOf(std::string_view name, Id id) const;
+    Header& append(std::string_view name, Id id);
+
+    Header inline_[inlineCapacity];
+    std::vector<Header> overflow_;
+    size_t count_ = 0;
+  };
+
   ///////////////////////////////////////////////////////////////////
   // MessageBody class
   // - provides correct value semantics
+  // - copies of a stream body share its producer, so its bytes are
+  //   produced once, for whichever copy is sent
 
   class HttpMessageBody
   {
   public:
     using byte = unsigned char;
     using iterator = std::vector<byte>::iterator;
+    using Buffer = std::shared_ptr<const std::vector<byte>>;
+    using Producer = std::function<size_t(byte* buffer, size_t size)>;
+    static const size_t defaultChunkSize = 64 * 1024;
+    static const size_t streamError = static_cast<size_t>(-1);
 
     HttpMessageBody() = default;
     HttpMessageBody(size_t size);
@@ -126,13 +265,72 @@ namespace HttpCommunication
     HttpMessageBody::iterator end();
     void load(size_t sz, byte*);
     void clear();
-    std::vector<byte>& value() { return body_; }
+    std::vector<byte>& value();
+    const std::vector<byte>& value() const { return shared_ ? *shared_ : body_; }
+    void share(Buffer buffer);
+    bool isShared() const { return shared_ != nullptr; }
+    void file(const std::string& fileSpec, size_t size, size_t offset = 0);
+    bool isFile() const { return !fileSpec_.empty(); }
+    const std::string& fileSpec() const { return fileSpec_; }
+    size_t fileSize() const { return fileSize_; }
+    size_t fileOffset() const { return fileOffset_; }
+    bool loadFile();
+    void stream(Producer producer, size_t chunkSize = defaultChunkSize);
+    bool isStream() const { return stream_ != nullptr; }
+    bool streamFailed() const { return stream_ != nullptr && stream_->failed; }
+    bool nextChunk(std::string& out) const;
+    static bool parseChunkSize(std::string_view line, size_t& size);
 
     std::string toString() const;
     static HttpMessageBody fromString(const std::string& bodyStr);
     void show(std::ostream& out = std::cout) const;
   private:
+    struct Stream
+    {
+      Producer producer;
+      size_t chunkSize;
+      bool done = false;
+      bool failed = false;
+    };
+
     std::vector<byte> body_;
+    Buffer shared_;          // if not null, used instead of body_
+    std::string fileSpec_;   // non-empty if body refers to a file
+    size_t fileSize_ = 0;
+    size_t fileOffset_ = 0;  // where in the file the body starts
+    std::shared_ptr<Stream> stream_;  // if not null, body is produced as it's sent
+  };
+  ///////////////////////////////////////////////////////////////////
+  // ByteRange struct
+  // - one range of a Range header, first and last inclusive, as in
+  //   the header, resolved against the resource's size
+
+  struct ByteRange
+  {
+    enum Status { whole, partial, unsatisfiable };
+    static const size_t maxRanges = 16;
+
+    size_t first = 0;
+    size_t last = 0;
+
+    size_t size() const { return last - first + 1; }
+    std::string contentRange(size_t total) const;
+    static std::string unsatisfied(size_t total);
+    static Status parse(std::string_view header, size_t total, std::vector<ByteRange>& ranges);
+  };
+  ///////////////////////////////////////////////////////////////////
+  // Validator struct
+  // - entity tags are compared quoted, as sent, "xyz" or W/"xyz"
+  // - times are seconds since 1970, UTC, as std::time_t usually is
+
+  struct Validator
+  {
+    static const size_t dateChars = 30;  // an IMF-fixdate and its null
+
+    static bool matches(std::string_view header, std::string_view etag, bool strong);
+    static std::string httpDate(std::time_t time);
+    static size_t httpDate(std::time_t time, char* buffer, size_t size);
+    static bool parseHttpDate(std::string_view text, std::time_t& time);
   };
   ///////////////////////////////////////////////////////////////////
   // HttpMessage class
@@ -144,7 +342,7 @@ namespace HttpCommunication
     using Key = std::string;
     using Value = std::string;
     using Attribute = std::string;
-    using Attributes = std::unordered_map<Key, Value>;
+    using Attributes = HttpHeaders;
     using Keys = std::vector<Key>;
     using FileSpec = std::string;
     using CommandString = std::string;
@@ -153,21 +351,26 @@ namespace HttpCommunication
     HttpMessage() = default;
 
     T& type();
+    const T& type() const;
     Attributes& attributes();
-    void attribute(const Key& key, const Value& value);
+    void attribute(std::string_view key, std::string_view value);
     Keys keys() const;
     static Key attribKey(const Attribute& attr);
     static Value attribValue(const Attribute& attr);
-    bool containsKey(const Key& key) const;
+    bool containsKey(std::string_view key) const;
 
-    size_t contentLength();
+    size_t contentLength() const;
     void contentLength(size_t ln);
     HttpMessageBody& body();
-    HttpMessageBody body() const;
+    const HttpMessageBody& body() const;
     std::string name();
     void name(const std::string& nm);
     std::string action();
     void action(const std::string& cmd);
+    bool keepAlive() const;
+    void keepAlive(bool persist);
+    bool chunked() const;
+    void stream(HttpMessageBody::Producer producer, size_t chunkSize = HttpMessageBody::defaultChunkSize);
     EndPoint to();
     void to(EndPoint ep);
     EndPoint from();
@@ -176,8 +379,10 @@ namespace HttpCommunication
     void clearAttributes();
     void clear();
     std::string toHeaderString() const;
+    void toHeaderString(std::string& out) const;
     std::string toString() const;
     static HttpMessage<T> fromString(const std::string& src);
+    static HttpMessage<T> fromParser(const HttpParser& parser);
     void show(std::ostream& out = std::cout, bool suppressTrailingNewLine = true) const;
   protected:
     T type_;
@@ -219,6 +424,12 @@ namespace HttpCommunication
   {
     return type_;
   }
+
+  template <typename T>
+  const T& HttpMessage<T>::type() const
+  {
+    return type_;
+  }
   //----< return reference to message attributes >---------------------
 
   template <typename T>
@@ -229,9 +440,9 @@ namespace HttpCommunication
   //----< set message attribute >--------------------------------------
 
   template <typename T>
-  void HttpMessage<T>::attribute(const Key& key, const Value& value)
+  void HttpMessage<T>::attribute(std::string_view key, std::string_view value)
   {
-    attributes_[key] = value;
+    attributes_.set(key, value);
   }
   //----< return vector of attribute keys >----------------------------
 
@@ -240,20 +451,18 @@ namespace HttpCommunication
   {
     Keys keys;
     keys.reserve(attributes_.size());
-    for (auto kv : attributes_)
+    for (auto& header : attributes_)
     {
-      keys.push_back(kv.first);
+      keys.push_back(header.name);
     }
     return keys;
   }
   //----< does message contain attribute with this key? >--------------
 
   template <typename T>
-  bool HttpMessage<T>::containsKey(const Key& key) const
+  bool HttpMessage<T>::containsKey(std::string_view key) const
   {
-    if (attributes_.find(key) == attributes_.end())
-      return false;
-    return true;
+    return attributes_.contains(key);
   }
   //----< find key from attribute string "key:value" >-----------------
 
@@ -278,13 +487,11 @@ namespace HttpCommunication
   //----< return value of content-length >-----------------------------
 
   template <typename T>
-  size_t HttpMessage<T>::contentLength()
+  size_t HttpMessage<T>::contentLength() const
   {
-    if (containsKey("content-length"))
-    {
-      std::string lenStr = attributes_["content-length"];
-      return Utilities::Converter<size_t>::toValue(lenStr);
-    }
+    const Value* pValue = attributes_.find("content-length");
+    if (pValue != nullptr)
+      return Utilities::Converter<size_t>::toValue(*pValue);
     return 0;
   }
   //----< set content-length value >-----------------------------------
@@ -292,7 +499,9 @@ namespace HttpCommunication
   template <typename T>
   void HttpMessage<T>::contentLength(size_t ln)
   {
-    attributes_["content-length"] = Utilities::Converter<size_t>::toString(ln);
+    char buffer[Utilities::Converter<size_t>::maxChars];
+    size_t length = Utilities::Converter<size_t>::toChars(ln, buffer, sizeof(buffer));
+    attributes_.set("content-length", std::string_view(buffer, length));
   }
   //----< retrieve reference to body >---------------------------------
 
@@ -304,7 +513,7 @@ namespace HttpCommunication
   //----< set body >---------------------------------------------------
 
   template <typename T>
-  HttpMessageBody HttpMessage<T>::body() const
+  const HttpMessageBody& HttpMessage<T>::body() const
   {
     return body_;
   }
@@ -313,72 +522,107 @@ namespace HttpCommunication
   template <typename T>
   std::string HttpMessage<T>::name()
   {
-    if (containsKey("name"))
-    {
-      return attributes_["name"];
-    }
-    return "";
+    const Value* pValue = attributes_.find("name");
+    return (pValue != nullptr) ? *pValue : "";
   }
   //----< set name attribute >-------------------------------------------
 
   template <typename T>
   void HttpMessage<T>::name(const std::string& nm)
   {
-    attributes_["name"] = nm;
+    attributes_.set("name", nm);
   }
   //----< get action attribute >-----------------------------------------
 
   template <typename T>
   std::string HttpMessage<T>::action()
   {
-    if (containsKey("action"))
-    {
-      return attributes_["action"];
-    }
-    return "";
+    const Value* pValue = attributes_.find("action");
+    return (pValue != nullptr) ? *pValue : "";
   }
   //----< set action attribute >-----------------------------------------
 
   template <typename T>
   void HttpMessage<T>::action(const std::string& cmd)
   {
-    attributes_["action"] = cmd;
+    attributes_.set("action", cmd);
+  }
+  //----< does sender want connection kept open? >----------------------
+  /*
+  *  - HTTP/1.1 connections persist unless the connection attribute
+  *    is "close"
+  */
+  template <typename T>
+  bool HttpMessage<T>::keepAlive() const
+  {
+    const Value* pValue = attributes_.find("connection");
+    if (pValue == nullptr)
+      return true;
+    return !HttpParser::equalIgnoreCase(Utilities::StringHelper::trimView(*pValue), "close");
+  }
+  //----< set connection attribute >-------------------------------------
+
+  template <typename T>
+  void HttpMessage<T>::keepAlive(bool persist)
+  {
+    attributes_.set("connection", persist ? "keep-alive" : "close");
+  }
+  //----< is body sent with chunked transfer-encoding? >----------------
+  /*
+  *  - chunked is the last encoding applied, when there is one
+  */
+  template <typename T>
+  bool HttpMessage<T>::chunked() const
+  {
+    const Value* pValue = attributes_.find("transfer-encoding");
+    if (pValue == nullptr)
+      return false;
+    std::string_view value = Utilities::StringHelper::trimView(*pValue);
+    std::string_view last = "chunked";
+    return value.size() >= last.size() &&
+      HttpParser::equalIgnoreCase(value.substr(value.size() - last.size()), last);
+  }
+  //----< body is produced while it's sent, in chunks >------------------
+  /*
+  *  - the length isn't known in advance, so content-length is replaced
+  *    by "transfer-encoding: chunked"
+  */
+  template <typename T>
+  void HttpMessage<T>::stream(HttpMessageBody::Producer producer, size_t chunkSize)
+  {
+    body_.stream(std::move(producer), chunkSize);
+    attributes_.remove("content-length");
+    attributes_.set("transfer-encoding", "chunked");
   }
   //----< get to attribute >---------------------------------------------
 
   template <typename T>
   EndPoint HttpMessage<T>::to()
   {
-    if (containsKey("to"))
-    {
-      return EndPoint::fromString(attributes_["to"]);
-    }
-    return EndPoint();
+    const Value* pValue = attributes_.find("to");
+    return (pValue != nullptr) ? EndPoint::fromString(*pValue) : EndPoint();
   }
   //----< set to attribute >---------------------------------------------
 
   template <typename T>
   void HttpMessage<T>::to(EndPoint ep)
   {
-    attributes_["to"] = ep.toString();
+    attributes_.set("to", ep.toString());
   }
   //----< get from attribute >-------------------------------------------
 
   template <typename T>
   EndPoint HttpMessage<T>::from()
   {
-    if (containsKey("from"))
-    {
-      return EndPoint::fromString(attributes_["from"]);
-    }
-    return EndPoint();
+    const Value* pValue = attributes_.find("from");
+    return (pValue != nullptr) ? EndPoint::fromString(*pValue) : EndPoint();
   }
   //----< set from attribute >-------------------------------------------
 
   template <typename T>
   void HttpMessage<T>::from(EndPoint ep)
   {
-    attributes_["from"] = ep.toString();
+    attributes_.set("from", ep.toString());
   }
   //----< clears all attributes >----------------------------------------
 
@@ -407,16 +651,22 @@ namespace HttpCommunication
   template<typename T>
   std::string HttpMessage<T>::toHeaderString() const
   {
-    std::string temp = type_.toString();
+    std::string temp;
+    toHeaderString(temp);
+    return temp;
+  }
+  //----< write header into out, reusing its capacity >----------------
 
-    if (attributes_.size() > 0)
-      temp += "\n";
-    for (auto kv : attributes_)
+  template <typename T>
+  void HttpMessage<T>::toHeaderString(std::string& out) const
+  {
+    out.clear();
+    out.append(type_.toString()).append("\n");
+    for (auto& header : attributes_)
     {
-      temp += kv.first + ":" + kv.second + "\n";
+      out.append(header.name).append(":").append(header.value).append("\n");
     }
-    temp += "\n";
-    return temp;
+    out += "\n";
   }
   //----< convert HttpMessage to string representation >---------------
 
@@ -431,78 +681,45 @@ namespace HttpCommunication
     }
     return temp;
   }
-  //----< build HttpMessage<HttpRequest> from string rep >-------------
+  //----< build HttpMessage from a parsed header >--------------------
 
-  template <>
-  inline HttpMessage<HttpRequest> HttpMessage<HttpRequest>::fromString(const std::string& src)
+  template <typename T>
+  HttpMessage<T> HttpMessage<T>::fromParser(const HttpParser& parser)
   {
-    std::vector<std::string> splits = Utilities::StringHelper::split(src, '\n');
-    if (splits.size() > 1)
-    {
-      std::vector<std::string> cmdSplits = Utilities::StringHelper::split(splits[0], ' ');
-      HttpMessage<HttpRequest> msg;
-      if (cmdSplits.size() > 1)
-      {
-        msg.type() = HttpRequest::fromString(splits[0]);
-        msg.type().fileSpec(cmdSplits[1]);
-      }
-      for (size_t i = 1; i < splits.size(); ++i)
-      {
-        if (splits[i].size() == 0)
-          continue;
-        Key key = attribKey(splits[i]);
-        Value value = attribValue(splits[i]);
-        if (key.size() > 0)
-        {
-          msg.attributes_[key] = value;
-        }
-        else
-        {
-          HttpMessageBody body = HttpMessageBody::fromString(splits[i]);
-          msg.body() = body;
-          msg.attributes_["content-length"] = Utilities::Converter<size_t>::toString(splits[i].size());
-        }
-      }
-      return msg;
-    }
-    return HttpMessage<HttpRequest>();
+    HttpMessage<T> msg;
+    msg.type_ = T::fromParser(parser);
+    for (size_t i = 0; i < parser.headerCount(); ++i)
+      msg.attributes_.set(parser.name(i), parser.value(i));
+    return msg;
   }
-  //----< build HttpMessage<HttpReply> from string rep >---------------
-
-  template <>
-  inline HttpMessage<HttpReply> HttpMessage<HttpReply>::fromString(const std::string& src)
-  {
-    std::vector<std::string> splits = Utilities::StringHelper::split(src, '\n');
-    if (splits.size() > 1)
+  //----< build HttpMessage from string rep >--------------------------
+  /*
+  *  - header needn't end with a blank line
+  *  - text after the header is the body, less the newline toString()
+  *    appends, unless content-length says how long it is
+  */
+  template <typename T>
+  HttpMessage<T> HttpMessage<T>::fromString(const std::string& src)
+  {
+    HttpParser parser;
+    if (parser.parse(src.data(), src.size()) == HttpParser::incomplete)
+      parser.finish();
+    if (parser.status() != HttpParser::complete)
+      return HttpMessage<T>();
+
+    HttpMessage<T> msg = fromParser(parser);
+    size_t bodyStart = parser.headerLength();
+    size_t bodyLen = src.size() - bodyStart;
+    if (msg.containsKey("content-length") && msg.contentLength() < bodyLen)
+      bodyLen = msg.contentLength();
+    else if (bodyLen > 0 && src.back() == '\n')
+      --bodyLen;
+    if (bodyLen > 0)
     {
-      std::vector<std::string> cmdSplits = Utilities::StringHelper::split(splits[0], ' ');
-      HttpMessage<HttpReply> msg;
-      if (cmdSplits.size() > 1)
-      {
-        msg.type() = HttpReply::fromString(splits[0]);
-        size_t statusNum = Utilities::Converter<size_t>::toValue(cmdSplits[1]);
-        msg.type().status(statusNum);
-      }
-      for (size_t i = 1; i < splits.size(); ++i)
-      {
-        if (splits[i].size() == 0)
-          continue;
-        Key key = attribKey(splits[i]);
-        Value value = attribValue(splits[i]);
-        if (key.size() > 0)
-        {
-          msg.attributes_[key] = value;
-        }
-        else
-        {
-          HttpMessageBody body = HttpMessageBody::fromString(splits[i]);
-          msg.body() = body;
-          msg.attributes_["content-length"] = Utilities::Converter<size_t>::toString(splits[i].size());
-        }
-      }
-      return msg;
+      msg.body_.load(bodyLen, (HttpMessageBody::byte*)&src[bodyStart]);
+      msg.contentLength(bodyLen);
     }
-    return HttpMessage<HttpReply>();
+    return msg;
   }
 
   //----< displays HttpMessage on std::ostream >-----------------------------
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////
 // Sockets.cpp - C++ wrapper for Win32 socket api                      //
-// ver 5.3                                                             //
+// ver 5.5                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
 // CST 4-187, Syracuse University, 315 443-3948, jfawcett@twcny.rr.com //
 //---------------------------------------------------------------------//
@@ -18,6 +18,10 @@
 #include <memory>
 #include <functional>
 #include <exception>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <chrono>
 #include "../Utilities/Utilities.h"
 
 using namespace Sockets;
@@ -35,7 +39,7 @@ SocketSystem::SocketSystem()
 {
   int iResult = WSAStartup(MAKEWORD(2, 2), &wsaData);
   if (iResult != 0) {
-    Show::write("\n  WSAStartup failed with error = " + Conv<int>::toString(iResult));
+    Show::error("\n  WSAStartup failed with error = {}", iResult);
   }
 }
 //-----< destructor frees winsock lib >--------------------------------------
@@ -43,7 +47,149 @@ SocketSystem::SocketSystem()
 SocketSystem::~SocketSystem()
 {
   int error = WSACleanup();
-  Show::write("\n  -- Socket System cleaning up\n");
+  Show::debug("\n  -- Socket System cleaning up\n");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// RecvBuffer class members
+
+//----< constructor defers allocation until first fill >---------------------
+
+RecvBuffer::RecvBuffer(size_t capacity) : capacity_(capacity) {}
+
+//----< returns i-th unconsumed byte >---------------------------------------
+
+RecvBuffer::byte RecvBuffer::operator[](size_t i) const
+{
+  return buffer_[(head_ + i) % capacity_];
+}
+//----< returns offset of first b at or after start, or npos >---------------
+/*
+*  Searches the contiguous segment starting at head_, then the segment
+*  that wrapped around to the front of storage.
+*/
+size_t RecvBuffer::find(byte b, size_t start) const
+{
+  size_t firstLen = capacity_ - head_;
+  if (count_ < firstLen)
+    firstLen = count_;
+  if (start < firstLen)
+  {
+    const byte* pBeg = buffer_.data() + head_;
+    const void* pFound = ::memchr(pBeg + start, b, firstLen - start);
+    if (pFound)
+      return static_cast<const byte*>(pFound) - pBeg;
+    start = firstLen;
+  }
+  if (start < count_)
+  {
+    const byte* pBeg = buffer_.data();
+    const void* pFound = ::memchr(pBeg + (start - firstLen), b, count_ - start);
+    if (pFound)
+      return firstLen + (static_cast<const byte*>(pFound) - pBeg);
+  }
+  return npos;
+}
+//----< makes unconsumed bytes contiguous, returns pointer to first >-------
+/*
+*  - rotates storage in place, only when the bytes wrap around its end,
+*    so they can be scanned as one array without being copied out
+*/
+const RecvBuffer::byte* RecvBuffer::linearize()
+{
+  if (head_ + count_ > capacity_)
+  {
+    std::rotate(buffer_.begin(), buffer_.begin() + head_, buffer_.end());
+    head_ = 0;
+  }
+  return buffer_.data() + head_;
+}
+//----< moves up to bytes into buffer, returns number moved >----------------
+
+size_t RecvBuffer::read(size_t bytes, byte* buffer)
+{
+  if (bytes > count_)
+    bytes = count_;
+  size_t firstLen = capacity_ - head_;
+  if (bytes < firstLen)
+    firstLen = bytes;
+  if (bytes > 0)
+  {
+    ::memcpy(buffer, buffer_.data() + head_, firstLen);
+    ::memcpy(buffer + firstLen, buffer_.data(), bytes - firstLen);
+  }
+  head_ = (head_ + bytes) % capacity_;
+  count_ -= bytes;
+  if (count_ == 0)
+    head_ = 0;  // keeps free space contiguous for the next fill
+  return bytes;
+}
+//----< moves bytes onto end of str >----------------------------------------
+
+void RecvBuffer::append(size_t bytes, std::string& str)
+{
+  if (bytes > count_)
+    bytes = count_;
+  size_t firstLen = capacity_ - head_;
+  if (bytes < firstLen)
+    firstLen = bytes;
+  if (bytes > 0)
+  {
+    str.append(buffer_.data() + head_, firstLen);
+    str.append(buffer_.data(), bytes - firstLen);
+  }
+  head_ = (head_ + bytes) % capacity_;
+  count_ -= bytes;
+  if (count_ == 0)
+    head_ = 0;
+}
+//----< describes free space as at most two WSABUFs, returns count >---------
+
+size_t RecvBuffer::freeRegions(WSABUF bufs[2])
+{
+  if (buffer_.size() < capacity_)
+    buffer_.resize(capacity_);
+  if (count_ == capacity_)
+    return 0;
+  size_t tail = head_ + count_;
+  if (tail < capacity_)
+  {
+    bufs[0].buf = buffer_.data() + tail;
+    bufs[0].len = static_cast<ULONG>(capacity_ - tail);
+    if (head_ == 0)
+      return 1;
+    bufs[1].buf = buffer_.data();
+    bufs[1].len = static_cast<ULONG>(head_);
+    return 2;
+  }
+  tail -= capacity_;
+  bufs[0].buf = buffer_.data() + tail;
+  bufs[0].len = static_cast<ULONG>(head_ - tail);
+  return 1;
+}
+//----< consumes bytes without copying them >--------------------------------
+
+void RecvBuffer::discard(size_t bytes)
+{
+  if (bytes > count_)
+    bytes = count_;
+  head_ = (head_ + bytes) % capacity_;
+  count_ -= bytes;
+  if (count_ == 0)
+    head_ = 0;
+}
+//----< accounts for bytes written into free regions >-----------------------
+
+void RecvBuffer::commit(size_t bytes)
+{
+  count_ += bytes;
+}
+//----< discards unconsumed bytes >------------------------------------------
+
+void RecvBuffer::clear()
+{
+  head_ = 0;
+  count_ = 0;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -73,10 +219,11 @@ Socket::Socket(::SOCKET sock) : socket_(sock)
 }
 //----< transfer socket ownership with move constructor >--------------------
 
-Socket::Socket(Socket&& s)
+Socket::Socket(Socket&& s) : recvBuffer_(std::move(s.recvBuffer_))
 {
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  s.recvBuffer_.clear();
   ipver_ = s.ipver_;
   ZeroMemory(&hints, sizeof(hints));
   hints.ai_family = s.hints.ai_family;
@@ -90,6 +237,8 @@ Socket& Socket::operator=(Socket&& s)
   if (this == &s) return *this;
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  recvBuffer_ = std::move(s.recvBuffer_);
+  s.recvBuffer_.clear();
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -112,6 +261,7 @@ void Socket::close()
 {
   if (socket_ != INVALID_SOCKET)
     ::closesocket(socket_);
+  socket_ = INVALID_SOCKET;
 }
 //----< tells receiver there will be no more sends from this socket >--------
 
@@ -167,20 +317,119 @@ bool Socket::send(size_t bytes, byte* buffer)
   }
   return true;
 }
+//----< send several buffers, in order, as one stream >----------------------
+/*
+*  - each WSASend hands all remaining buffers to the kernel, so a header
+*    and body go out together without first being copied into one buffer
+*  - doesn't return until everything has been sent
+*  - bufs is modified to track progress through partial sends
+*/
+bool Socket::sendGather(WSABUF* bufs, size_t numBufs)
+{
+  while (true)
+  {
+    while (numBufs > 0 && bufs->len == 0)
+    {
+      ++bufs;
+      --numBufs;
+    }
+    if (numBufs == 0)
+      break;
+    DWORD bytesSent = 0;
+    iResult = ::WSASend(socket_, bufs, (DWORD)numBufs, &bytesSent, 0, NULL, NULL);
+    if (iResult == SOCKET_ERROR || bytesSent == 0)
+      return false;
+    while (bytesSent > 0 && bytesSent >= bufs->len)
+    {
+      bytesSent -= bufs->len;
+      ++bufs;
+      --numBufs;
+    }
+    if (bytesSent > 0)
+    {
+      bufs->buf += bytesSent;
+      bufs->len -= bytesSent;
+    }
+  }
+  return true;
+}
+//----< send head, then bytes of a file starting at fileOffset >-----------
+/*
+*  - TransmitFile has the kernel copy file contents from the file system
+*    cache to the socket, they never pass through a user space buffer
+*  - head, e.g., a message header, goes out with the same call
+*  - TransmitFile sends at most INT_MAX - 1 bytes per call, so larger
+*    files are sent in chunks, each seeking to its own offset
+*  - doesn't return until everything has been sent
+*/
+bool Socket::sendFile(const std::string& fileSpec, size_t bytes, const byte* head, size_t headBytes, size_t fileOffset)
+{
+  if (bytes == 0)  // TransmitFile would send the whole file
+    return headBytes == 0 || send(headBytes, const_cast<byte*>(head));
+
+  HANDLE hFile = ::CreateFileA(
+    fileSpec.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL
+  );
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    Show::error("\n  -- can't open \"{}\" for sending, error: {}", fileSpec, GetLastError());
+    return false;
+  }
+  const size_t maxChunk = 1 << 30;
+  size_t offset = 0;
+  bool ok = true;
+  while (ok && offset < bytes)
+  {
+    size_t chunk = (bytes - offset < maxChunk) ? bytes - offset : maxChunk;
+    TRANSMIT_FILE_BUFFERS tfb;
+    ZeroMemory(&tfb, sizeof(tfb));
+    if (offset == 0)
+    {
+      tfb.Head = const_cast<byte*>(head);
+      tfb.HeadLength = static_cast<DWORD>(headBytes);
+    }
+    LARGE_INTEGER pos;
+    pos.QuadPart = static_cast<LONGLONG>(fileOffset + offset);
+    ok = ::SetFilePointerEx(hFile, pos, NULL, FILE_BEGIN) &&
+      ::TransmitFile(socket_, hFile, static_cast<DWORD>(chunk), 0, NULL, &tfb, 0);
+    offset += chunk;
+  }
+  if (!ok)
+    Show::error("\n  -- TransmitFile failed with error: {}", WSAGetLastError());
+  ::CloseHandle(hFile);
+  return ok;
+}
 //----< recv buffer >--------------------------------------------------------
 /*
 *  - bytes must be less than or equal to the size of buffer
 *  - doesn't return until buffer has been filled with requested bytes
+*  - bytes already in recvBuffer_ are used first
+*  - large remainders are read directly into the caller's buffer, small
+*    ones are pulled through recvBuffer_ to pick up whatever follows them
 */
 bool Socket::recv(size_t bytes, byte* buffer)
 {
-  size_t bytesRecvd = 0, bytesLeft = bytes;
-  byte* pBuf = buffer;
+  size_t bytesRecvd = recvBuffer_.read(bytes, buffer);
+  size_t bytesLeft = bytes - bytesRecvd;
+  byte* pBuf = buffer + bytesRecvd;
   while (bytesLeft > 0)
   {
-    bytesRecvd = ::recv(socket_, pBuf, bytesLeft, 0);
-    if (socket_ == INVALID_SOCKET || bytesRecvd == 0)
-      return false;
+    if (bytesLeft >= recvBuffer_.capacity())
+    {
+      int request = bytesLeft < INT_MAX ? static_cast<int>(bytesLeft) : INT_MAX;
+      ++recvCount_;
+      int result = ::recv(socket_, pBuf, request, 0);
+      if (result == 0 || result == SOCKET_ERROR)
+        return false;
+      bytesRecvd = static_cast<size_t>(result);
+    }
+    else
+    {
+      if (fill() == 0)
+        return false;
+      bytesRecvd = recvBuffer_.read(bytesLeft, pBuf);
+    }
     bytesLeft -= bytesRecvd;
     pBuf += bytesRecvd;
   }
@@ -210,35 +459,51 @@ bool Socket::sendString(const std::string& str, byte terminator)
 /*
  * - Doesn't return until a terminator byte as been received.
  * - result includes terminator
- * ToDo:
- * - needs reads of one byte to be replaced by bulk reads into a
- *   stream buffer to improve efficiency.
- * - That will require building a circular buffer.
- * - performance seems acceptable, so won't do this now
  */
 std::string Socket::recvString(byte terminator)
 {
-  static const int buflen = 1;
-  char buffer[1];
   std::string str;
-  bool first = true;
+  recvLine(str, terminator);
+  return str;
+}
+//----< appends terminator terminated string to str >------------------------
+/*
+ * - Doesn't return until a terminator byte as been received or the
+ *   connection closes, in which case the partial string is appended.
+ * - appended text includes terminator
+ * - returns number of bytes appended
+ * - only bytes not already searched are scanned after each fill
+ */
+size_t Socket::recvLine(std::string& str, byte terminator)
+{
+  size_t appended = 0, scanned = 0;
   while (true)
   {
-    iResult = ::recv(socket_, buffer, buflen, 0);
-    if (iResult == 0 || iResult == INVALID_SOCKET)
+    size_t pos = recvBuffer_.find(terminator, scanned);
+    if (pos != RecvBuffer::npos)
     {
-      //StaticLogger<1>::write("\n  -- invalid socket in Socket::recvString");
-      break;
+      recvBuffer_.append(pos + 1, str);
+      return appended + pos + 1;
     }
-    if (buffer[0] == terminator)
+    if (recvBuffer_.full())
     {
-      // added 9/29/2017
-      str += terminator;
-      break;
+      // string is longer than buffer so hand off what we have
+
+      appended += recvBuffer_.size();
+      recvBuffer_.append(recvBuffer_.size(), str);
+      scanned = 0;
+    }
+    else
+    {
+      scanned = recvBuffer_.size();
+    }
+    if (fill() == 0)
+    {
+      appended += recvBuffer_.size();
+      recvBuffer_.append(recvBuffer_.size(), str);
+      return appended;
     }
-    str += buffer[0];
   }
-  return str;
 }
 //----< strips terminator character that recvString includes >---------------
 
@@ -256,19 +521,118 @@ size_t Socket::sendStream(size_t bytes, byte* pBuf)
 }
 //----< attempt to recv specified number of bytes, but may not send all >----
 /*
-* returns number of bytes actually received
+* - returns number of bytes actually received
+* - returns buffered bytes, if any, without calling ::recv
 */
 size_t Socket::recvStream(size_t bytes, byte* pBuf)
 {
+  if (!recvBuffer_.empty())
+    return recvBuffer_.read(bytes, pBuf);
+  ++recvCount_;
   return ::recv(socket_, pBuf, bytes, 0);
 }
+//----< fills recvBuffer_ with one bulk read >-------------------------------
+/*
+*  - reads everything available, up to the buffer's free space
+*  - blocks only if nothing is available
+*  - returns number of bytes added, zero if connection closed or failed
+*/
+size_t Socket::fill()
+{
+  long bytesRecvd = recvAvailable();
+  return bytesRecvd > 0 ? static_cast<size_t>(bytesRecvd) : 0;
+}
+//----< one bulk read into recvBuffer_ for event driven readers >------------
+/*
+*  - returns number of bytes added, zero if none are available on a
+*    non-blocking socket or the buffer is full, -1 if the connection
+*    closed or failed
+*  - on a blocking socket this waits for data, as fill() does
+*/
+long Socket::recvAvailable()
+{
+  WSABUF bufs[2];
+  size_t numBufs = recvBuffer_.freeRegions(bufs);
+  if (numBufs == 0)
+    return 0;
+  DWORD bytesRecvd = 0, flags = 0;
+  ++recvCount_;
+  iResult = ::WSARecv(socket_, bufs, (DWORD)numBufs, &bytesRecvd, &flags, NULL, NULL);
+  if (iResult == SOCKET_ERROR)
+    return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+  if (bytesRecvd == 0)
+    return -1;
+  recvBuffer_.commit(bytesRecvd);
+  return static_cast<long>(bytesRecvd);
+}
+//----< sends what the socket will accept without blocking >-----------------
+/*
+*  - returns number of bytes sent, zero if a non-blocking socket would
+*    block, -1 if the connection failed
+*/
+long Socket::sendAvailable(size_t bytes, const byte* buffer)
+{
+  int request = bytes < INT_MAX ? static_cast<int>(bytes) : INT_MAX;
+  int bytesSent = ::send(socket_, buffer, request, 0);
+  if (bytesSent == SOCKET_ERROR)
+    return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+  return bytesSent;
+}
+//----< gathering send of what the socket will accept without blocking >----
+/*
+*  - returns number of bytes sent, zero if a non-blocking socket would
+*    block, -1 if the connection failed
+*  - bufs is not modified, caller advances past bytes sent
+*/
+long Socket::sendAvailable(WSABUF* bufs, size_t numBufs)
+{
+  DWORD bytesSent = 0;
+  iResult = ::WSASend(socket_, bufs, (DWORD)numBufs, &bytesSent, 0, NULL, NULL);
+  if (iResult == SOCKET_ERROR)
+    return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+  return static_cast<long>(bytesSent);
+}
+//----< switch between blocking and non-blocking modes >---------------------
+
+bool Socket::nonBlocking(bool enable)
+{
+  u_long mode = enable ? 1 : 0;
+  return ::ioctlsocket(socket_, FIONBIO, &mode) != SOCKET_ERROR;
+}
+//----< wait up to milliSecs for received data or connection close >--------
+/*
+*  - returns true immediately if bytes are already buffered
+*  - returns false on timeout, so caller can drop an idle connection
+*/
+bool Socket::waitForData(size_t milliSecs)
+{
+  if (!recvBuffer_.empty())
+    return true;
+  WSAPOLLFD fd;
+  fd.fd = socket_;
+  fd.events = POLLRDNORM;
+  fd.revents = 0;
+  INT timeout = milliSecs < INT_MAX ? static_cast<INT>(milliSecs) : INT_MAX;
+  return ::WSAPoll(&fd, 1, timeout) > 0;
+}
+//----< send small writes immediately instead of coalescing them >----------
+/*
+*  - with Nagle's algorithm on, the second of two small writes waits for
+*    the peer's delayed ACK, which stalls each exchange on a persistent
+*    connection
+*/
+bool Socket::noDelay(bool enable)
+{
+  BOOL option = enable ? TRUE : FALSE;
+  return ::setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, (const char*)&option, sizeof(option)) != SOCKET_ERROR;
+}
 //----< returns bytes available in recv buffer >-----------------------------
 
 size_t Socket::bytesWaiting()
 {
   unsigned long int ret;
   ::ioctlsocket(socket_, FIONREAD, &ret);
-  return (size_t)ret;
+  return recvBuffer_.size() + (size_t)ret;
 }
 //----< waits for server data, checking every timeToCheck millisec >---------
 
@@ -300,6 +664,8 @@ SocketConnecter::SocketConnecter(SocketConnecter&& s) : Socket()
 {
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  recvBuffer_ = std::move(s.recvBuffer_);
+  s.recvBuffer_.clear();
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -312,6 +678,8 @@ SocketConnecter& SocketConnecter::operator=(SocketConnecter&& s)
   if (this == &s) return *this;
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  recvBuffer_ = std::move(s.recvBuffer_);
+  s.recvBuffer_.clear();
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -322,72 +690,184 @@ SocketConnecter& SocketConnecter::operator=(SocketConnecter&& s)
 
 SocketConnecter::~SocketConnecter()
 {
-  Show::write("\n  -- SocketConnecter instance destroyed");
+  Show::debug("\n  -- SocketConnecter instance destroyed");
 }
-//----< request to connect to ip and port >----------------------------------
+//----< order addresses for racing, alternating address families >----------
+/*
+*  - keeps getaddrinfo's order within each family and starts with the
+*    family of its first address, as RFC 8305 recommends
+*/
+namespace
+{
+  std::vector<addrinfo*> interleaveFamilies(addrinfo* result, size_t maxAddresses)
+  {
+    std::vector<addrinfo*> first, second;
+    for (addrinfo* ptr = result; ptr != NULL; ptr = ptr->ai_next)
+    {
+      if (ptr->ai_family == result->ai_family)
+        first.push_back(ptr);
+      else
+        second.push_back(ptr);
+    }
+    std::vector<addrinfo*> ordered;
+    for (size_t i = 0; i < first.size() || i < second.size(); ++i)
+    {
+      if (i < first.size())
+        ordered.push_back(first[i]);
+      if (i < second.size())
+        ordered.push_back(second[i]);
+    }
+    if (ordered.size() > maxAddresses)
+      ordered.resize(maxAddresses);
+    return ordered;
+  }
+  //----< start non-blocking connect, INVALID_SOCKET if it failed at once >--
 
-bool SocketConnecter::connect(const std::string& ip, size_t port)
+  ::SOCKET startConnect(addrinfo* pAddr, int& error)
+  {
+    ::SOCKET sock = ::socket(pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol);
+    if (sock == INVALID_SOCKET)
+    {
+      error = WSAGetLastError();
+      return INVALID_SOCKET;
+    }
+    u_long mode = 1;
+    ::ioctlsocket(sock, FIONBIO, &mode);
+    if (::connect(sock, pAddr->ai_addr, (int)pAddr->ai_addrlen) == SOCKET_ERROR)
+    {
+      // Winsock reports a pending connect as WSAEWOULDBLOCK, BSD sockets
+      // as EINPROGRESS
+
+      error = WSAGetLastError();
+      if (error != WSAEWOULDBLOCK && error != WSAEINPROGRESS)
+      {
+        ::closesocket(sock);
+        return INVALID_SOCKET;
+      }
+    }
+    return sock;
+  }
+}
+//----< request to connect to ip and port, giving up after timeout ms >------
+/*
+*  - Races the addresses ip resolves to, Happy Eyeballs style (RFC 8305).
+*    A connect to the next address starts every attemptDelay ms while
+*    earlier attempts are still pending, or at once when one fails.  The
+*    first to connect is kept and the rest are closed, so an unreachable
+*    first address, e.g., ::1 for "localhost", costs attemptDelay ms
+*    instead of the OS connect timeout.
+*  - Attempts are non-blocking connects watched with select.  Winsock
+*    reports a failed connect in the exception set, BSD sockets in the
+*    write set, so both are checked, and SO_ERROR tells which happened.
+*  - The connected socket is returned to blocking mode.
+*  - connectMilliSecs() and connectAttempts() describe the last call.
+*    Name resolution by getaddrinfo isn't bounded by timeout.
+*/
+bool SocketConnecter::connect(const std::string& ip, size_t port, size_t timeout)
 {
+  using Clock = std::chrono::steady_clock;
+  using MilliSecs = std::chrono::milliseconds;
+
+  recvBuffer_.clear();  // discard anything left from a previous connection
+  socket_ = INVALID_SOCKET;
+  connectAttempts_ = 0;
+  Clock::time_point start = Clock::now();
+  Clock::time_point deadline = start + MilliSecs(timeout);
+
   size_t uport = htons((u_short)port);
   std::string sPort = Conv<size_t>::toString(uport);
 
   // Resolve the server address and port
-  const char* pTemp = ip.c_str();
-  iResult = getaddrinfo(pTemp, sPort.c_str(), &hints, &result);  // was DEFAULT_PORT
+  iResult = getaddrinfo(ip.c_str(), sPort.c_str(), &hints, &result);  // was DEFAULT_PORT
   if (iResult != 0) {
-    Show::write("\n  -- getaddrinfo failed with error: " + Conv<int>::toString(iResult));
+    Show::error("\n  -- getaddrinfo failed with error: {}", iResult);
+    connectMilliSecs_ = std::chrono::duration_cast<MilliSecs>(Clock::now() - start).count();
     return false;
   }
 
-  // Attempt to connect to an address until one succeeds
-  for (ptr = result; ptr != NULL; ptr = ptr->ai_next) {
-
-    char ipstr[INET6_ADDRSTRLEN];
-    void *addr;
-    char *ipver;
-
-    // get pointer to address - different fields in IPv4 and IPv6:
+  std::vector<addrinfo*> addresses = interleaveFamilies(result, maxAttempts);
+  std::vector<::SOCKET> pending;
+  size_t next = 0;
+  Clock::time_point nextStart = start;
+  int error = 0;
 
-    if (ptr->ai_family == AF_INET) { // IPv4
-      struct sockaddr_in *ipv4 = (struct sockaddr_in *)ptr->ai_addr;
-      addr = &(ipv4->sin_addr);
-      ipver = "IPv4";
+  while (socket_ == INVALID_SOCKET)
+  {
+    Clock::time_point now = Clock::now();
+    if (now >= deadline)
+    {
+      error = WSAETIMEDOUT;
+      break;
+    }
+    if (next < addresses.size() && (pending.empty() || now >= nextStart))
+    {
+      ++connectAttempts_;
+      ::SOCKET sock = startConnect(addresses[next++], error);
+      if (sock != INVALID_SOCKET)
+        pending.push_back(sock);
+      nextStart = now + MilliSecs(attemptDelay);
+      continue;
     }
-    else { // IPv6
-      struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *)ptr->ai_addr;
-      addr = &(ipv6->sin6_addr);
-      ipver = "IPv6";
+    if (pending.empty())
+      break;  // every address failed
+
+    // wait for an attempt to finish, until the next one is due
+
+    Clock::time_point wakeAt = (next < addresses.size() && nextStart < deadline) ? nextStart : deadline;
+    long long waitMicroSecs = std::chrono::duration_cast<std::chrono::microseconds>(wakeAt - now).count();
+    timeval tv;
+    tv.tv_sec = static_cast<long>(waitMicroSecs / 1000000);
+    tv.tv_usec = static_cast<long>(waitMicroSecs % 1000000);
+    fd_set writable, failed;
+    FD_ZERO(&writable);
+    FD_ZERO(&failed);
+    ::SOCKET maxSocket = 0;
+    for (::SOCKET sock : pending)
+    {
+      FD_SET(sock, &writable);
+      FD_SET(sock, &failed);
+      maxSocket = (std::max)(maxSocket, sock);
     }
-
-    // convert the IP to a string and print it:
-    inet_ntop(ptr->ai_family, addr, ipstr, sizeof ipstr);
-    //printf("\n  %s: %s", ipver, ipstr);
-
-    // Create a SOCKET for connecting to server
-    socket_ = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-    if (socket_ == INVALID_SOCKET) {
-      int error = WSAGetLastError();
-      Show::write("\n\n  -- socket failed with error: " + Conv<int>::toString(error));
-      return false;
+    if (::select(static_cast<int>(maxSocket) + 1, NULL, &writable, &failed, &tv) == SOCKET_ERROR)
+    {
+      error = WSAGetLastError();
+      break;
     }
-
-    iResult = ::connect(socket_, ptr->ai_addr, (int)ptr->ai_addrlen);
-    if (iResult == SOCKET_ERROR) {
-      socket_ = INVALID_SOCKET;
-      int error = WSAGetLastError();
-      Show::write("\n  -- WSAGetLastError returned " + Conv<int>::toString(error));
-      continue;
+    for (size_t i = 0; i < pending.size(); )
+    {
+      ::SOCKET sock = pending[i];
+      if (!FD_ISSET(sock, &writable) && !FD_ISSET(sock, &failed))
+      {
+        ++i;
+        continue;
+      }
+      int sockError = 0;
+      int length = sizeof(sockError);
+      ::getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&sockError, &length);
+      pending.erase(pending.begin() + i);
+      if (sockError == 0 && !FD_ISSET(sock, &failed))
+      {
+        socket_ = sock;
+        break;
+      }
+      error = sockError;
+      ::closesocket(sock);
+      nextStart = Clock::now();  // a failure starts the next attempt at once
     }
-    break;
   }
 
+  for (::SOCKET sock : pending)
+    ::closesocket(sock);
   freeaddrinfo(result);
+  connectMilliSecs_ = std::chrono::duration_cast<MilliSecs>(Clock::now() - start).count();
 
   if (socket_ == INVALID_SOCKET) {
-    int error = WSAGetLastError();
-    Show::write("\n  -- unable to connect to server, error = " + Conv<int>::toString(error));
+    Show::warning("\n  -- unable to connect to {}:{} in {} ms, error = {}", ip, port, connectMilliSecs_, error);
     return false;
   }
+  u_long mode = 0;
+  ::ioctlsocket(socket_, FIONBIO, &mode);
+  Show::debug("\n  -- connected to {}:{} in {} ms, {} attempts", ip, port, connectMilliSecs_, connectAttempts_);
   return true;
 }
 /////////////////////////////////////////////////////////////////////////////
@@ -413,6 +893,8 @@ SocketListener::SocketListener(SocketListener&& s) : Socket()
 {
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  recvBuffer_ = std::move(s.recvBuffer_);
+  s.recvBuffer_.clear();
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -426,6 +908,8 @@ SocketListener& SocketListener::operator=(SocketListener&& s)
   if (this == &s) return *this;
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  recvBuffer_ = std::move(s.recvBuffer_);
+  s.recvBuffer_.clear();
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -437,23 +921,23 @@ SocketListener& SocketListener::operator=(SocketListener&& s)
 
 SocketListener::~SocketListener()
 {
-  Show::write("\n  -- SocketListener instance destroyed");
+  Show::debug("\n  -- SocketListener instance destroyed");
 }
 //----< binds SocketListener to a network adddress on local machine >--------
 
 bool SocketListener::bind()
 {
-  Show::write("\n  -- staring bind operation");
+  Show::debug("\n  -- staring bind operation");
 
   // Resolve the server address and port
 
   size_t uport = ::htons((u_short)port_);
-  StaticLogger<1>::write("\n  -- Listen port   = " + Utilities::Converter<size_t>::toString(port_));
-  StaticLogger<1>::write("\n  -- netstat uport = " + Utilities::Converter<size_t>::toString(uport));
+  Show::debug("\n  -- Listen port   = {}", port_);
+  Show::debug("\n  -- netstat uport = {}", uport);
   std::string sPort = Conv<size_t>::toString(uport);
   iResult = getaddrinfo(NULL, sPort.c_str(), &hints, &result);
   if (iResult != 0) {
-    Show::write("\n  -- getaddrinfo failed with error: " + Conv<int>::toString(iResult));
+    Show::error("\n  -- getaddrinfo failed with error: {}", iResult);
     return false;
   }
 
@@ -466,17 +950,17 @@ bool SocketListener::bind()
     socket_ = socket(pResult->ai_family, pResult->ai_socktype, pResult->ai_protocol);
     if (socket_ == INVALID_SOCKET) {
       int error = WSAGetLastError();
-      Show::write("\n  -- socket failed with error: " + Conv<int>::toString(error));
+      Show::error("\n  -- socket failed with error: {}", error);
       continue;
     }
-    Show::write("\n  -- server created ListenSocket");
+    Show::debug("\n  -- server created ListenSocket");
 
     // Setup the TCP listening socket
 
     iResult = ::bind(socket_, pResult->ai_addr, (int)pResult->ai_addrlen);
     if (iResult == SOCKET_ERROR) {
       int error = WSAGetLastError();
-      Show::write("\n  -- bind failed with error: " + Conv<int>::toString(error));
+      Show::error("\n  -- bind failed with error: {}", error);
       socket_ = INVALID_SOCKET;
       continue;
     }
@@ -487,22 +971,22 @@ bool SocketListener::bind()
     }
   }
   freeaddrinfo(result);
-  Show::write("\n  -- bind operation complete");
+  Show::debug("\n  -- bind operation complete");
   return true;
 }
 //----< put SocketListener in listen mode, doesn't block >-------------------
 
 bool SocketListener::listen()
 {
-  Show::write("\n  -- starting TCP listening socket setup");
+  Show::debug("\n  -- starting TCP listening socket setup");
   iResult = ::listen(socket_, SOMAXCONN);
   if (iResult == SOCKET_ERROR) {
     int error = WSAGetLastError();
-    Show::write("\n  -- listen failed with error: " + Conv<int>::toString(error));
+    Show::error("\n  -- listen failed with error: {}", error);
     socket_ = INVALID_SOCKET;
     return false;
   }
-  Show::write("\n  -- server TCP listening socket setup complete");
+  Show::debug("\n  -- server TCP listening socket setup complete");
   return true;
 }
 //----< accepts incoming requrests to connect - blocking call >--------------
@@ -514,8 +998,8 @@ Socket SocketListener::accept()
   if (!clientSocket.validState()) {
     acceptFailed_ = true;
     int error = WSAGetLastError();
-    Show::write("\n  -- server accept failed with error: " + Conv<int>::toString(error));
-    Show::write(
+    Show::warning("\n  -- server accept failed with error: {}", error);
+    Show::debug(
       "\n  -- this occurs when application shuts down while listener thread is blocked on Accept call"
     );
     return clientSocket;
@@ -2,7 +2,7 @@
 #define SOCKETS_H
 /////////////////////////////////////////////////////////////////////////
 // Sockets.h - C++ wrapper for Win32 socket api                        //
-// ver 5.3                                                             //
+// ver 6.4                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
 // CST 4-187, Syracuse University, 315 443-3948, jfawcett@twcny.rr.com //
 //---------------------------------------------------------------------//
@@ -16,14 +16,24 @@
 *  Package Operations:
 *  -------------------
 *  Provides four classes that wrap the Winsock API:
+*  RecvBuffer:
+*  - circular buffer filled by bulk reads from a socket
+*  - Socket uses it to return strings, lines, and blocks without
+*    making a ::recv call for every byte
 *  Socket:
 *  - provides all the functionality necessary to handle server clients
 *  - created by SocketListener after accepting a request
 *  - usually passed to a client handling thread
 *  SocketConnecter:
 *  - adds the ability to connect to a server
+*  - connect(ip, port, timeout) gives up after timeout milliseconds,
+*    racing the server's addresses so one that is unreachable doesn't
+*    stall the connect
 *  SocketListener:
 *  - adds the ability to listen for connections on a dedicated thread
+*  - start(co) runs each connection on its own thread, startAccepting(ao)
+*    hands each connection to ao on the listen thread, e.g., to give
+*    it to an event loop
 *  - instances of this class are the only ones influenced by ipVer().
 *    clients will use whatever protocol the server provides.
 *  SocketSystem:
@@ -39,6 +49,48 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 6.4 : 17 Oct 2026
+*  - sendFile takes the offset in the file where sending starts
+*  ver 6.3 : 17 Oct 2026
+*  - socket_ starts as INVALID_SOCKET, so validState() is false for a
+*    Socket or SocketConnecter that hasn't connected yet
+*  ver 6.2 : 17 Oct 2026
+*  - SocketConnecter::connect takes a timeout and races the addresses a
+*    name resolves to with non-blocking connects, Happy Eyeballs style,
+*    instead of trying them one at a time with blocking connects
+*  - added connectMilliSecs and connectAttempts
+*  ver 6.1 : 17 Oct 2026
+*  - diagnostics are logged at error, warning, or debug level, so bind,
+*    connect, and listener progress compiles out of release builds
+*  ver 6.0 : 17 Oct 2026
+*  - diagnostics use Logger's log(format, args...), so they are
+*    formatted on the logging thread, not by the socket's thread
+*  ver 5.9 : 17 Oct 2026
+*  - added RecvBuffer::linearize, which makes buffered bytes contiguous
+*    so a header can be parsed where it was received
+*  ver 5.8 : 17 Oct 2026
+*  - added sendFile, which sends a header followed by a file's contents
+*    with TransmitFile, so file bytes are never copied into user space
+*  ver 5.7 : 17 Oct 2026
+*  - added sendGather and a gathering sendAvailable, which send several
+*    buffers, e.g., a message header and body, with one WSASend call
+*  ver 5.6 : 17 Oct 2026
+*  - added waitForData, so persistent connections can time out when idle
+*  - added noDelay, to turn off Nagle's algorithm for request/reply
+*    traffic on persistent connections
+*  - close() invalidates the handle so a socket can be reconnected
+*  ver 5.5 : 17 Oct 2026
+*  - added SocketListener::startAccepting, which start now uses
+*  - added nonBlocking, recvAvailable, sendAvailable, and recvBuffer
+*    to support event driven servers
+*  - SocketListener::start drops a connection, instead of terminating,
+*    if a client handler thread can't be created
+*  ver 5.4 : 17 Oct 2026
+*  - added RecvBuffer, a circular receive buffer, to Socket
+*  - recvString, recv, and recvStream now consume bytes from RecvBuffer,
+*    which is filled with one bulk read of everything available
+*  - added recvLine, which appends a line to a caller's string, and
+*    recvCount for instrumenting the number of ::recv calls
 *  ver 5.3 : 07 Jan 2018
 *  - changed comments in SocketListener::start()
 *  ver 5.2 : 05 Oct 2017
@@ -107,10 +159,6 @@
 /*
 * ToDo:
 * - make SocketSystem a reference counted instance of Socket
-* - write buffered recv which efficiently returns string or line
-*   - reads and concatenates everything available into circular buffer
-*   - parses out first string or line and moves start of buffer pointer
-*     to begining of next
 * -----------------------------------------------------------------------
 *  Wait for The next items until Students have submitted their code
 * -----------------------------------------------------------------------
@@ -127,10 +175,13 @@
 #include <winsock2.h>     // Windows sockets, ver 2
 #include <WS2tcpip.h>     // support for IPv6 and other things
 #include <IPHlpApi.h>     // ip helpers
+#include <mswsock.h>      // TransmitFile
 
 #include <vector>
 #include <string>
 #include <atomic>
+#include <thread>
+#include <system_error>
 
 #include "../WindowsHelpers/WindowsHelpers.h"
 #include "../Utilities/Utilities.h"
@@ -138,6 +189,7 @@
 
 #pragma warning(disable:4522)
 #pragma comment(lib, "Ws2_32.lib")
+#pragma comment(lib, "Mswsock.lib")
 
 namespace Sockets
 {
@@ -154,6 +206,41 @@ namespace Sockets
     WSADATA wsaData;
   };
 
+  /////////////////////////////////////////////////////////////////////////////
+  // RecvBuffer class
+  // - circular buffer holding bytes read from a socket but not yet consumed
+  // - storage is allocated on first use, so sockets that never receive,
+  //   e.g., SocketListener, pay nothing for it
+  // - free space is exposed as at most two WSABUFs so a single WSARecv
+  //   can fill the buffer even when it wraps
+
+  class RecvBuffer
+  {
+  public:
+    using byte = char;
+    static const size_t npos = static_cast<size_t>(-1);
+
+    RecvBuffer(size_t capacity = 8192);
+    size_t size() const { return count_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == capacity_; }
+    byte operator[](size_t i) const;
+    size_t find(byte b, size_t start = 0) const;
+    const byte* linearize();
+    size_t read(size_t bytes, byte* buffer);
+    void append(size_t bytes, std::string& str);
+    void discard(size_t bytes);
+    size_t freeRegions(WSABUF bufs[2]);
+    void commit(size_t bytes);
+    void clear();
+  private:
+    std::vector<byte> buffer_;
+    size_t capacity_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   // Socket class
   // - used by server for client handling
@@ -178,13 +265,24 @@ namespace Sockets
 
     IpVer& ipVer();
     bool send(size_t bytes, byte* buffer);
+    bool sendGather(WSABUF* bufs, size_t numBufs);
+    bool sendFile(const std::string& fileSpec, size_t bytes, const byte* head = nullptr, size_t headBytes = 0, size_t fileOffset = 0);
     bool recv(size_t bytes, byte* buffer);
     size_t sendStream(size_t bytes, byte* buffer);
     size_t recvStream(size_t bytes, byte* buffer);
     bool sendString(const std::string& str, byte terminator = '\0');
     std::string recvString(byte terminator = '\0');
+    size_t recvLine(std::string& str, byte terminator = '\n');
     static std::string removeTerminator(const std::string& src);
     size_t bytesWaiting();
+    size_t recvCount() const { return recvCount_; }
+    bool nonBlocking(bool enable);
+    bool waitForData(size_t milliSecs);
+    bool noDelay(bool enable);
+    long recvAvailable();
+    long sendAvailable(size_t bytes, const byte* buffer);
+    long sendAvailable(WSABUF* bufs, size_t numBufs);
+    RecvBuffer& recvBuffer() { return recvBuffer_; }
     bool waitForData(size_t timeToWait, size_t timeToCheck);
     bool shutDownSend();
     bool shutDownRecv();
@@ -194,11 +292,15 @@ namespace Sockets
     bool validState() { return socket_ != INVALID_SOCKET; }
 
   protected:
+    size_t fill();
+
     WSADATA wsaData;
-    ::SOCKET socket_;
+    ::SOCKET socket_ = INVALID_SOCKET;
     struct addrinfo *result = NULL, *ptr = NULL, hints;
     int iResult;
     IpVer ipver_ = IP4;
+    RecvBuffer recvBuffer_;
+    size_t recvCount_ = 0;
   };
 
   /////////////////////////////////////////////////////////////////////////////
@@ -216,13 +318,23 @@ namespace Sockets
     SocketConnecter& operator=(SocketConnecter&& s);
     virtual ~SocketConnecter();
 
-    bool connect(const std::string& ip, size_t port);
+    static const size_t defaultTimeout = 10000;  // milliseconds
+    static const size_t attemptDelay = 250;      // milliseconds between racing attempts
+    static const size_t maxAttempts = 32;
+
+    bool connect(const std::string& ip, size_t port, size_t timeout = defaultTimeout);
+    size_t connectMilliSecs() const { return connectMilliSecs_; }
+    size_t connectAttempts() const { return connectAttempts_; }
+  private:
+    size_t connectMilliSecs_ = 0;
+    size_t connectAttempts_ = 0;
   };
 
   /////////////////////////////////////////////////////////////////////////////
   // SocketListener class
   // - listens for incoming connections
-  // - each connection is handled on its own thread
+  // - each connection is handled on its own thread, or handed to an
+  //   accept callable object that decides where it is handled
 
   class SocketListener : public Socket
   {
@@ -237,6 +349,8 @@ namespace Sockets
 
     template<typename CallObj>
     bool start(CallObj& co);
+    template<typename AcceptObj>
+    bool startAccepting(AcceptObj ao);
     void stop();
   private:
     bool bind();
@@ -256,6 +370,33 @@ namespace Sockets
   */
   template<typename CallObj>
   bool SocketListener::start(CallObj& co)
+  {
+    return startAccepting([&co](Socket&& clientSocket)
+    {
+      // start thread to handle client request
+
+      // pass co by value to avoid interactions between threads
+
+      try
+      {
+        std::thread clientThread(co, std::move(clientSocket));
+        clientThread.detach();  // detach - listener won't access thread again
+      }
+      catch (std::system_error&)
+      {
+        StaticLogger<1>::warning("\n  -- unable to create client thread, connection dropped");
+      }
+    });
+  }
+  //----< runs listener on its own thread, handing connections to ao >---------
+  /*
+  *  - ao is called on the listen thread with each accepted Socket, so
+  *    it should return quickly, e.g., by queuing the socket for
+  *    processing elsewhere.
+  *  - ao is copied into the listen thread.
+  */
+  template<typename AcceptObj>
+  bool SocketListener::startAccepting(AcceptObj ao)
   {
     if (!bind())
     {
@@ -269,9 +410,9 @@ namespace Sockets
     // listen on a dedicated thread so server's main thread won't block
 
     std::thread ListenThread(
-      [&]()
+      [this, ao]() mutable
     {
-      StaticLogger<1>::write("\n  -- server waiting for connection");
+      StaticLogger<1>::debug("\n  -- server waiting for connection");
 
       while (!acceptFailed_)
       {
@@ -286,14 +427,9 @@ namespace Sockets
         }
         //StaticLogger<1>::write("\n  -- server accepted connection");
 
-        // start thread to handle client request
-
-        // pass co by value to avoid interactions between threads
-
-        std::thread clientThread(co, std::move(clientSocket));
-        clientThread.detach();  // detach - listener won't access thread again
+        ao(std::move(clientSocket));
       }
-      StaticLogger<1>::write("\n  -- Listen thread stopping");
+      StaticLogger<1>::debug("\n  -- Listen thread stopping");
     }
     );
     ListenThread.detach();
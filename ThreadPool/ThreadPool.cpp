@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////////
+// ThreadPool.cpp - fixed set of worker threads fed by a bounded queue //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPool.h"
+#include <iostream>
+#include <string>
+#include <mutex>
+#include <chrono>
+
+#ifdef TEST_THREADPOOL
+
+std::mutex ioLock;
+
+int main()
+{
+  std::cout << "\n  Demonstrating ThreadPool";
+  std::cout << "\n ==========================";
+
+  // two slow workers and three queue slots can't keep up with ten
+  // items submitted at once, so some are refused
+
+  ThreadPool<std::string> pool(2, 3, [](std::string& item)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> l(ioLock);
+    std::cout << "\n  thread " << std::this_thread::get_id() << " processed " << item;
+  });
+  pool.start();
+
+  for (int i = 0; i < 10; ++i)
+  {
+    std::string item = "item#" + std::to_string(i);
+    bool accepted = pool.submit(std::move(item));
+    std::lock_guard<std::mutex> l(ioLock);
+    std::cout << "\n  main submitted item#" << i << (accepted ? "" : " - refused, queue full");
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+  std::cout << "\n\n  threads = " << pool.threads() << ", refused = " << pool.refused();
+  pool.stop();
+  std::cout << "\n  pool stopped, submit now " << (pool.submit("late") ? "accepted" : "refused");
+  std::cout << "\n\n";
+}
+
+#endif
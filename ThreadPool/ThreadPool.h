@@ -0,0 +1,131 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// ThreadPool.h - fixed set of worker threads fed by a bounded queue   //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package provides a ThreadPool<WorkItem> class.  A fixed number of
+*  worker threads deQ work items from one bounded BlockingQueue and hand
+*  each to a processing function.
+*  - submit(item) fails, leaving item untouched, when the queue is full.
+*    The caller decides how to refuse the work, e.g., HttpServer replies
+*    503 to a connection it can't queue.
+*  - The number of threads never grows, so overload shows up as refused
+*    work rather than as more and more threads competing for the CPU.
+*  - WorkItem must be default constructible and movable.  Sockets are
+*    both.
+*
+*  Required Files:
+*  ---------------
+*  ThreadPool.h, ThreadPool.cpp
+*  Cpp11-BlockingQueue.h
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+#include "../Logger/Cpp11-BlockingQueue.h"
+#include <functional>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+template <typename WorkItem>
+class ThreadPool
+{
+public:
+  using Processor = std::function<void(WorkItem&)>;
+
+  ThreadPool(size_t numThreads, size_t queueCapacity, Processor proc);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void start();
+  void stop();
+  bool submit(WorkItem&& item);
+  size_t threads() const { return numThreads_; }
+  size_t queued() { return queue_.size(); }
+  size_t refused() const { return refused_.load(); }
+private:
+  void work(Processor proc);
+
+  size_t numThreads_;
+  Processor proc_;
+  BlockingQueue<WorkItem> queue_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> stopping_ = false;
+  std::atomic<size_t> refused_ = 0;
+};
+//----< constructor, at least one thread and one queue slot >----------
+
+template <typename WorkItem>
+ThreadPool<WorkItem>::ThreadPool(size_t numThreads, size_t queueCapacity, Processor proc)
+  : numThreads_(numThreads > 0 ? numThreads : 1), proc_(proc),
+    queue_(queueCapacity > 0 ? queueCapacity : 1) {}
+
+//----< destructor stops and joins workers >---------------------------
+
+template <typename WorkItem>
+ThreadPool<WorkItem>::~ThreadPool()
+{
+  stop();
+}
+//----< start worker threads >-----------------------------------------
+/*
+*  - each worker gets its own copy of the processing function
+*/
+template <typename WorkItem>
+void ThreadPool<WorkItem>::start()
+{
+  for (size_t i = 0; i < numThreads_; ++i)
+    threads_.push_back(std::thread(&ThreadPool<WorkItem>::work, this, proc_));
+}
+//----< stop workers, discarding queued work >-------------------------
+/*
+*  - items being processed are finished
+*  - one default item per worker, enQ'd past the queue bound, wakes
+*    each worker so it sees stopping_
+*/
+template <typename WorkItem>
+void ThreadPool<WorkItem>::stop()
+{
+  if (threads_.empty())
+    return;
+  stopping_.store(true);
+  for (size_t i = 0; i < threads_.size(); ++i)
+    queue_.enQ(WorkItem());
+  for (auto& thrd : threads_)
+    thrd.join();
+  threads_.clear();
+}
+//----< queue item for a worker, false if queue is full >-------------
+
+template <typename WorkItem>
+bool ThreadPool<WorkItem>::submit(WorkItem&& item)
+{
+  if (stopping_.load() || !queue_.tryEnQ(std::move(item)))
+  {
+    ++refused_;
+    return false;
+  }
+  return true;
+}
+//----< worker thread processing >-------------------------------------
+
+template <typename WorkItem>
+void ThreadPool<WorkItem>::work(Processor proc)
+{
+  while (true)
+  {
+    WorkItem item = queue_.deQ();
+    if (stopping_.load())
+      break;
+    proc(item);
+  }
+}
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////
 // Utilities.cpp - small, generally usefule, helper classes          //
-// ver 1.3                                                           //
+// ver 1.5                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Application: Most Projects, CSE687 - Object Oriented Design       //
 // Author:      Jim Fawcett, Syracuse University, CST 4-187          //
@@ -11,6 +11,18 @@
 #include <iostream>
 #include "Utilities.h"
 
+#if defined(__AVX2__)
+#define UTILITIES_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTILITIES_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 using namespace Utilities;
 
 std::function<void(const std::string&)> Title =
@@ -55,6 +67,181 @@ void StringHelper::Title(const std::string& src, char underline)
 //  return accum;
 //}
 
+/////////////////////////////////////////////////////////////////////
+// string scanning kernels
+// - each vector step loads a block, compares every byte, and reduces
+//   the comparison to a bit mask, one bit per byte
+// - loads are unaligned and never read outside [first, last), the
+//   bytes left over after the last full block are scanned one by one
+
+namespace
+{
+  bool isSpace(char ch)
+  {
+    return ch == ' ' || ('\t' <= ch && ch <= '\r');
+  }
+  //----< index of lowest set bit, mask must not be zero >-------------
+
+  unsigned lowBit(unsigned mask)
+  {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+  //----< index of highest set bit, mask must not be zero >------------
+
+  unsigned highBit(unsigned mask)
+  {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return index;
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+  }
+
+#ifdef UTILITIES_SSE2
+  //----< bit set for each of 16 bytes that is white space >-----------
+
+  unsigned spaceMask(__m128i bytes)
+  {
+    __m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+    __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));   // '\t' to '\r' become 0 to 4
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(4)), offset);
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(space, control)));
+  }
+#endif
+#ifdef UTILITIES_AVX2
+  //----< bit set for each of 32 bytes that is white space >-----------
+
+  unsigned spaceMask(__m256i bytes)
+  {
+    __m256i space = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+    __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(4)), offset);
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(space, control)));
+  }
+#endif
+}
+//----< first ch in [first, last), or last if there is none >----------
+
+const char* StringHelper::find(const char* first, const char* last, char ch)
+{
+#ifdef UTILITIES_AVX2
+  __m256i target32 = _mm256_set1_epi8(ch);
+  for (; last - first >= 32; first += 32)
+  {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, target32)));
+    if (mask != 0)
+      return first + lowBit(mask);
+  }
+#endif
+#ifdef UTILITIES_SSE2
+  __m128i target = _mm_set1_epi8(ch);
+  for (; last - first >= 16; first += 16)
+  {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, target)));
+    if (mask != 0)
+      return first + lowBit(mask);
+  }
+#endif
+  for (; first != last; ++first)
+  {
+    if (*first == ch)
+      return first;
+  }
+  return last;
+}
+//----< first non-white space char in [first, last), or last >---------
+
+const char* StringHelper::skipSpace(const char* first, const char* last)
+{
+#ifdef UTILITIES_AVX2
+  for (; last - first >= 32; first += 32)
+  {
+    unsigned mask = ~spaceMask(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)));
+    if (mask != 0)
+      return first + lowBit(mask);
+  }
+#endif
+#ifdef UTILITIES_SSE2
+  for (; last - first >= 16; first += 16)
+  {
+    unsigned mask = ~spaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))) & 0xffff;
+    if (mask != 0)
+      return first + lowBit(mask);
+  }
+#endif
+  while (first != last && isSpace(*first))
+    ++first;
+  return first;
+}
+//----< one past last non-white space char in [first, last), or first >
+
+const char* StringHelper::skipSpaceBack(const char* first, const char* last)
+{
+#ifdef UTILITIES_AVX2
+  for (; last - first >= 32; last -= 32)
+  {
+    unsigned mask = ~spaceMask(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(last - 32)));
+    if (mask != 0)
+      return last - 32 + highBit(mask) + 1;
+  }
+#endif
+#ifdef UTILITIES_SSE2
+  for (; last - first >= 16; last -= 16)
+  {
+    unsigned mask = ~spaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last - 16))) & 0xffff;
+    if (mask != 0)
+      return last - 16 + highBit(mask) + 1;
+  }
+#endif
+  while (last != first && isSpace(last[-1]))
+    --last;
+  return last;
+}
+//----< view of toTrim without leading and trailing white space >------
+
+std::string_view StringHelper::trimView(std::string_view toTrim)
+{
+  const char* first = skipSpace(toTrim.data(), toTrim.data() + toTrim.size());
+  const char* last = skipSpaceBack(first, toTrim.data() + toTrim.size());
+  return std::string_view(first, last - first);
+}
+//----< append trimmed views of splitOn separated parts of toSplit >---
+/*
+*  - matches split(std::string): empty parts between separators are
+*    kept, a part after the last separator only if it isn't empty
+*  - returns the number of views appended
+*/
+size_t StringHelper::splitView(std::string_view toSplit, char splitOn, std::vector<std::string_view>& splits)
+{
+  size_t count = 0;
+  const char* first = toSplit.data();
+  const char* last = first + toSplit.size();
+  while (first != last)
+  {
+    const char* found = find(first, last, splitOn);
+    if (found == last)
+    {
+      splits.push_back(trimView(std::string_view(first, last - first)));
+      ++count;
+      break;
+    }
+    splits.push_back(trimView(std::string_view(first, found - first)));
+    ++count;
+    first = found + 1;
+  }
+  return count;
+}
+
 void Utilities::putline()
 {
   std::cout << "\n";
@@ -100,6 +287,20 @@ int main()
   std::cout << Converter<double>::toValue(conv1) << ", ";
   std::cout << Converter<int>::toValue(conv2) << ", ";
   std::cout << Converter<std::string>::toValue(conv3);
+  putline();
+
+  title("test Converter<T>::toChars and fromChars, no allocation");
+
+  char buffer[Converter<size_t>::maxChars];
+  size_t length = Converter<size_t>::toChars(8080, buffer, sizeof(buffer));
+  std::cout << "\n  toChars(8080) = \"" << std::string(buffer, length) << "\"";
+  length = Converter<size_t>::toChars(1234567, buffer, 4);
+  std::cout << "\n  toChars(1234567) into 4 chars returns length " << length;
+  size_t value = 0;
+  bool ok = Converter<size_t>::fromChars(" 42 bytes", value);
+  std::cout << "\n  fromChars(\" 42 bytes\") = " << value << (ok ? ", ok" : ", failed");
+  ok = Converter<size_t>::fromChars("none", value);
+  std::cout << "\n  fromChars(\"none\") " << (ok ? "ok" : "failed");
 
   std::cout << "\n\n";
   return 0;
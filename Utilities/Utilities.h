@@ -2,7 +2,7 @@
 #define UTILITIES_H
 ///////////////////////////////////////////////////////////////////////
 // Utilities.h - small, generally useful, helper classes             //
-// ver 1.3                                                           //
+// ver 1.5                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Application: Most Projects, CSE687 - Object Oriented Design       //
 // Author:      Jim Fawcett, Syracuse University, CST 4-187          //
@@ -14,6 +14,17 @@
 * This package provides classes StringHelper and Converter and a global
 * function putline().  This class will be extended continuously for 
 * awhile to provide convenience functions for general C++ applications.
+* - StringHelper's find, skipSpace, and skipSpaceBack kernels scan 16
+*   bytes at a time with SSE2, or 32 with AVX2 when compiled with
+*   /arch:AVX2, and fall back to scalar loops on other targets.
+*   trimView and splitView use them to return views of their input
+*   instead of copies, trim and split of std::string use them too.
+*   White space is ' ', '\t', '\n', '\v', '\f', and '\r', as in the
+*   "C" locale.
+* - Converter<T> converts numbers with std::to_chars and std::from_chars,
+*   so never needs a stream or locale, and other types with string
+*   streams.  toChars and fromChars convert numbers to and from a
+*   caller's buffer without allocating.
 *
 * Build Process:
 * --------------
@@ -23,6 +34,12 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.5 : 17 Oct 2026
+* - added SIMD find and white space kernels, trimView, and splitView,
+*   trim and split of std::string are built on them
+* ver 1.4 : 17 Oct 2026
+* - Converter<T> uses std::to_chars and std::from_chars for numbers,
+*   added toChars and fromChars, toValue accepts a std::string_view
 * ver 1.3 : 01 Jan 2018
 * - fixed indexing bugs in StringHelper::trim
 * ver 1.2 : 22 Feb 2015
@@ -43,6 +60,10 @@
 #include <sstream>
 #include <functional>
 #include <locale>
+#include <string_view>
+#include <charconv>
+#include <type_traits>
+#include <cctype>
 
 namespace Utilities
 {
@@ -55,6 +76,11 @@ namespace Utilities
     static std::basic_string<T> trim(const std::basic_string<T>& toTrim);
     template <typename T>
     static std::vector<std::basic_string<T>> split(const std::basic_string<T>& toSplit, T splitOn = ',');
+    static std::string_view trimView(std::string_view toTrim);
+    static size_t splitView(std::string_view toSplit, char splitOn, std::vector<std::string_view>& splits);
+    static const char* find(const char* first, const char* last, char ch);
+    static const char* skipSpace(const char* first, const char* last);
+    static const char* skipSpaceBack(const char* first, const char* last);
   };
 
   /*--- remove whitespace from front and back of string argument ---*/
@@ -62,6 +88,8 @@ namespace Utilities
   template <typename T>
   std::basic_string<T> StringHelper::trim(const std::basic_string<T>& toTrim)
   {
+    if constexpr (std::is_same<T, char>::value)
+      return std::string(trimView(toTrim));
     if (toTrim.size() == 0)
       return toTrim;
     std::basic_string<T> temp;
@@ -99,6 +127,15 @@ namespace Utilities
   std::vector<std::basic_string<T>> StringHelper::split(const std::basic_string<T>& toSplit, T splitOn)
   {
     std::vector<std::basic_string<T>> splits;
+    if constexpr (std::is_same<T, char>::value)
+    {
+      std::vector<std::string_view> views;
+      splitView(toSplit, splitOn, views);
+      splits.reserve(views.size());
+      for (auto view : views)
+        splits.emplace_back(view);
+      return splits;
+    }
     std::basic_string<T> temp;
     typename std::basic_string<T>::const_iterator iter;
     for (iter = toSplit.begin(); iter != toSplit.end(); ++iter)
@@ -155,29 +192,96 @@ namespace Utilities
 
   void putline();
 
+  /*--- Converter ----------------------------------------------------
+  * - numbers are the arithmetic types streams show as digits, not
+  *   bool or character types
+  * - doubles are written like a stream's default format, %g with six
+  *   significant digits
+  * - like a stream, reading skips leading white space and stops at
+  *   the first character that isn't part of the number
+  */
   template <typename T>
   class Converter
   {
   public:
+    static const bool isNumber =
+      std::is_floating_point<T>::value || (std::is_integral<T>::value &&
+      !std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+      !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+      !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value &&
+      !std::is_same<T, char32_t>::value);
+    static const size_t maxChars = 32;  // enough for any number
+
     static std::string toString(const T& t);
-    static T toValue(const std::string& src);
+    static T toValue(std::string_view src);
+    static size_t toChars(const T& t, char* buffer, size_t size);
+    static bool fromChars(std::string_view src, T& t);
   };
 
+  /*--- write number into buffer, returns length, or 0 if it won't fit ---*/
+
+  template <typename T>
+  size_t Converter<T>::toChars(const T& t, char* buffer, size_t size)
+  {
+    static_assert(isNumber, "toChars converts numbers");
+    std::to_chars_result result;
+    if constexpr (std::is_floating_point<T>::value)
+      result = std::to_chars(buffer, buffer + size, t, std::chars_format::general, 6);
+    else
+      result = std::to_chars(buffer, buffer + size, t);
+    if (result.ec != std::errc())
+      return 0;
+    return result.ptr - buffer;
+  }
+
+  /*--- read number from start of src, returns false if there isn't one ---*/
+
+  template <typename T>
+  bool Converter<T>::fromChars(std::string_view src, T& t)
+  {
+    static_assert(isNumber, "fromChars converts numbers");
+    size_t pos = 0;
+    while (pos < src.size() && std::isspace(static_cast<unsigned char>(src[pos])))
+      ++pos;
+    if (pos < src.size() && src[pos] == '+')
+      ++pos;
+    std::from_chars_result result = std::from_chars(src.data() + pos, src.data() + src.size(), t);
+    return result.ec == std::errc();
+  }
+
   template <typename T>
   std::string Converter<T>::toString(const T& t)
   {
-    std::ostringstream out;
-    out << t;
-    return out.str();
+    if constexpr (isNumber)
+    {
+      char buffer[maxChars];
+      return std::string(buffer, toChars(t, buffer, maxChars));
+    }
+    else
+    {
+      std::ostringstream out;
+      out << t;
+      return out.str();
+    }
   }
 
   template<typename T>
-  T Converter<T>::toValue(const std::string& src)
+  T Converter<T>::toValue(std::string_view src)
   {
-    std::istringstream in(src);
-    T t;
-    in >> t;
-    return t;
+    if constexpr (isNumber)
+    {
+      T t = T();
+      if (!fromChars(src, t))
+        t = T();
+      return t;
+    }
+    else
+    {
+      std::istringstream in{ std::string(src) };
+      T t;
+      in >> t;
+      return t;
+    }
   }
 }
 #endif
@@ -0,0 +1,214 @@
+/////////////////////////////////////////////////////////////////////////
+// Utilities_Test.cpp - equivalence tests for StringHelper kernels     //
+// ver 1.0                                                             //
+// Application: OOD Projects                                           //
+// Platform:    Visual Studio 2019, Windows 10 pro                     //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  Checks that StringHelper's vectorized trim and split give the same
+*  results as the scalar, locale based versions they replaced, and that
+*  the find and white space kernels agree with simple loops.
+*  - Inputs are generated from a fixed seed, so failures repeat.
+*  - Lengths run past several 16 and 32 byte blocks, so every vector
+*    loop and its scalar tail are exercised.
+*
+*  Required Files:
+*  ---------------
+*  Utilities_Test.cpp, Utilities.h, Utilities.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+
+#include "../Utilities/Utilities.h"
+#include <functional>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+using Util = Utilities::StringHelper;
+
+namespace
+{
+  //----< trim as it was before the kernels >--------------------------
+
+  std::string referenceTrim(const std::string& toTrim)
+  {
+    if (toTrim.size() == 0)
+      return toTrim;
+    std::string temp;
+    std::locale loc;
+    std::string::const_iterator iter = toTrim.begin();
+    while (isspace(*iter, loc))
+    {
+      if (++iter == toTrim.end())
+        break;
+    }
+    for (; iter != toTrim.end(); ++iter)
+      temp += *iter;
+    size_t pos = temp.size();
+    for (auto riter = temp.rbegin(); riter != temp.rend(); ++riter)
+    {
+      --pos;
+      if (!isspace(*riter, loc))
+        break;
+    }
+    if (pos < temp.size())
+      temp.erase(++pos);
+    return temp;
+  }
+  //----< split as it was before the kernels >-------------------------
+
+  std::vector<std::string> referenceSplit(const std::string& toSplit, char splitOn)
+  {
+    std::vector<std::string> splits;
+    std::string temp;
+    for (char ch : toSplit)
+    {
+      if (ch != splitOn)
+      {
+        temp += ch;
+      }
+      else
+      {
+        splits.push_back(referenceTrim(temp));
+        temp.clear();
+      }
+    }
+    if (temp.length() > 0)
+      splits.push_back(referenceTrim(temp));
+    return splits;
+  }
+  //----< random string, mostly white space, separators, and letters >-
+
+  std::string randomString(std::mt19937& gen, size_t length)
+  {
+    static const char alphabet[] = " \t\r\n\v\f,,;aZ~\x7f\x80\xff\x08\x0e";
+    std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 2);
+    std::string str;
+    for (size_t i = 0; i < length; ++i)
+      str += alphabet[pick(gen)];
+    return str;
+  }
+}
+
+class Test
+{
+public:
+  using TestType = std::function<bool()>;
+  bool trimMatchesReference();
+  bool splitMatchesReference();
+  bool findMatchesLoop();
+  bool skipSpaceMatchesLoop();
+  void execute(TestType t, const std::string& name);
+private:
+  Utilities::Tester<TestType> tester;
+  std::mt19937 gen_{ 42 };
+};
+
+void Test::execute(TestType t, const std::string& name)
+{
+  tester.execute(t, name);
+}
+//----< trim and trimView agree with the locale based trim >-----------
+
+bool Test::trimMatchesReference()
+{
+  size_t failures = 0;
+  for (size_t length = 0; length < 100; ++length)
+  {
+    for (size_t trial = 0; trial < 50; ++trial)
+    {
+      std::string str = randomString(gen_, length);
+      std::string expected = referenceTrim(str);
+      if (Util::trim(str) != expected || Util::trimView(str) != expected)
+        ++failures;
+    }
+  }
+  std::cout << "\n  " << failures << " differences from reference trim";
+  return failures == 0;
+}
+//----< split and splitView agree with the character by character split >
+
+bool Test::splitMatchesReference()
+{
+  size_t failures = 0;
+  std::vector<std::string_view> views;
+  for (size_t length = 0; length < 100; ++length)
+  {
+    for (size_t trial = 0; trial < 50; ++trial)
+    {
+      std::string str = randomString(gen_, length);
+      std::vector<std::string> expected = referenceSplit(str, ',');
+      views.clear();
+      size_t count = Util::splitView(str, ',', views);
+      bool same = Util::split(str, ',') == expected && count == expected.size() &&
+        std::equal(views.begin(), views.end(), expected.begin(), expected.end());
+      if (!same)
+        ++failures;
+    }
+  }
+  std::cout << "\n  " << failures << " differences from reference split";
+  return failures == 0;
+}
+//----< find returns first match, or last, for every match position >--
+
+bool Test::findMatchesLoop()
+{
+  size_t failures = 0;
+  for (size_t length = 0; length < 80; ++length)
+  {
+    for (size_t at = 0; at <= length; ++at)
+    {
+      std::string str(length, 'a');
+      if (at < length)
+        str[at] = ':';
+      if (at + 3 < length)
+        str[at + 3] = ':';
+      const char* first = str.data();
+      const char* last = first + str.size();
+      if (Util::find(first, last, ':') != std::find(first, last, ':'))
+        ++failures;
+    }
+  }
+  std::cout << "\n  " << failures << " differences from std::find";
+  return failures == 0;
+}
+//----< skipSpace and skipSpaceBack stop at first non-space each way >-
+
+bool Test::skipSpaceMatchesLoop()
+{
+  size_t failures = 0;
+  auto isSpace = [](char ch) { return ch == ' ' || ('\t' <= ch && ch <= '\r'); };
+  for (size_t length = 0; length < 80; ++length)
+  {
+    for (size_t at = 0; at <= length; ++at)
+    {
+      std::string str(length, ' ');
+      if (at < length)
+        str[at] = 'x';
+      const char* first = str.data();
+      const char* last = first + str.size();
+      const char* front = std::find_if_not(first, last, isSpace);
+      const char* back = std::find_if_not(str.rbegin(), str.rend(), isSpace).base() - str.begin() + first;
+      if (Util::skipSpace(first, last) != front || Util::skipSpaceBack(first, last) != back)
+        ++failures;
+    }
+  }
+  std::cout << "\n  " << failures << " differences from scalar loops";
+  return failures == 0;
+}
+
+int main()
+{
+  Test test;
+  test.execute([&]() { return test.trimMatchesReference(); }, "Test::trimMatchesReference");
+  test.execute([&]() { return test.splitMatchesReference(); }, "Test::splitMatchesReference");
+  test.execute([&]() { return test.findMatchesLoop(); }, "Test::findMatchesLoop");
+  test.execute([&]() { return test.skipSpaceMatchesLoop(); }, "Test::skipSpaceMatchesLoop");
+  return 0;
+}